@@ -12,10 +12,17 @@ type StorageConf struct {
 }
 
 type NetConf struct {
-	HTTPAddr string `yaml:"httpaddr"`
-	RPCAddr  string `yaml:"rpcaddr"`
-	WebRoot  string `yaml:"webroot"`
-	Security bool   `yaml:"security"`
+	HTTPAddr      string `yaml:"httpaddr"`
+	RPCAddr       string `yaml:"rpcaddr"`
+	RPCUnixAddr   string `yaml:"urpcaddr,omitempty"`
+	UnixSockMode  string `yaml:"unixsockmode,omitempty"`
+	UnixSockOwner string `yaml:"unixsockowner,omitempty"`
+	RPCWorkers    int    `yaml:"rpcworkers"`
+	RPCQueueLimit int    `yaml:"rpcqueuelimit"`
+	ReusePort     bool   `yaml:"reuseport"`
+	Rebalance     string `yaml:"rebalance,omitempty"`
+	WebRoot       string `yaml:"webroot"`
+	Security      bool   `yaml:"security"`
 }
 
 type LoggerConf struct {
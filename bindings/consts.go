@@ -20,8 +20,14 @@ const (
 	INFO    = 3
 	TRACE   = 4
 
-	AggSum = 0
-	AggAvg = 1
+	AggSum                 = 0
+	AggAvg                 = 1
+	AggFacet               = 2
+	AggMin                 = 3
+	AggMax                 = 4
+	AggCount               = 5
+	AggCountDistinct       = 6
+	AggCountDistinctApprox = 7
 
 	CollateNone    = 0
 	CollateASCII   = 1
@@ -19,28 +19,33 @@ QueryResults &QueryResults::operator=(QueryResults &&obj) noexcept {
 		queryParams_ = std::move(obj.queryParams_);
 		fetchOffset_ = std::move(obj.fetchOffset_);
 		queryID_ = std::move(obj.queryID_);
+		stream_ = obj.stream_;
 	}
 	return *this;
 }
 
-QueryResults::QueryResults(net::cproto::ClientConnection *conn, const NSArray &nsArray, string_view rawResult, int queryID)
-	: conn_(conn), nsArray_(nsArray), queryID_(queryID), fetchOffset_(0) {
+QueryResults::QueryResults(net::cproto::ClientConnection *conn, const NSArray &nsArray, string_view rawResult, int queryID, bool stream)
+	: conn_(conn), nsArray_(nsArray), queryID_(queryID), fetchOffset_(0), stream_(stream) {
+	parseResults(rawResult);
+}
+
+void QueryResults::parseResults(string_view rawResult) {
 	ResultSerializer ser(rawResult);
 
 	queryParams_ = ser.GetRawQueryParams([&](int nsIdx) {
 		uint32_t cacheToken = ser.GetVarUint();
 		int version = ser.GetVarUint();
 
-		std::unique_lock<std::mutex> lck(nsArray[nsIdx]->lck_);
+		std::unique_lock<std::mutex> lck(nsArray_[nsIdx]->lck_);
 
-		bool skip = nsArray[nsIdx]->tagsMatcher_.version() >= version && nsArray[nsIdx]->tagsMatcher_.cacheToken() == cacheToken;
+		bool skip = nsArray_[nsIdx]->tagsMatcher_.version() >= version && nsArray_[nsIdx]->tagsMatcher_.cacheToken() == cacheToken;
 		if (skip) {
 			TagsMatcher().deserialize(ser);
 			PayloadType("tmp").clone()->deserialize(ser);
 		} else {
-			nsArray[nsIdx]->tagsMatcher_.deserialize(ser, version, cacheToken);
-			nsArray[nsIdx]->payloadType_.clone()->deserialize(ser);
-			nsArray[nsIdx]->tagsMatcher_.updatePayloadType(nsArray[nsIdx]->payloadType_, false);
+			nsArray_[nsIdx]->tagsMatcher_.deserialize(ser, version, cacheToken);
+			nsArray_[nsIdx]->payloadType_.clone()->deserialize(ser);
+			nsArray_[nsIdx]->tagsMatcher_.updatePayloadType(nsArray_[nsIdx]->payloadType_, false);
 		}
 	});
 
@@ -59,14 +64,14 @@ Error QueryResults::fetchNextResults() {
 	}
 
 	fetchOffset_ += queryParams_.count;
+	queryID_ = int(args[1]);
 
-	string_view rawResult = p_string(args[0]);
-	ResultSerializer ser(rawResult);
-
-	queryParams_ = ser.GetRawQueryParams(nullptr);
-
-	rawResult = rawResult.substr(ser.Pos());
-	rawResult_ = string(rawResult.data(), rawResult.size());
+	// Batches of streamed results can contain updated payload types
+	try {
+		parseResults(p_string(args[0]));
+	} catch (const Error &err) {
+		return err;
+	}
 	return errOK;
 }
 
@@ -127,7 +132,16 @@ QueryResults::Iterator &QueryResults::Iterator::operator++() {
 	}
 	nextPos_ = 0;
 
-	if (idx_ != qr_->queryParams_.qcount && idx_ == qr_->queryParams_.count + qr_->fetchOffset_) {
+	if (qr_->stream_) {
+		if (idx_ == qr_->queryParams_.count + qr_->fetchOffset_) {
+			// Server closes cursor of streamed results after last batch
+			if (qr_->queryID_ >= 0) {
+				err_ = const_cast<QueryResults *>(qr_)->fetchNextResults();
+				pos_ = 0;
+			}
+			if (!err_.ok() || idx_ == qr_->queryParams_.count + qr_->fetchOffset_) idx_ = kStreamEnd;
+		}
+	} else if (idx_ != qr_->queryParams_.qcount && idx_ == qr_->queryParams_.count + qr_->fetchOffset_) {
 		err_ = const_cast<QueryResults *>(qr_)->fetchNextResults();
 		pos_ = 0;
 	}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <climits>
 #include "client/item.h"
 #include "client/namespace.h"
 #include "client/resultserializer.h"
@@ -38,17 +39,23 @@ public:
 		Error err_;
 	};
 
-	Iterator begin() const { return Iterator{this, 0, 0, 0, errOK}; }
-	Iterator end() const { return Iterator{this, queryParams_.qcount, 0, 0, errOK}; }
+	Iterator begin() const { return Iterator{this, (stream_ && !queryParams_.count) ? kStreamEnd : 0, 0, 0, errOK}; }
+	Iterator end() const { return Iterator{this, stream_ ? kStreamEnd : queryParams_.qcount, 0, 0, errOK}; }
 
-	size_t Count() const { return queryParams_.qcount; }
+	/// Count of results. For streamed results - count of results, which are fetched yet
+	size_t Count() const { return stream_ ? fetchOffset_ + queryParams_.count : queryParams_.qcount; }
 	int TotalCount() const { return queryParams_.totalcount; }
 	bool HaveProcent() const { return queryParams_.haveProcent; };
+	const vector<AggregationResult> &GetAggregationResults() const { return queryParams_.aggResults; }
 
 private:
 	friend class RPCClient;
-	QueryResults(net::cproto::ClientConnection *conn, const NSArray &nsArray, string_view rawResult, int queryID);
+	QueryResults(net::cproto::ClientConnection *conn, const NSArray &nsArray, string_view rawResult, int queryID, bool stream = false);
 	Error fetchNextResults();
+	void parseResults(string_view rawResult);
+
+	// Index of end iterator of streamed results, which count is unknown
+	static const int kStreamEnd = INT_MAX;
 
 	net::cproto::ClientConnection *conn_;
 
@@ -56,6 +63,7 @@ private:
 	string rawResult_;
 	int queryID_;
 	int fetchOffset_;
+	bool stream_ = false;
 
 	ResultSerializer::QueryParams queryParams_;
 };
@@ -29,7 +29,8 @@ public:
 	Reindexer(const Reindexer &) = delete;
 
 	/// Connect - connect to reindexer server
-	/// @param dsn - uri of server and database, like: `cproto://user@password:127.0.0.1:6534/dbname`
+	/// @param dsn - uri of server and database, like: `cproto://user@password:127.0.0.1:6534/dbname`,
+	/// or `unix://user:password@/var/run/reindexer.sock:/dbname` for unix domain socket
 	Error Connect(const string &dsn);
 
 	/// Open or create namespace
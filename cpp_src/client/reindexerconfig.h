@@ -1,10 +1,19 @@
 #pragma once
 
+#include <stddef.h>
+
 namespace reindexer {
 namespace client {
 
 struct ReindexerConfig {
 	int ConnPoolSize = 4;
+	// Ask server to compress frames of connections
+	bool EnableCompression = false;
+	// Select results by server-side cursors: server keeps only batch of results, which is fetched now.
+	// Count() of results is unknown, until all of them are fetched
+	bool StreamResults = false;
+	// Size of shared memory rings, which replace unix domain socket (unix:// dsn) between processes of the same host. 0 - disabled
+	size_t ShmRingSize = 0;
 };
 
 }  // namespace client
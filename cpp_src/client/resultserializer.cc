@@ -28,8 +28,12 @@ ResultSerializer::QueryParams ResultSerializer::GetRawQueryParams(std::function<
 
 	int aggResCount = GetVarUint();
 
+	ret.aggResults.reserve(aggResCount);
 	for (int i = 0; i < aggResCount; i++) {
-		ret.aggResults.push_back(GetDouble());
+		string json = GetSlice().ToString();
+		ret.aggResults.push_back(AggregationResult());
+		Error err = ret.aggResults.back().FromJSON(&json[0]);
+		if (!err.ok()) throw err;
 	}
 
 	return ret;
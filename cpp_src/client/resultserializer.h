@@ -1,5 +1,6 @@
 #pragma once
 #include <functional>
+#include "core/query/aggregationresult.h"
 #include "tools/serializer.h"
 namespace reindexer {
 namespace client {
@@ -22,7 +23,7 @@ public:
 		bool haveProcent;
 		bool nonCacheableData;
 		bool nsCount;
-		h_vector<double, 4> aggResults;
+		vector<AggregationResult> aggResults;
 	};
 
 	QueryParams GetRawQueryParams(std::function<void(int nsId)> updatePayloadFunc);
@@ -26,8 +26,12 @@ Error RPCClient::Connect(const string& dsn) {
 	if (!uri_.parse(dsn)) {
 		return Error(errParams, "%s is not valid uri", dsn.c_str());
 	}
-	if (uri_.scheme() != "cproto") {
-		return Error(errParams, "Scheme must be cproto");
+	if (uri_.scheme() == "unix") {
+		if (uri_.path().rfind(":/") == string::npos) {
+			return Error(errParams, "%s is not valid uri of unix socket. Must be unix:///path/to/socket:/dbname", dsn.c_str());
+		}
+	} else if (uri_.scheme() != "cproto") {
+		return Error(errParams, "Scheme must be cproto or unix");
 	}
 
 	curConnIdx_ = -1;
@@ -71,11 +75,18 @@ void RPCClient::run() {
 void RPCClient::checkConnections() {
 	for (auto& c : connections_) {
 		if (!c->IsValid()) {
-			string port = uri_.port().length() ? uri_.port() : string("6534");
-			string dbName = uri_.path();
+			string addr, dbName = uri_.path();
+			if (uri_.scheme() == "unix") {
+				// Path is /path/to/socket:/dbname
+				size_t pos = dbName.rfind(":/");
+				addr = "unix://" + dbName.substr(0, pos);
+				dbName = dbName.substr(pos + 1);
+			} else {
+				addr = uri_.hostname() + ":" + (uri_.port().length() ? uri_.port() : string("6534"));
+			}
 			if (dbName[0] == '/') dbName = dbName.substr(1);
 
-			c->Connect(uri_.hostname() + ":" + port, uri_.username(), uri_.password(), dbName);
+			c->Connect(addr, uri_.username(), uri_.password(), dbName, config_.EnableCompression, config_.ShmRingSize);
 		}
 	}
 }
@@ -193,6 +204,7 @@ void vec2pack(const h_vector<int32_t, 4>& vec, WrSerializer& ser) {
 Error RPCClient::Select(const Query& query, QueryResults& result) {
 	try {
 		int flags = kResultsWithPayloadTypes | kResultsWithCJson;
+		if (config_.StreamResults) flags |= kResultsStream;
 
 		WrSerializer qser, pser;
 		query.Serialize(qser);
@@ -212,7 +224,7 @@ Error RPCClient::Select(const Query& query, QueryResults& result) {
 			if (args.size() < 2) {
 				return Error(errParams, "Server returned %d args, but expected %d", int(args.size()), 1);
 			}
-			result = QueryResults(conn, nsArray, p_string(args[0]), int(args[1]));
+			result = QueryResults(conn, nsArray, p_string(args[0]), int(args[1]), config_.StreamResults);
 		}
 		return ret.Status();
 	} catch (const Error& err) {
@@ -40,7 +40,9 @@ int main(int argc, char* argv[]) {
 	args::HelpFlag help(parser, "help", "show this message", {'h', "help"});
 
 	args::Group progOptions("options");
-	args::ValueFlag<string> dbDsn(progOptions, "DSN", "DSN to 'reindexer'. Can be 'cproto://<ip>:<port>/<dbname>' or 'builtin://<path>'",
+	args::ValueFlag<string> dbDsn(progOptions, "DSN",
+								  "DSN to 'reindexer'. Can be 'cproto://<ip>:<port>/<dbname>', 'unix://<socket path>:/<dbname>' "
+								  "or 'builtin://<path>'",
 								  {'d', "dsn"}, "", Options::Single | Options::Global | Options::Required);
 	args::ValueFlag<string> fileName(progOptions, "FILENAME", "execute commands from file, then exit", {'f', "filename"}, "",
 									 Options::Single | Options::Global);
@@ -76,7 +78,7 @@ int main(int argc, char* argv[]) {
 	if (!args::get(command).length() && !args::get(fileName).length())
 		std::cout << "Reindexer command line tool version " << REINDEX_VERSION << std::endl;
 
-	if (dsn.compare(0, 9, "cproto://") == 0) {
+	if (dsn.compare(0, 9, "cproto://") == 0 || dsn.compare(0, 7, "unix://") == 0) {
 		reindexer::client::ReindexerConfig config;
 		config.ConnPoolSize = 1;
 		DBWrapper<reindexer::client::Reindexer> db(args::get(outFileName), args::get(fileName), args::get(command), config);
@@ -87,7 +89,7 @@ int main(int argc, char* argv[]) {
 		err = db.Connect(dsn);
 		if (err.ok()) ok = db.Run();
 	} else {
-		std::cerr << "Invalid DSN formt: " << dsn << " Must begin from  cproto:// or builtin://" << std::endl;
+		std::cerr << "Invalid DSN formt: " << dsn << " Must begin from  cproto://, unix:// or builtin://" << std::endl;
 	}
 	if (!err.ok()) {
 		std::cerr << "ERROR: " << err.what() << std::endl;
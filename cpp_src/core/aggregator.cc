@@ -1,31 +1,219 @@
 #include "core/aggregator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "core/payload/payloadiface.h"
 
 namespace reindexer {
 
-Aggregator::Aggregator(KeyValueType type, bool isArray, void *rawData, AggType aggType)
-	: type_(type), isArray_(isArray), rawData_(static_cast<uint8_t *>(rawData)), aggType_(aggType) {}
+Aggregator::Aggregator(const PayloadType &payloadType, const FieldsSet &fields, AggType aggType, const h_vector<string, 1> &names)
+	: payloadType_(payloadType),
+	  fields_(fields),
+	  aggType_(aggType),
+	  names_(names),
+	  min_(std::numeric_limits<double>::max()),
+	  max_(-std::numeric_limits<double>::max()) {
+	switch (aggType_) {
+		case AggFacet:
+		case AggCountDistinct:
+		case AggCountDistinctApprox:
+			if (aggType_ == AggCountDistinctApprox) {
+				sketch_.reset(new HyperLogLog);
+			} else {
+				facets_.reset(new FacetMap);
+			}
+			for (int field : fields_) {
+				if (fields_.size() > 1 && payloadType_->Field(field).IsArray()) {
+					throw Error(errQueryExec, "Multifield facet can't be applied to array field '%s'", payloadType_->Field(field).Name().c_str());
+				}
+			}
+			break;
+		case AggSum:
+		case AggAvg:
+		case AggMin:
+		case AggMax:
+		case AggCount:
+			if (fields_.size() != 1) {
+				throw Error(errQueryExec, "Aggregation '%s' can be applied only to single field",
+							AggregationResult::TypeToStr(aggType_).ToString().c_str());
+			}
+			type_ = payloadType_->Field(fields_[0]).Type();
+			offset_ = payloadType_->Field(fields_[0]).Offset();
+			isArray_ = payloadType_->Field(fields_[0]).IsArray();
+			if (aggType_ != AggCount && type_ != KeyValueInt && type_ != KeyValueInt64 && type_ != KeyValueDouble) {
+				throw Error(errQueryExec, "Aggregation '%s' can be applied only to numeric field, but '%s' is %s",
+							AggregationResult::TypeToStr(aggType_).ToString().c_str(), payloadType_->Field(fields_[0]).Name().c_str(),
+							KeyRef::TypeName(type_));
+			}
+			break;
+		default:
+			throw Error(errQueryExec, "Unknown aggregation type %d", aggType_);
+	}
+}
+
+Aggregator::Aggregator() = default;
+Aggregator::~Aggregator() = default;
+Aggregator::Aggregator(Aggregator &&) = default;
+Aggregator &Aggregator::operator=(Aggregator &&) = default;
+
+void Aggregator::Aggregate(const PayloadValue &data) {
+	hitCount_++;
+	if (facets_) {
+		aggregateFacet(data);
+		return;
+	}
+	if (sketch_) {
+		aggregateSketch(data);
+		return;
+	}
+	if (aggType_ == AggCount) return;
+
+	const uint8_t *ptr = data.Ptr() + offset_;
+	int len = 1;
+	if (isArray_) {
+		const PayloadFieldValue::Array *arr = reinterpret_cast<const PayloadFieldValue::Array *>(ptr);
+		ptr = data.Ptr() + arr->offset;
+		len = arr->len;
+	}
+
+	switch (type_) {
+		case KeyValueInt:
+			aggregateNumeric<int>(ptr, len);
+			break;
+		case KeyValueInt64:
+			aggregateNumeric<int64_t>(ptr, len);
+			break;
+		case KeyValueDouble:
+			aggregateNumeric<double>(ptr, len);
+			break;
+		default:
+			abort();
+	}
+}
+
+void Aggregator::aggregateFacet(const PayloadValue &data) {
+	ConstPayload pl(payloadType_, data);
+	if (fields_.size() == 1) {
+		pl.Get(fields_[0], tmpKeys_);
+		// Each item is counted once per distinct value, even if array field contains duplicates
+		if (tmpKeys_.size() > 1) {
+			std::sort(tmpKeys_.begin(), tmpKeys_.end());
+			tmpKeys_.erase(std::unique(tmpKeys_.begin(), tmpKeys_.end()), tmpKeys_.end());
+		}
+		for (auto &key : tmpKeys_) ++(*facets_)[FacetKey{key}];
+		return;
+	}
 
-void Aggregator::Bind(PayloadType type, int field) {
-	offset_ = type->Field(field).Offset();
-	sizeof_ = type->Field(field).ElemSizeof();
+	FacetKey facetKey;
+	for (int field : fields_) {
+		pl.Get(field, tmpKeys_);
+		facetKey.push_back(tmpKeys_.empty() ? KeyRef() : tmpKeys_[0]);
+	}
+	++(*facets_)[facetKey];
 }
 
-void Aggregator::Aggregate(const PayloadValue &data, int idx) {
-	if (rawData_) {
-		aggregate(rawData_ + idx * sizeof_);
+void Aggregator::aggregateSketch(const PayloadValue &data) {
+	ConstPayload pl(payloadType_, data);
+	if (fields_.size() == 1) {
+		// Sketch is not sensitive to duplicates, so array values are not deduplicated
+		pl.Get(fields_[0], tmpKeys_);
+		for (auto &key : tmpKeys_) sketch_->Add(HyperLogLog::Mix(key.Hash()));
 		return;
 	}
 
-	if (!isArray_) {
-		aggregate(data.Ptr() + offset_);
+	FacetKey facetKey;
+	for (int field : fields_) {
+		pl.Get(field, tmpKeys_);
+		facetKey.push_back(tmpKeys_.empty() ? KeyRef() : tmpKeys_[0]);
+	}
+	sketch_->Add(HyperLogLog::Mix(FacetKeyHash()(facetKey)));
+}
+
+void Aggregator::AggregateKey(const KeyRef &key, int count) {
+	if (!count) return;
+	hitCount_ += count;
+	if (facets_) {
+		assert(fields_.size() == 1);
+		(*facets_)[FacetKey{key}] += count;
+		return;
+	}
+	if (sketch_) {
+		assert(fields_.size() == 1);
+		sketch_->Add(HyperLogLog::Mix(key.Hash()));
 		return;
 	}
+	if (aggType_ == AggCount) return;
 
-	PayloadFieldValue::Array *arr = reinterpret_cast<PayloadFieldValue::Array *>(data.Ptr() + offset_);
+	double v = 0;
+	switch (key.Type()) {
+		case KeyValueInt:
+			v = int(key);
+			break;
+		case KeyValueInt64:
+			v = int64_t(key);
+			break;
+		case KeyValueDouble:
+			v = double(key);
+			break;
+		default:
+			abort();
+	}
+	result_ += v * count;
+	valuesCount_ += count;
+	min_ = std::min(min_, v);
+	max_ = std::max(max_, v);
+}
 
-	uint8_t *ptr = data.Ptr() + arr->offset;
-	for (int i = 0; i < arr->len; i++, ptr += sizeof_) aggregate(ptr);
+void Aggregator::AggregateCount(size_t count) {
+	assert(aggType_ == AggCount);
+	hitCount_ += count;
+}
+
+AggregationResult Aggregator::GetResult() const {
+	AggregationResult ret;
+	ret.type = aggType_;
+	ret.fields = names_;
+
+	switch (aggType_) {
+		case AggAvg:
+			ret.value = valuesCount_ == 0 ? 0 : (result_ / valuesCount_);
+			break;
+		case AggSum:
+			ret.value = result_;
+			break;
+		case AggMin:
+			ret.value = valuesCount_ == 0 ? 0 : min_;
+			break;
+		case AggMax:
+			ret.value = valuesCount_ == 0 ? 0 : max_;
+			break;
+		case AggCount:
+			ret.value = hitCount_;
+			break;
+		case AggCountDistinct:
+			ret.value = facets_->size();
+			break;
+		case AggCountDistinctApprox:
+			ret.value = std::round(sketch_->Estimate());
+			break;
+		case AggFacet:
+			ret.facets.reserve(facets_->size());
+			for (auto &it : *facets_) {
+				ret.facets.push_back(FacetResult());
+				auto &facet = ret.facets.back();
+				facet.count = it.second;
+				for (auto &v : it.first) facet.values.push_back(v.Type() == KeyValueEmpty ? string() : v.As<string>());
+			}
+			// Most frequent values first, ties are ordered by values
+			std::sort(ret.facets.begin(), ret.facets.end(), [](const FacetResult &lhs, const FacetResult &rhs) {
+				if (lhs.count != rhs.count) return lhs.count > rhs.count;
+				return std::lexicographical_compare(lhs.values.begin(), lhs.values.end(), rhs.values.begin(), rhs.values.end());
+			});
+			break;
+		default:
+			abort();
+	}
+	return ret;
 }
 
 }  // namespace reindexer
@@ -2,54 +2,76 @@
 
 #include "core/keyvalue/keyvalue.h"
 #include "core/payload/payloadiface.h"
+#include "core/query/aggregationresult.h"
 #include "core/type_consts.h"
+#include "estl/fast_hash_map.h"
+#include "estl/hyperloglog.h"
 
 namespace reindexer {
 
 class Aggregator {
 public:
-	Aggregator(KeyValueType type, bool isArray, void *rawData, AggType aggType);
-	Aggregator(){};
-	~Aggregator(){};
-	void Aggregate(const PayloadValue &lhs, int idx);
-	void Bind(PayloadType type, int field);
-	double GetResult() const {
-		switch (aggType_) {
-			case AggAvg:
-				return hitCount_ == 0 ? 0 : (result_ / hitCount_);
-			case AggSum:
-				return result_;
-			default:
-				abort();
-		}
-	}
+	Aggregator(const PayloadType &payloadType, const FieldsSet &fields, AggType aggType, const h_vector<string, 1> &names);
+	Aggregator();
+	~Aggregator();
+	Aggregator(Aggregator &&);
+	Aggregator &operator=(Aggregator &&);
+	Aggregator(const Aggregator &) = delete;
+	Aggregator &operator=(const Aggregator &) = delete;
+
+	// Aggregate values of item
+	void Aggregate(const PayloadValue &lhs);
+	// Aggregate key, which is present in 'count' items. Used to aggregate directly from index keys, without access to payload
+	void AggregateKey(const KeyRef &key, int count);
+	// Account 'count' matched items without access to their values. Applicable only to count aggregation
+	void AggregateCount(size_t count);
+	AggregationResult GetResult() const;
+
+	AggType Type() const { return aggType_; }
+	const FieldsSet &Fields() const { return fields_; }
 
 protected:
-	void aggregate(void *ptr) {
-		hitCount_++;
-		switch (type_) {
-			case KeyValueInt:
-				result_ += *static_cast<int *>(ptr);
-				break;
-			case KeyValueInt64:
-				result_ += *static_cast<int64_t *>(ptr);
-				break;
-			case KeyValueDouble:
-				result_ += *static_cast<double *>(ptr);
-				break;
-			default:
-				abort();
+	using FacetKey = h_vector<KeyRef, 1>;
+	struct FacetKeyHash {
+		size_t operator()(const FacetKey &key) const {
+			size_t ret = 0;
+			for (auto &v : key) ret = (ret * 127) ^ v.Hash();
+			return ret;
 		}
+	};
+	using FacetMap = fast_hash_map<FacetKey, int, FacetKeyHash>;
+
+	// Typed accumulator for numeric aggregations. All stats are updated unconditionally, so
+	// there are no branches on aggregation type in the inner loop
+	template <typename T>
+	void aggregateNumeric(const uint8_t *ptr, int len) {
+		const T *values = reinterpret_cast<const T *>(ptr);
+		for (int i = 0; i < len; i++) {
+			double v = values[i];
+			result_ += v;
+			min_ = std::min(min_, v);
+			max_ = std::max(max_, v);
+		}
+		valuesCount_ += len;
 	}
+	void aggregateFacet(const PayloadValue &lhs);
+	void aggregateSketch(const PayloadValue &lhs);
 
+	PayloadType payloadType_;
+	FieldsSet fields_;
+	AggType aggType_;
+	h_vector<string, 1> names_;
 	KeyValueType type_ = KeyValueUndefined;
 	size_t offset_ = 0;
-	size_t sizeof_ = 0;
 	bool isArray_ = false;
-	uint8_t *rawData_ = nullptr;
+	int64_t hitCount_ = 0;
+	int64_t valuesCount_ = 0;
 	double result_ = 0;
-	int hitCount_ = 0;
-	AggType aggType_;
+	double min_;
+	double max_;
+	std::unique_ptr<FacetMap> facets_;
+	std::unique_ptr<HyperLogLog> sketch_;
+	KeyRefs tmpKeys_;
 };
 
 }  // namespace reindexer
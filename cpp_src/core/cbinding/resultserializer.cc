@@ -29,20 +29,26 @@ void WrResultSerializer::putQueryParams(const QueryResults* results) {
 	PutVarUint(results->ctxs.size());
 
 	if (opts_.flags & kResultsWithPayloadTypes) {
-		assert(opts_.ptVersions);
-		if (opts_.ptVersionsCount != results->getMergedNSCount()) {
-			logPrintf(LogWarning, "ptVersionsCount != results->getMergedNSCount. Client's meta data can become incosistent.");
+		// Without versions of client's payload types all of them are sent
+		int totalCnt = results->getMergedNSCount();
+		if (opts_.ptVersions) {
+			if (opts_.ptVersionsCount != totalCnt) {
+				logPrintf(LogWarning, "ptVersionsCount != results->getMergedNSCount. Client's meta data can become incosistent.");
+			}
+			totalCnt = std::min(totalCnt, opts_.ptVersionsCount);
 		}
-		int cnt = 0, totalCnt = std::min(results->getMergedNSCount(), opts_.ptVersionsCount);
+		auto changed = [&](int i) {
+			const TagsMatcher& tm = results->getTagsMatcher(i);
+			return !opts_.ptVersions || int32_t(tm.version() ^ tm.cacheToken()) != opts_.ptVersions[i];
+		};
 
+		int cnt = 0;
 		for (int i = 0; i < totalCnt; i++) {
-			const TagsMatcher& tm = results->getTagsMatcher(i);
-			if (int32_t(tm.version() ^ tm.cacheToken()) != opts_.ptVersions[i]) cnt++;
+			if (changed(i)) cnt++;
 		}
 		PutVarUint(cnt);
 		for (int i = 0; i < totalCnt; i++) {
-			const TagsMatcher& tm = results->getTagsMatcher(i);
-			if (int32_t(tm.version() ^ tm.cacheToken()) != opts_.ptVersions[i]) {
+			if (changed(i)) {
 				PutVarUint(i);
 				putPayloadType(results, i);
 			}
@@ -56,7 +62,12 @@ void WrResultSerializer::putQueryParams(const QueryResults* results) {
 
 void WrResultSerializer::putAggregationParams(const QueryResults* results) {
 	PutVarUint(results->aggregationResults.size());
-	for (auto ar : results->aggregationResults) PutDouble(ar);
+	WrSerializer wrser;
+	for (auto &ar : results->aggregationResults) {
+		wrser.Reset();
+		ar.GetJSON(wrser);
+		PutSlice(wrser.Slice());
+	}
 }
 
 void WrResultSerializer::putItemParams(const QueryResults* result, int idx, bool useOffset) {
@@ -0,0 +1,281 @@
+#include "msgpackencoder.h"
+#include <cstdlib>
+#include "core/payload/payloadtuple.h"
+#include "tagsmatcher.h"
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+namespace msgpack {
+
+// Put type code followed by big endian value of n bytes
+static void putCode(WrSerializer &wrser, uint8_t code, uint64_t v = 0, int n = 0) {
+	char buf[9];
+	buf[0] = char(code);
+	for (int i = 0; i < n; i++) buf[1 + i] = char(v >> (8 * (n - 1 - i)));
+	wrser.Write(string_view(buf, 1 + n));
+}
+
+// Put header of container or string, which has short form with size in type code
+static void putHeader(WrSerializer &wrser, uint32_t size, uint8_t fixCode, uint32_t fixMax, uint8_t code8, uint8_t code16, uint8_t code32) {
+	if (size <= fixMax) {
+		putCode(wrser, fixCode | size);
+	} else if (code8 && size <= 0xFF) {
+		putCode(wrser, code8, size, 1);
+	} else if (size <= 0xFFFF) {
+		putCode(wrser, code16, size, 2);
+	} else {
+		putCode(wrser, code32, size, 4);
+	}
+}
+
+void putNil(WrSerializer &wrser) { putCode(wrser, 0xc0); }
+void putBool(WrSerializer &wrser, bool v) { putCode(wrser, v ? 0xc3 : 0xc2); }
+
+void putInt(WrSerializer &wrser, int64_t v) {
+	if (v >= 0) {
+		if (v < 0x80) {
+			putCode(wrser, uint8_t(v));
+		} else if (v <= 0xFF) {
+			putCode(wrser, 0xcc, v, 1);
+		} else if (v <= 0xFFFF) {
+			putCode(wrser, 0xcd, v, 2);
+		} else if (v <= 0xFFFFFFFFLL) {
+			putCode(wrser, 0xce, v, 4);
+		} else {
+			putCode(wrser, 0xcf, v, 8);
+		}
+	} else if (v >= -32) {
+		putCode(wrser, uint8_t(v));
+	} else if (v >= INT8_MIN) {
+		putCode(wrser, 0xd0, uint64_t(v), 1);
+	} else if (v >= INT16_MIN) {
+		putCode(wrser, 0xd1, uint64_t(v), 2);
+	} else if (v >= INT32_MIN) {
+		putCode(wrser, 0xd2, uint64_t(v), 4);
+	} else {
+		putCode(wrser, 0xd3, uint64_t(v), 8);
+	}
+}
+
+void putDouble(WrSerializer &wrser, double v) {
+	uint64_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	putCode(wrser, 0xcb, bits, 8);
+}
+
+void putString(WrSerializer &wrser, const string_view &str) {
+	putHeader(wrser, str.size(), 0xa0, 31, 0xd9, 0xda, 0xdb);
+	wrser.Write(str);
+}
+
+void putArray(WrSerializer &wrser, uint32_t size) { putHeader(wrser, size, 0x90, 15, 0, 0xdc, 0xdd); }
+void putMap(WrSerializer &wrser, uint32_t size) { putHeader(wrser, size, 0x80, 15, 0, 0xde, 0xdf); }
+
+size_t beginMap(WrSerializer &wrser) {
+	wrser.PutChar(char(0x80));
+	return wrser.Len() - 1;
+}
+
+void endMap(WrSerializer &wrser, size_t pos, uint32_t size) {
+	if (size <= 15) {
+		wrser.Buf()[pos] = uint8_t(0x80 | size);
+		return;
+	}
+	// Header of big map is longer, than placeholder: content is shifted
+	size_t end = wrser.Len();
+	int n = size <= 0xFFFF ? 2 : 4;
+	for (int i = 0; i < n; i++) wrser.PutChar(0);
+	uint8_t *buf = wrser.Buf();
+	memmove(buf + pos + 1 + n, buf + pos + 1, end - pos - 1);
+	buf[pos] = n == 2 ? 0xde : 0xdf;
+	for (int i = 0; i < n; i++) buf[pos + 1 + i] = uint8_t(size >> (8 * (n - 1 - i)));
+}
+
+}  // namespace msgpack
+
+MsgPackEncoder::MsgPackEncoder(const TagsMatcher &tagsMatcher, const JsonPrintFilter &filter)
+	: tagsMatcher_(tagsMatcher), filter_(filter) {}
+
+void MsgPackEncoder::Encode(ConstPayload *pl, WrSerializer &wrSer, IJsonEncoderDatasourceWithJoins *ds) {
+	string_view tuple = getPlTuple(pl);
+	Serializer rdser(tuple);
+	for (int i = 0; i < pl->NumFields(); ++i) fieldsoutcnt_[i] = 0;
+
+	// Root object: joined items are added to its fields
+	ctag tag = rdser.GetVarUint();
+	assertf(tag.Type() == TAG_OBJECT, "Unexpected cjson typeTag '%d' of root object", tag.Type());
+	size_t pos = msgpack::beginMap(wrSer);
+	uint32_t count = 0;
+	while (encodeField(pl, rdser, wrSer, true, count))
+		;
+
+	for (size_t rowid = 0; ds && rowid < ds->GetJoinedRowsCount(); ++rowid) {
+		const size_t itemsCount = ds->GetJoinedRowItemsCount(rowid);
+		if (!itemsCount) continue;
+
+		msgpack::putString(wrSer, "joined." + ds->GetJoinedItemNamespace(rowid));
+		msgpack::putArray(wrSer, itemsCount);
+		MsgPackEncoder subEnc(ds->GetJoinedItemTagsMatcher(rowid), ds->GetJoinedItemJsonFilter(rowid));
+		for (size_t i = 0; i < itemsCount; ++i) {
+			ConstPayload jpl(ds->GetJoinedItemPayload(rowid, i));
+			subEnc.Encode(&jpl, wrSer);
+		}
+		count++;
+	}
+	msgpack::endMap(wrSer, pos, count);
+}
+
+static inline void encodeValue(int tagType, Serializer &rdser, WrSerializer &wrser, bool visible) {
+	switch (tagType) {
+		case TAG_DOUBLE: {
+			double v = rdser.GetDouble();
+			if (visible) msgpack::putDouble(wrser, v);
+			break;
+		}
+		case TAG_VARINT: {
+			int64_t v = rdser.GetVarint();
+			if (visible) msgpack::putInt(wrser, v);
+			break;
+		}
+		case TAG_BOOL: {
+			bool v = rdser.GetBool();
+			if (visible) msgpack::putBool(wrser, v);
+			break;
+		}
+		case TAG_NULL:
+			if (visible) msgpack::putNil(wrser);
+			break;
+		case TAG_STRING: {
+			string_view v = rdser.GetVString();
+			if (visible) msgpack::putString(wrser, v);
+			break;
+		}
+		default:
+			assertf(0, "Unexpected cjson typeTag '%d' while parsing value", tagType);
+	}
+}
+
+static void encodeKeyRef(WrSerializer &wrser, KeyRef kr, int tagType) {
+	if (tagType == TAG_NULL) {
+		msgpack::putNil(wrser);
+		return;
+	}
+
+	switch (kr.Type()) {
+		case KeyValueInt:
+			if (tagType != TAG_BOOL)
+				msgpack::putInt(wrser, int(kr));
+			else
+				msgpack::putBool(wrser, int(kr));
+			break;
+		case KeyValueInt64:
+			msgpack::putInt(wrser, int64_t(kr));
+			break;
+		case KeyValueDouble:
+			msgpack::putDouble(wrser, double(kr));
+			break;
+		case KeyValueString:
+			msgpack::putString(wrser, p_string(kr));
+			break;
+		default:
+			std::abort();
+	}
+}
+
+// Encode field of object or element of array. Count of encoded visible fields is incremented
+bool MsgPackEncoder::encodeField(ConstPayload *pl, Serializer &rdser, WrSerializer &wrser, bool visible, uint32_t &count) {
+	ctag tag = rdser.GetVarUint();
+	int tagType = tag.Type();
+
+	if (tagType == TAG_END) return false;
+
+	int tagName = tag.Name();
+	visible = visible && filter_.Match(tagName);
+	if (visible) {
+		count++;
+		if (tagName) msgpack::putString(wrser, tagsMatcher_.tag2name(tagName));
+	}
+	int tagField = tag.Field();
+
+	// get field from indexed field
+	if (tagField >= 0) {
+		assert(tagField < pl->NumFields());
+
+		KeyRefs kr;
+		int *cnt = &fieldsoutcnt_[tagField];
+
+		switch (tagType) {
+			case TAG_ARRAY: {
+				int n = rdser.GetVarUint();
+				if (visible) {
+					msgpack::putArray(wrser, n);
+					if (n) pl->Get(tagField, kr);
+					while (n--) {
+						assertf(*cnt < int(kr.size()), "No data in field '%s.%s', got %d items.", pl->Type().Name().c_str(),
+								pl->Type().Field(tagField).Name().c_str(), *cnt);
+						encodeKeyRef(wrser, kr[(*cnt)++], tagType);
+					}
+				} else
+					(*cnt) += n;
+				break;
+			}
+			case TAG_NULL:
+				if (visible) msgpack::putNil(wrser);
+				break;
+			default:
+				if (visible) {
+					pl->Get(tagField, kr);
+					assertf(*cnt < int(kr.size()), "No data in field '%s.%s', got %d items.", pl->Type().Name().c_str(),
+							pl->Type().Field(tagField).Name().c_str(), *cnt);
+					encodeKeyRef(wrser, kr[(*cnt)++], tagType);
+				} else
+					(*cnt)++;
+				break;
+		}
+		return true;
+	}
+
+	switch (tagType) {
+		case TAG_ARRAY: {
+			carraytag atag = rdser.GetUInt32();
+			if (visible) msgpack::putArray(wrser, atag.Count());
+			uint32_t elems = 0;
+			for (int i = 0; i < atag.Count(); i++) {
+				if (atag.Tag() == TAG_OBJECT) {
+					encodeField(pl, rdser, wrser, visible, elems);
+				} else {
+					encodeValue(atag.Tag(), rdser, wrser, visible);
+				}
+			}
+			break;
+		}
+		case TAG_OBJECT: {
+			size_t pos = visible ? msgpack::beginMap(wrser) : 0;
+			uint32_t fields = 0;
+			while (encodeField(pl, rdser, wrser, visible, fields))
+				;
+			if (visible) msgpack::endMap(wrser, pos, fields);
+			break;
+		}
+		default:
+			encodeValue(tagType, rdser, wrser, visible);
+	}
+	return true;
+}
+
+string_view MsgPackEncoder::getPlTuple(ConstPayload *pl) {
+	KeyRefs kref;
+	pl->Get(0, kref);
+
+	p_string tuple(kref[0]);
+
+	if (tuple.size() == 0) {
+		tmpPlTuple_ = BuildPayloadTuple(*pl, tagsMatcher_);
+		return string_view(*tmpPlTuple_);
+	}
+
+	return string_view(tuple);
+}
+
+}  // namespace reindexer
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "jsonencoder.h"
+
+namespace reindexer {
+
+/// Primitives of MessagePack format
+namespace msgpack {
+void putNil(WrSerializer &wrser);
+void putBool(WrSerializer &wrser, bool v);
+void putInt(WrSerializer &wrser, int64_t v);
+void putDouble(WrSerializer &wrser, double v);
+void putString(WrSerializer &wrser, const string_view &str);
+void putArray(WrSerializer &wrser, uint32_t size);
+void putMap(WrSerializer &wrser, uint32_t size);
+// Map with unknown size: placeholder is reserved by beginMap, and header is written by endMap
+size_t beginMap(WrSerializer &wrser);
+void endMap(WrSerializer &wrser, size_t pos, uint32_t size);
+}  // namespace msgpack
+
+/// Encodes item to MessagePack map directly from payload and tuple. Structure of map is the same, as of JSON
+class MsgPackEncoder {
+public:
+	MsgPackEncoder(const TagsMatcher &tagsMatcher, const JsonPrintFilter &filter);
+	void Encode(ConstPayload *pl, WrSerializer &wrSer, IJsonEncoderDatasourceWithJoins *ds = nullptr);
+
+protected:
+	bool encodeField(ConstPayload *pl, Serializer &rdser, WrSerializer &wrser, bool visible, uint32_t &count);
+	string_view getPlTuple(ConstPayload *pl);
+
+	const TagsMatcher &tagsMatcher_;
+	int fieldsoutcnt_[maxIndexes];
+	const JsonPrintFilter &filter_;
+	key_string tmpPlTuple_;
+};
+
+}  // namespace reindexer
@@ -32,6 +32,9 @@ void FtFastConfig::parse(char *json) {
 		parseJsonField("min_relevancy", minRelevancy, elem, 0, 1);
 		parseJsonField("max_typos_in_word", maxTyposInWord, elem, 0, 2);
 		parseJsonField("max_typo_len", maxTypoLen, elem, 0, 100);
+		parseJsonField("parallel_terms_threshold", parallelTermsThreshold, elem, 0, 1000);
+		parseJsonField("parallel_merge_threshold", parallelMergeThreshold, elem, 0, 1000000000);
+		parseJsonField("variants_cache_size", variantsCacheSize, elem, 0, 1000000000);
 		parseBase(elem);
 	}
 }
@@ -20,6 +20,13 @@ struct FtFastConfig : public BaseFTConfig {
 
 	int maxTyposInWord = 1;
 	int maxTypoLen = 15;
+
+	// Minimum count of terms in query to lookup them in parallel threads. 0 - disabled
+	int parallelTermsThreshold = 4;
+	// Minimum count of found words entries in documents to merge results in parallel threads. 0 - disabled
+	int parallelMergeThreshold = 100000;
+	// Maximum memory size of cache of query terms variants in bytes. 0 - disabled
+	int variantsCacheSize = 1024 * 1024;
 };
 
 }  // namespace reindexer
@@ -1,4 +1,5 @@
 #include "advacedpackedvec.h"
+#include <algorithm>
 #include "core/ft/idrelset.h"
 namespace reindexer {
 
@@ -11,4 +12,14 @@ AdvacedPackedVec::AdvacedPackedVec(IdRelSet&& data) {
 	min_id_ = data.min_id_;
 	data.clear();
 }
+
+void AdvacedPackedVec::Append(IdRelSet&& data) {
+	data.SimpleCommit();
+
+	insert(end(), data.begin(), data.end());
+
+	max_id_ = std::max(max_id_, data.max_id_);
+	min_id_ = std::min(min_id_, data.min_id_);
+	data.clear();
+}
 }  // namespace reindexer
@@ -8,6 +8,8 @@ struct IdRelType;
 class AdvacedPackedVec : public packed_vector<IdRelType> {
 public:
 	AdvacedPackedVec(IdRelSet &&data);
+	// Append entries of data. Ids of data must be greater, than ids of existing entries
+	void Append(IdRelSet &&data);
 
 	int max_id_;
 	int min_id_;
@@ -1,7 +1,9 @@
 #include "basebuildedholder.h"
+#include <thread>
 
 namespace search_engine {
 using std::move;
+using std::thread;
 
 DIt BaseHolder::GetData(const wchar_t *key) {
 #ifndef DEBUG_FT
@@ -10,13 +12,14 @@ DIt BaseHolder::GetData(const wchar_t *key) {
 	return data_.find(reindexer::HashTreGram(key));
 #endif
 }
-void BaseHolder::SetSize(uint32_t size, VDocIdType id, int field) { words_[id][field] += size; }
-void BaseHolder::AddDada(const wchar_t *key, VDocIdType id, int pos, int field) {
+void BaseHolder::SetSize(uint32_t size, VDocIdType id, int field, int worker) { tmp_words_[worker][id][field] += size; }
+void BaseHolder::AddDada(const wchar_t *key, VDocIdType id, int pos, int field, int worker) {
+	auto &tmp_data = tmp_data_[worker];
 #ifndef DEBUG_FT
 	wstring wkey(key, cfg_.bufferSize);
-	auto it = tmp_data_.find(wkey);
-	if (it == tmp_data_.end()) {
-		auto res = tmp_data_.emplace(wkey, IdRelSet());
+	auto it = tmp_data.find(wkey);
+	if (it == tmp_data.end()) {
+		auto res = tmp_data.emplace(wkey, IdRelSet());
 		it = res.first;
 	}
 
@@ -24,9 +27,9 @@ void BaseHolder::AddDada(const wchar_t *key, VDocIdType id, int pos, int field)
 
 #else
 	uint32_t current_hash = reindexer::HashTreGram(key);
-	auto it = tmp_data_.find(current_hash);
-	if (it == tmp_data_.end()) {
-		auto res = tmp_data_.emplace(current_hash, IdRelSet());
+	auto it = tmp_data.find(current_hash);
+	if (it == tmp_data.end()) {
+		auto res = tmp_data.emplace(current_hash, IdRelSet());
 		it = res.first;
 	}
 	it->second.Add(id, pos, field);
@@ -34,10 +37,53 @@ void BaseHolder::AddDada(const wchar_t *key, VDocIdType id, int pos, int field)
 }
 
 void BaseHolder::Commit() {
-	data_.reserve(tmp_data_.size());
-	data_.clear();
-	for (auto &val : tmp_data_) {
-		data_.insert(std::make_pair(val.first, AdvacedPackedVec(move(val.second))));
+	typedef data_map<AdvacedPackedVec>::key_type key_type;
+	int workers = std::max(int(tmp_data_.size()), 1);
+
+	// Each document is added by one worker, so sizes of documents are just moved
+	for (auto &tmp_words : tmp_words_) {
+		for (auto &val : tmp_words) words_[val.first] = move(val.second);
+	}
+
+	// Keys are partitioned between threads by hash. Each thread merges posting lists of its keys from all the workers and packs them.
+	// Existing posting lists are appended in place, new ones are inserted to data_ after threads are finished
+	vector<vector<pair<key_type, AdvacedPackedVec>>> added(workers);
+	vector<thread> threads;
+	for (int t = 0; t < workers; t++) {
+		threads.emplace_back(
+			[this, workers, &added](int i) {
+				DataStructHash hash;
+				data_map<IdRelSet> merged;
+				for (auto &tmp_data : tmp_data_) {
+					for (auto &val : tmp_data) {
+						if (int(hash(val.first) % workers) != i) continue;
+						auto &ids = merged[val.first];
+						if (ids.empty()) {
+							ids = move(val.second);
+							continue;
+						}
+						for (auto &id : val.second) ids.push_back(move(id));
+						ids.max_id_ = std::max(ids.max_id_, val.second.max_id_);
+						ids.min_id_ = std::min(ids.min_id_, val.second.min_id_);
+					}
+				}
+				for (auto &val : merged) {
+					// Workers add documents by stride, so ids have to be sorted
+					val.second.Commit();
+					auto it = data_.find(val.first);
+					if (it != data_.end()) {
+						it->second.Append(move(val.second));
+					} else {
+						added[i].emplace_back(val.first, AdvacedPackedVec(move(val.second)));
+					}
+				}
+			},
+			t);
+	}
+	for (auto &th : threads) th.join();
+
+	for (auto &part : added) {
+		for (auto &val : part) data_.emplace(move(val.first), move(val.second));
 	}
 
 	ClearTemp();
@@ -59,23 +59,33 @@ public:
 	BaseHolder &operator=(BaseHolder &&) noexcept = delete;
 
 	void ClearTemp() {
-		data_map<IdRelSet> tmp_data;
-		tmp_data_.swap(tmp_data);
+		vector<data_map<IdRelSet>>().swap(tmp_data_);
+		vector<word_size_map>().swap(tmp_words_);
+	}
+	// Prepare temporary data of workers, which add data in parallel threads
+	void InitTemp(int workers) {
+		ClearTemp();
+		tmp_data_.resize(workers);
+		tmp_words_.resize(workers);
 	}
 	DIt end() { return data_.end(); }
 
 	void Clear() {
 		ClearTemp();
 		data_.clear();
+		words_.clear();
 	}
 	void SetConfig(const unique_ptr<FtFuzzyConfig> &cfg) { cfg_ = *cfg.get(); }
 	DIt GetData(const wchar_t *key);
-	void SetSize(uint32_t size, VDocIdType id, int filed);
-	void AddDada(const wchar_t *key, VDocIdType id, int pos, int field);
+	void SetSize(uint32_t size, VDocIdType id, int filed, int worker);
+	void AddDada(const wchar_t *key, VDocIdType id, int pos, int field, int worker);
+	// Merge temporary data of workers to data. Ids of added documents must be greater, than ids of already commited documents
 	void Commit();
 
 public:
-	data_map<IdRelSet> tmp_data_;
+	// Temporary data of each worker
+	vector<data_map<IdRelSet>> tmp_data_;
+	vector<word_size_map> tmp_words_;
 	data_map<AdvacedPackedVec> data_;
 	word_size_map words_;
 	FtFuzzyConfig cfg_;
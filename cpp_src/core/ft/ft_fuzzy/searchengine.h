@@ -29,14 +29,16 @@ public:
 	SearchEngine &operator=(const SearchEngine &) = delete;
 
 	SearchResult Search(const FtDSLQuery &dsl);
+	// Remove all the data for full rebuild
 	void Rebuild();
-	void AddData(const reindexer::string_view &src_data, const IdType id, int field, const string &extraWordSymbols);
+	// Start adding data by workers. Each worker can add data in its own thread, and each document must be added by one worker
+	void StartAdding(int workers);
+	void AddData(const reindexer::string_view &src_data, const IdType id, int field, const string &extraWordSymbols, int worker);
+	// Merge added data. Ids of added documents must be greater, than ids of already commited documents
 	void Commit();
 
 private:
 	BaseHolder::Ptr holder_;
 	BaseSearcher seacher_;
-	size_t last_max_id_;
-	bool commited_;
 };
 }  // namespace search_engine
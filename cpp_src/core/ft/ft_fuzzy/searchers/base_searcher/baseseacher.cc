@@ -15,6 +15,11 @@ using std::pair;
 using std::make_pair;
 using namespace reindexer;
 
+// Minimum count of terms in query to probe them in parallel threads
+const int kMinTermsForParallelSearch = 4;
+// Maximum count of threads, used to process one search query
+const int kMaxSearchThreads = 8;
+
 void BaseSearcher::AddSeacher(ISeacher::Ptr seacher) { searchers_.push_back(seacher); }
 
 pair<bool, size_t> BaseSearcher::GetData(BaseHolder::Ptr holder, unsigned int i, wchar_t *buf, const wchar_t *src_data, size_t data_size) {
@@ -72,32 +77,45 @@ size_t BaseSearcher::ParseData(BaseHolder::Ptr holder, const wstring &src_data,
 	return total_size;
 }
 
-SearchResult BaseSearcher::Compare(BaseHolder::Ptr holder, const FtDSLQuery &dsl) {
-	size_t data_size = 0;
-
+void BaseSearcher::ParseTerm(BaseHolder::Ptr holder, const FtDSLEntry &term, TermResults &res) {
 	vector<pair<std::wstring, ProcType>> data;
-	pair<PosType, ProcType> pos;
-	pos.first = 0;
+	res.data_size += ParseData(holder, term.pattern, res.max_id, res.min_id, res.rusults, term.opts, 1);
+
+	if (holder->cfg_.enableTranslit) {
+		searchers_[0]->Build(term.pattern.c_str(), term.pattern.size(), data);
+		ParseData(holder, data[0].first, res.max_id, res.min_id, res.rusults, term.opts, holder->cfg_.startDefaultDecreese);
+	}
+	if (holder->cfg_.enableKbLayout) {
+		data.clear();
+		searchers_[1]->Build(term.pattern.c_str(), term.pattern.size(), data);
+		ParseData(holder, data[0].first, res.max_id, res.min_id, res.rusults, term.opts, holder->cfg_.startDefaultDecreese);
+	}
+}
+
+SearchResult BaseSearcher::Compare(BaseHolder::Ptr holder, const FtDSLQuery &dsl) {
+	// Terms are probed in parallel threads for long queries. Results of terms are merged in order of terms
+	vector<TermResults> termsResults(dsl.size());
+	int threads = std::thread::hardware_concurrency();
+	threads = std::max(1, std::min({threads, kMaxSearchThreads, int(dsl.size())}));
+	if (int(dsl.size()) < kMinTermsForParallelSearch) threads = 1;
+
+	auto parseTerms = [this, &holder, &dsl, &termsResults, threads](int i) {
+		for (size_t t = i; t < dsl.size(); t += threads) ParseTerm(holder, dsl[t], termsResults[t]);
+	};
+	vector<std::thread> workers;
+	for (int i = 1; i < threads; i++) workers.emplace_back(parseTerms, i);
+	parseTerms(0);
+	for (auto &worker : workers) worker.join();
 
-	SmartDeque<IdContext, 100> result;
+	size_t data_size = 0;
 	std::vector<FirstResult> rusults;
 	int max_id = 0;
 	int min_id = INT32_MAX;
-	FtDslOpts opts;
-
-	for (auto &term : dsl) {
-		data_size += ParseData(holder, term.pattern, max_id, min_id, rusults, term.opts, 1);
-
-		if (holder->cfg_.enableTranslit) {
-			searchers_[0]->Build(term.pattern.c_str(), term.pattern.size(), data);
-
-			ParseData(holder, data[0].first, max_id, min_id, rusults, term.opts, holder->cfg_.startDefaultDecreese);
-		}
-		if (holder->cfg_.enableKbLayout) {
-			data.clear();
-			searchers_[1]->Build(term.pattern.c_str(), term.pattern.size(), data);
-			ParseData(holder, data[0].first, max_id, min_id, rusults, term.opts, holder->cfg_.startDefaultDecreese);
-		}
+	for (auto &termResults : termsResults) {
+		data_size += termResults.data_size;
+		max_id = std::max(max_id, termResults.max_id);
+		min_id = std::min(min_id, termResults.min_id);
+		rusults.insert(rusults.end(), termResults.rusults.begin(), termResults.rusults.end());
 	}
 
 	BaseMerger mrg(max_id, min_id);
@@ -123,7 +141,7 @@ SearchResult BaseSearcher::Compare(BaseHolder::Ptr holder, const FtDSLQuery &dsl
 }
 
 void BaseSearcher::AddIndex(BaseHolder::Ptr holder, const reindexer::string_view &src_data, const IdType id, int field,
-							const string &extraWordSymbols) {
+							const string &extraWordSymbols, int worker) {
 #ifdef FULL_LOG_FT
 	words.push_back(std::make_pair(id, *src_data));
 #endif
@@ -142,13 +160,13 @@ void BaseSearcher::AddIndex(BaseHolder::Ptr holder, const reindexer::string_view
 		pair<bool, size_t> cont;
 		do {
 			cont = GetData(holder, i, res_buf, term.c_str(), term.size());
-			holder->AddDada(res_buf, id, i, field);
+			holder->AddDada(res_buf, id, i, field, worker);
 			i++;
 			total_size++;
 
 		} while (cont.first);
 	}
-	holder->SetSize(total_size, id, field);
+	holder->SetSize(total_size, id, field, worker);
 }
 
 void BaseSearcher::Commit(BaseHolder::Ptr holder) { holder->Commit(); }
@@ -5,6 +5,7 @@
 #include "core/ft/ft_fuzzy/searchers/isearcher.h"
 #include "core/ft/ftdsl.h"
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -21,7 +22,7 @@ class BaseSearcher {
 public:
 	void AddSeacher(ISeacher::Ptr seacher);
 	void AddIndex(BaseHolder::Ptr holder, const reindexer::string_view &src_data, const IdType id, int field,
-				  const string &extraWordSymbols);
+				  const string &extraWordSymbols, int worker);
 	SearchResult Compare(BaseHolder::Ptr holder, const reindexer::FtDSLQuery &dsl);
 
 	void Commit(BaseHolder::Ptr holder);
@@ -35,6 +36,14 @@ private:
 
 	size_t ParseData(BaseHolder::Ptr holder, const wstring &src_data, int &max_id, int &min_id, std::vector<FirstResult> &rusults,
 					 const FtDslOpts &opts, double proc);
+	// Probe holder by windows of term and its variants
+	struct TermResults {
+		std::vector<FirstResult> rusults;
+		size_t data_size = 0;
+		int max_id = 0;
+		int min_id = INT32_MAX;
+	};
+	void ParseTerm(BaseHolder::Ptr holder, const FtDSLEntry &term, TermResults &res);
 
 	void AddIdToInfo(Info *info, const IdType id, pair<PosType, ProcType> pos, uint32_t total_size);
 	uint32_t FindHash(const wstring &data);
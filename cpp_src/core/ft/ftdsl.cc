@@ -22,7 +22,9 @@ void FtDSLQuery::parse(const string &q) {
 	parse(utf16str);
 }
 void FtDSLQuery::parse(wstring &utf16str) {
-	int groupcnt = 0;
+	int groupcnt = 0, groupPos = 0;
+	// Positions of terms of current group, including skipped stop words
+	h_vector<int, 8> groupPositions;
 	bool ingroup = false;
 	int maxPatternLen = 1;
 	h_vector<float, 8> fieldsBoost;
@@ -53,7 +55,9 @@ void FtDSLQuery::parse(wstring &utf16str) {
 			// closing group
 			if (!ingroup) {
 				int distance = 1;
+				bool phrase = true;
 				if (it != utf16str.end() && *it == '~') {
+					phrase = false;
 					wchar_t *end = nullptr, *start = &*++it;
 					distance = wcstod(start, &end);
 					it += end - start;
@@ -61,14 +65,21 @@ void FtDSLQuery::parse(wstring &utf16str) {
 						throw Error(errParseDSL, "Expected digit after '~' operator in phrase, but found '%c' ", char(*start));
 				}
 				assertf(groupcnt <= int(size()), "groupcnt=%d,size=%d", groupcnt, int(size()));
-				if (groupcnt > 1) {
-					auto fteIt = end();
-					while (--groupcnt) {
-						fteIt--;
-						fteIt->opts.distance = distance;
-						fteIt->opts.op = OpAnd;
+				// First term of group keeps its operation, next terms must be near to previous ones
+				for (int i = 1; i < groupcnt; i++) {
+					auto &opts = (*this)[size() - groupcnt + i].opts;
+					if (phrase) {
+						// Stop words are skipped in query, but they are counted in positions of words in documents
+						opts.distance = groupPositions[i] - groupPositions[i - 1];
+						opts.phrase = true;
+					} else {
+						opts.distance = distance;
 					}
+					opts.op = OpAnd;
 				}
+				groupcnt = 0;
+				groupPos = 0;
+				groupPositions.clear();
 			}
 		}
 		if (it != utf16str.end() && *it == '=') {
@@ -106,6 +117,7 @@ void FtDSLQuery::parse(wstring &utf16str) {
 			fte.pattern.assign(begIt, endIt);
 			string utf8str = utf16_to_utf8(fte.pattern);
 			if (is_number(utf8str)) fte.opts.number = true;
+			if (ingroup) groupPos++;
 			if (stopWords_.find(utf8str) != stopWords_.end()) {
 				continue;
 			}
@@ -114,7 +126,10 @@ void FtDSLQuery::parse(wstring &utf16str) {
 				maxPatternLen = fte.pattern.length();
 			}
 			push_back(fte);
-			if (ingroup) groupcnt++;
+			if (ingroup) {
+				groupcnt++;
+				groupPositions.push_back(groupPos);
+			}
 		}
 	}
 	if (ingroup) {
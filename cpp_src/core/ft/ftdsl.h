@@ -24,7 +24,9 @@ struct FtDslOpts {
 	OpType op = OpOr;
 	float boost = 1.0;
 	float termLenBoost = 1.0;
+	// Max distance to previous term of phrase. If phrase is set, term must be exactly distance words after previous term
 	int distance = INT_MAX;
+	bool phrase = false;
 	h_vector<float, 8> fieldsBoost;
 	int qpos = 0;
 };
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/lrucache.h"
+
+namespace reindexer {
+
+using std::string;
+using std::wstring;
+using std::vector;
+
+// Variant of full text query term: term itself, its translit, kblayout and stemmed forms
+struct FtVariantEntry {
+	string pattern;
+	int proc;
+	// Variant matches words, which have it as prefix (suffix)
+	bool pref;
+	bool suff;
+};
+
+using FtVariants = vector<FtVariantEntry>;
+
+struct FtVariantsCacheKey {
+	FtVariantsCacheKey(const wstring &pattern, int flags) : pattern(&pattern), flags(flags) {}
+	FtVariantsCacheKey(const FtVariantsCacheKey &other) : pattern(&hpattern), flags(other.flags), hpattern(*other.pattern) {}
+	FtVariantsCacheKey &operator=(const FtVariantsCacheKey &other) {
+		hpattern = *other.pattern;
+		pattern = &hpattern;
+		flags = other.flags;
+		return *this;
+	}
+	size_t Size() const { return sizeof(FtVariantsCacheKey) + hpattern.capacity() * sizeof(wchar_t); }
+
+	const wstring *pattern;
+	// Options of term, which variants depend on
+	int flags;
+	wstring hpattern;
+};
+
+struct FtVariantsCacheVal {
+	FtVariantsCacheVal() {}
+	FtVariantsCacheVal(const std::shared_ptr<const FtVariants> &v) : variants(v) {}
+	size_t Size() const {
+		if (!variants) return 0;
+		size_t size = sizeof(FtVariants) + variants->capacity() * sizeof(FtVariantEntry);
+		for (auto &v : *variants) size += v.pattern.capacity();
+		return size;
+	}
+
+	std::shared_ptr<const FtVariants> variants;
+};
+
+struct equal_ft_variants_cache_key {
+	bool operator()(const FtVariantsCacheKey &lhs, const FtVariantsCacheKey &rhs) const {
+		return lhs.flags == rhs.flags && *lhs.pattern == *rhs.pattern;
+	}
+};
+struct hash_ft_variants_cache_key {
+	size_t operator()(const FtVariantsCacheKey &s) const { return std::hash<wstring>()(*s.pattern) ^ (size_t(s.flags) << 24); }
+};
+
+// Cache of variants of query terms. Values are immutable, so they are shared between concurrent queries
+class FtVariantsCache : public LRUCache<FtVariantsCacheKey, FtVariantsCacheVal, hash_ft_variants_cache_key, equal_ft_variants_cache_key> {
+public:
+	// Variants are cached on the first lookup of term
+	FtVariantsCache(size_t sizeLimit) : LRUCache(sizeLimit, 1) {}
+};
+
+}  // namespace reindexer
@@ -58,6 +58,23 @@ int IdRelType::distance(const IdRelType& other, int max) const {
 	}
 	return max;
 }
+bool IdRelType::intersect(const IdRelType& other, int distance, bool ordered) {
+	// Positions of different fields differ by more than posBits, so they are never near
+	distance = std::min(distance, (1 << PosType::posBits) - 1);
+	auto kept = pos.begin();
+	auto j = other.pos.begin();
+	for (auto i = pos.begin(); i != pos.end(); i++) {
+		int64_t cur = i->fpos;
+		// Skip positions of other, which are too far before current position
+		while (j != other.pos.end() && int64_t(j->fpos) + distance < cur) j++;
+		if (j == other.pos.end()) break;
+		bool near = ordered ? int64_t(j->fpos) + distance == cur : int64_t(j->fpos) <= cur + distance;
+		if (near) *kept++ = *i;
+	}
+	pos.erase(kept, pos.end());
+	return !pos.empty();
+}
+
 int IdRelType::wordsInField(int field) {
 	unsigned i = 0;
 	int wcount = 0;
@@ -82,7 +99,7 @@ int IdRelSet::Add(VDocIdType id, int pos, int field) {
 }
 
 void IdRelSet::Commit() {
-	std::sort(begin(), end(), [](const IdRelType& lhs, const IdRelType& rhs) { return lhs.rank() > rhs.rank(); });
+	std::sort(begin(), end(), [](const IdRelType& lhs, const IdRelType& rhs) { return lhs.id < rhs.id; });
 }
 
 void IdRelSet::SimpleCommit() {
@@ -92,4 +109,158 @@ void IdRelSet::SimpleCommit() {
 	}
 }
 
+void PackedIdRelSet::Pack(const IdRelSet& set) {
+	clear();
+	blocks_.reserve((set.size() + kBlockSize - 1) / kBlockSize);
+	ranks_.reserve(set.size());
+
+	for (size_t first = 0; first < set.size(); first += kBlockSize) {
+		int count = std::min(size_t(kBlockSize), set.size() - first);
+		const IdRelType* entries = &set[first];
+
+		Block block;
+		block.firstId = entries[0].id;
+		block.lastId = entries[count - 1].id;
+		block.count = count;
+		block.maxRank = 0;
+		block.maxTf = 0;
+
+		uint32_t maxDelta = 0;
+		for (int i = 1; i < count; i++) {
+			assert(entries[i].id > entries[i - 1].id);
+			maxDelta = std::max(maxDelta, uint32_t(entries[i].id - entries[i - 1].id));
+		}
+		block.idWidth = maxDelta <= 0xFF ? 1 : (maxDelta <= 0xFFFF ? 2 : 4);
+
+		// Ids stream: deltas of ids with fixed width
+		block.idsOffset = ids_.size();
+		ids_.resize(ids_.size() + count * block.idWidth);
+		uint8_t* p = ids_.begin() + block.idsOffset;
+		VDocIdType prev = block.firstId;
+		for (int i = 0; i < count; i++, p += block.idWidth) {
+			uint32_t delta = entries[i].id - prev;
+			prev = entries[i].id;
+			if (block.idWidth == 1) {
+				*p = uint8_t(delta);
+			} else if (block.idWidth == 2) {
+				uint16_t d = delta;
+				memcpy(p, &d, sizeof(d));
+			} else {
+				memcpy(p, &delta, sizeof(delta));
+			}
+		}
+
+		// Ranks and positions streams
+		block.posOffset = pos_.size();
+		for (int i = 0; i < count; i++) {
+			uint8_t rank = std::min(entries[i].rank(), 0xFF);
+			ranks_.push_back(rank);
+			block.maxRank = std::max(block.maxRank, rank);
+			block.maxTf = std::max(block.maxTf, uint16_t(std::min(size_t(entries[i].pos.size()), size_t(kMaxTfUnknown))));
+
+			size_t offset = pos_.size();
+			pos_.resize(offset + (entries[i].pos.size() + 1) * 5);
+			p = pos_.begin() + offset;
+			p += uint32_pack(entries[i].pos.size(), p);
+			uint32_t last = 0;
+			for (auto c : entries[i].pos) {
+				p += uint32_pack(c.fpos - last, p);
+				last = c.fpos;
+			}
+			pos_.resize(p - pos_.begin());
+		}
+		blocks_.push_back(block);
+	}
+	size_ = set.size();
+}
+
+void PackedIdRelSet::shrink_to_fit() {
+	blocks_.shrink_to_fit();
+	ids_.shrink_to_fit();
+	ranks_.shrink_to_fit();
+	pos_.shrink_to_fit();
+}
+
+void PackedIdRelSet::clear() {
+	blocks_.clear();
+	ids_.clear();
+	ranks_.clear();
+	pos_.clear();
+	size_ = 0;
+}
+
+void PackedIdRelSet::iterator::loadBlock() {
+	idx_ = 0;
+	unpacked_ = false;
+	if (block_ >= int(set_->blocks_.size())) {
+		count_ = 0;
+		return;
+	}
+	const Block& block = set_->blocks_[block_];
+	count_ = block.count;
+	pos_ = set_->pos_.data() + block.posOffset;
+
+	// Decode deltas to ids, then restore ids by prefix sum. Loops are simple enough to be vectorized by compiler
+	const uint8_t* src = set_->ids_.data() + block.idsOffset;
+	switch (block.idWidth) {
+		case 1:
+			for (int i = 0; i < count_; i++) ids_[i] = src[i];
+			break;
+		case 2: {
+			uint16_t deltas[kBlockSize];
+			memcpy(deltas, src, count_ * sizeof(uint16_t));
+			for (int i = 0; i < count_; i++) ids_[i] = deltas[i];
+			break;
+		}
+		default:
+			memcpy(ids_, src, count_ * sizeof(uint32_t));
+	}
+	VDocIdType id = block.firstId;
+	for (int i = 0; i < count_; i++) ids_[i] = (id += ids_[i]);
+}
+
+IdRelType& PackedIdRelSet::iterator::unpack() {
+	if (unpacked_) return cur_;
+	const uint8_t* p = pos_;
+	auto l = scan_varint(5, p);
+	int sz = parse_uint32(l, p);
+	p += l;
+
+	cur_.id = Id();
+	cur_.pos.resize(sz);
+	uint32_t last = 0;
+	for (int i = 0; i < sz; i++) {
+		l = scan_varint(5, p);
+		cur_.pos[i].fpos = parse_uint32(l, p) + last;
+		last = cur_.pos[i].fpos;
+		p += l;
+	}
+	posEnd_ = p;
+	unpacked_ = true;
+	return cur_;
+}
+
+const uint8_t* PackedIdRelSet::iterator::skipPositions(const uint8_t* p) {
+	auto l = scan_varint(5, p);
+	int sz = parse_uint32(l, p);
+	p += l;
+	for (int i = 0; i < sz; i++) {
+		while (*p++ & 0x80)
+			;
+	}
+	return p;
+}
+
+void PackedIdRelSet::iterator::SkipTo(VDocIdType id) {
+	auto& blocks = set_->blocks_;
+	if (block_ >= int(blocks.size())) return;
+	if (blocks[block_].lastId < id) {
+		auto it = std::lower_bound(blocks.begin() + block_ + 1, blocks.end(), id,
+								   [](const Block& block, VDocIdType id) { return block.lastId < id; });
+		block_ = it - blocks.begin();
+		loadBlock();
+	}
+	while (idx_ < count_ && Id() < id) ++(*this);
+}
+
 }  // namespace reindexer
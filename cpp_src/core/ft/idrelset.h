@@ -3,7 +3,6 @@
 #include <limits.h>
 #include <algorithm>
 #include "estl/h_vector.h"
-#include "estl/packed_vector.h"
 namespace reindexer {
 
 typedef int VDocIdType;
@@ -26,6 +25,9 @@ struct IdRelType {
 	int rank() const { return !pos.size() ? 0 : pos2rank(pos.front().pos()) + std::max(10, int(pos.size())); }
 
 	int distance(const IdRelType& other, int max) const;
+	// Keep only positions near to positions of other in the same field: exactly distance words after them, if ordered,
+	// or not more than distance words before or after them otherwise. Returns false, if no positions are kept
+	bool intersect(const IdRelType& other, int distance, bool ordered);
 
 	int wordsInField(int field);
 	// packed_vector callbacks
@@ -56,6 +58,89 @@ public:
 	VDocIdType min_id_ = INT_MAX;
 };
 
-using PackedIdRelSet = packed_vector<IdRelType>;
+// Posting list of word. Entries are sorted by id and packed by blocks of kBlockSize entries.
+// Each block has skip entry with range of ids and max rank of its entries. Ids are delta coded with fixed width per block,
+// so block is decoded by simple loops without branches. Ranks and positions are stored in separate streams,
+// so entries can be skipped without unpacking positions
+class PackedIdRelSet {
+public:
+	static const int kBlockSize = 128;
+	static const uint16_t kMaxTfUnknown = 0xFFFF;
+
+	struct Block {
+		VDocIdType firstId;
+		VDocIdType lastId;
+		// Offsets of block data in ids and positions streams
+		uint32_t idsOffset;
+		uint32_t posOffset;
+		// Max count of positions of block entries. kMaxTfUnknown, if it does not fit
+		uint16_t maxTf;
+		uint8_t count;
+		// Width of id delta in bytes: 1, 2 or 4
+		uint8_t idWidth;
+		uint8_t maxRank;
+	};
+
+	class iterator {
+	public:
+		iterator(const PackedIdRelSet* set, int block) : set_(set), block_(block) { loadBlock(); }
+
+		iterator& operator++() {
+			pos_ = unpacked_ ? posEnd_ : skipPositions(pos_);
+			unpacked_ = false;
+			if (++idx_ == count_) {
+				block_++;
+				loadBlock();
+			}
+			return *this;
+		}
+		IdRelType* operator->() { return &unpack(); }
+		IdRelType& operator*() { return unpack(); }
+		bool operator!=(const iterator& rhs) const { return block_ != rhs.block_ || idx_ != rhs.idx_; }
+		bool operator==(const iterator& rhs) const { return !(*this != rhs); }
+
+		// Id and rank of current entry. They are available without unpacking positions
+		VDocIdType Id() const { return ids_[idx_]; }
+		int Rank() const { return set_->ranks_[block_ * kBlockSize + idx_]; }
+		// Skip entries with ids less than id. Blocks are skipped by their skip entries without decoding
+		void SkipTo(VDocIdType id);
+
+	protected:
+		void loadBlock();
+		IdRelType& unpack();
+		static const uint8_t* skipPositions(const uint8_t* p);
+
+		const PackedIdRelSet* set_;
+		int block_;
+		int idx_ = 0;
+		int count_ = 0;
+		bool unpacked_ = false;
+		const uint8_t* pos_ = nullptr;
+		const uint8_t* posEnd_ = nullptr;
+		VDocIdType ids_[kBlockSize];
+		IdRelType cur_;
+	};
+
+	iterator begin() const { return iterator(this, 0); }
+	iterator end() const { return iterator(this, blocks_.size()); }
+
+	// Pack entries of set. Entries of set must be sorted by id
+	void Pack(const IdRelSet& set);
+	const h_vector<Block, 0>& Blocks() const { return blocks_; }
+	// Ranks of entries. Ranks of block entries start from block number * kBlockSize
+	const h_vector<uint8_t, 0>& Ranks() const { return ranks_; }
+	unsigned size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	void shrink_to_fit();
+	size_t heap_size() const { return blocks_.heap_size() + ids_.heap_size() + ranks_.heap_size() + pos_.heap_size(); }
+	void clear();
+
+protected:
+	h_vector<Block, 0> blocks_;
+	h_vector<uint8_t, 0> ids_;
+	h_vector<uint8_t, 0> ranks_;
+	h_vector<uint8_t, 0> pos_;
+	unsigned size_ = 0;
+};
 
 }  // namespace reindexer
@@ -37,4 +37,18 @@ void mktypos(typos_context *ctx, const char *word, int level, int maxTyposLen, s
 	mktyposInternal(ctx, ctx->utf16Word, level, maxTyposLen, callback);
 }
 
+bool istypo(const wstring &word, const wstring &typo, int level, int maxTyposLen) {
+	if (typo.length() > word.length()) return false;
+	int deleted = word.length() - typo.length();
+	if (deleted > level) return false;
+	// Each deletion step of mktypos requires length of word in range [3, maxTyposLen]
+	if (deleted && (int(word.length()) > maxTyposLen || int(word.length()) - deleted + 1 < 3)) return false;
+	// Typo is result of deletion of some symbols of word, so it is subsequence of word
+	size_t i = 0;
+	for (auto ch : word) {
+		if (i < typo.length() && typo[i] == ch) i++;
+	}
+	return i == typo.length();
+}
+
 }  // namespace reindexer
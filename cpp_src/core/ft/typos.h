@@ -16,5 +16,7 @@ const int kMaxTyposInWord = 4;
 
 void mktypos(typos_context *ctx, const wstring &word, int level, int maxTyposLen, std::function<void(const string &, int)> callback);
 void mktypos(typos_context *ctx, const char *word, int level, int maxTyposLen, std::function<void(const string &, int)> callback);
+// Check, that typo is generated by mktypos from word with the same level and maxTyposLen
+bool istypo(const wstring &word, const wstring &typo, int level, int maxTyposLen);
 
 }  // namespace reindexer
@@ -0,0 +1,66 @@
+#include "typosmap.h"
+#include <algorithm>
+#include <thread>
+#include "tools/customhash.h"
+
+namespace reindexer {
+
+// Max bits of signature prefix in directory
+const int kMaxTyposDirBits = 20;
+
+uint32_t TyposMap::Signature(const string &typo) { return _Hash_bytes(typo.data(), typo.size()); }
+
+void TyposMap::Build(vector<vector<Entry>> &&parts) {
+	clear();
+
+	vector<std::thread> sorters;
+	size_t total = 0;
+	for (auto &part : parts) {
+		total += part.size();
+		sorters.emplace_back([&part]() {
+			std::sort(part.begin(), part.end());
+			part.erase(std::unique(part.begin(), part.end()), part.end());
+		});
+	}
+	for (auto &sorter : sorters) sorter.join();
+
+	// Merge sorted parts
+	entries_.reserve(total);
+	for (auto &part : parts) {
+		size_t mid = entries_.size();
+		entries_.insert(entries_.end(), part.begin(), part.end());
+		vector<Entry>().swap(part);
+		std::inplace_merge(entries_.begin(), entries_.begin() + mid, entries_.end());
+	}
+	entries_.erase(std::unique(entries_.begin(), entries_.end()), entries_.end());
+	entries_.shrink_to_fit();
+
+	// Build directory with about 4 entries per slot
+	dirBits_ = 0;
+	while (dirBits_ < kMaxTyposDirBits && (size_t(1) << (dirBits_ + 2)) < entries_.size()) dirBits_++;
+	dir_.resize((size_t(1) << dirBits_) + 1);
+	size_t pos = 0;
+	for (uint32_t i = 0; i < dir_.size() - 1; i++) {
+		dir_[i] = pos;
+		while (pos < entries_.size() && dirIdx(entries_[pos].sig) == i) pos++;
+	}
+	dir_.back() = entries_.size();
+}
+
+TyposMap::Range TyposMap::Find(const string &typo) const {
+	if (entries_.empty()) return {nullptr, nullptr};
+	uint32_t sig = Signature(typo);
+	uint32_t idx = dirIdx(sig);
+	const Entry *first = entries_.data() + dir_[idx], *last = entries_.data() + dir_[idx + 1];
+	auto lower = std::lower_bound(first, last, sig, [](const Entry &e, uint32_t s) { return e.sig < s; });
+	auto upper = std::upper_bound(lower, last, sig, [](uint32_t s, const Entry &e) { return s < e.sig; });
+	return {lower, upper};
+}
+
+void TyposMap::clear() {
+	vector<Entry>().swap(entries_);
+	vector<uint32_t>().swap(dir_);
+	dirBits_ = 0;
+}
+
+}  // namespace reindexer
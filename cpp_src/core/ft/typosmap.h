@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace reindexer {
+
+using std::string;
+using std::vector;
+
+// Compact multimap of typos to words ids. Typos strings are not stored, map keeps only 32 bit signatures of typos,
+// so found words ids are candidates, which have to be verified by caller (see istypo)
+class TyposMap {
+public:
+	struct Entry {
+		uint32_t sig;
+		int wordId;
+		bool operator<(const Entry &other) const { return sig < other.sig || (sig == other.sig && wordId < other.wordId); }
+		bool operator==(const Entry &other) const { return sig == other.sig && wordId == other.wordId; }
+	};
+	using Range = std::pair<const Entry *, const Entry *>;
+
+	static uint32_t Signature(const string &typo);
+
+	// Build map from parts of entries. Parts are sorted in parallel threads and merged
+	void Build(vector<vector<Entry>> &&parts);
+	// Candidates for typo
+	Range Find(const string &typo) const;
+
+	size_t size() const { return entries_.size(); }
+	bool empty() const { return entries_.empty(); }
+	size_t heap_size() const { return entries_.capacity() * sizeof(Entry) + dir_.capacity() * sizeof(uint32_t); }
+	void clear();
+
+protected:
+	uint32_t dirIdx(uint32_t sig) const { return dirBits_ ? sig >> (32 - dirBits_) : 0; }
+
+	// Entries sorted by signature
+	vector<Entry> entries_;
+	// Directory by high bits of signature: entries with dirIdx == i are in range [dir_[i], dir_[i + 1])
+	vector<uint32_t> dir_;
+	int dirBits_ = 0;
+};
+
+}  // namespace reindexer
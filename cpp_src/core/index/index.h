@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 #include "core/idset.h"
 #include "core/index/keyentry.h"
@@ -33,6 +34,9 @@ public:
 	virtual void Delete(const KeyRef& key, IdType id) = 0;
 	virtual void DumpKeys() = 0;
 	virtual IdSetRef Find(const KeyRef& key) = 0;
+	// Enumerate all keys of index with ids of items, containing key. Index must be commited.
+	// Returns false, if index does not support keys enumeration
+	virtual bool ForEachKey(const std::function<void(const KeyRef& key, const IdSetRef& ids)>&) { return false; }
 
 	virtual SelectKeyResults SelectKey(const KeyValues& keys, CondType condition, SortType stype, ResultType res_type,
 									   BaseFunctionCtx::Ptr ctx) = 0;
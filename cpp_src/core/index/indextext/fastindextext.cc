@@ -3,8 +3,13 @@
 #include <thread>
 #include "core/ft/bm25.h"
 #include "core/ft/numtotext.h"
+#include "estl/fast_hash_set.h"
 #include "tools/logger.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace reindexer {
 
 // Relevancy procent of full word match
@@ -24,31 +29,59 @@ const int kStemProcDecrease = 15;
 
 const int kDigitUtfSizeof = 1;
 
+// Delta segments are merged into main segment by full rebuild, when count of their documents and deleted documents exceeds
+// max(kMinDocsToMerge, kMaxDeltaRatio * (count of main segment documents))
+const int kMinDocsToMerge = 1000;
+const double kMaxDeltaRatio = 0.1;
+
+// Maximum count of threads, used to process one select query
+const int kMaxSelectThreads = 8;
+// Minimum count of documents in one partition of parallel merge
+const int kMinMergePartitionSize = 1000;
+
 using std::thread;
 using std::chrono::duration_cast;
 using std::chrono::milliseconds;
 using std::chrono::high_resolution_clock;
 
+static int selectThreadsCount() {
+	int threads = std::thread::hardware_concurrency();
+	return std::max(1, std::min(threads, kMaxSelectThreads));
+}
+
 template <typename T>
-void FastIndexText<T>::buildTyposMap() {
+void FastIndexText<T>::buildTyposMap(WordsSegment &segment, const vector<const string *> &words) {
 	if (!GetConfig()->maxTyposInWord) {
 		return;
 	}
 
-	typos_context tctx[kMaxTyposInWord];
-	auto &typos = typos_;
-	typos_.clear();
-	typos_.reserve(words_.size() * (10 >> (GetConfig()->maxTyposInWord - 1)) / 2,
-				   words_.size() * 5 * (10 >> (GetConfig()->maxTyposInWord - 1)));
-	for (size_t wordId = 0; wordId < words_.size(); wordId++) {
-		mktypos(tctx, suffixes_.word_at(wordId), GetConfig()->maxTyposInWord, GetConfig()->maxTypoLen,
-				[&typos, wordId](const string &typo, int) { typos.emplace(typo, wordId); });
-	}
-	typos_.shrink_to_fit();
+	int maxIndexWorkers = std::thread::hardware_concurrency();
+	if (!maxIndexWorkers) maxIndexWorkers = 1;
+	if (maxIndexWorkers > 8) maxIndexWorkers = 8;
+
+	// Each worker generates typos of its range of words
+	vector<vector<TyposMap::Entry>> parts(maxIndexWorkers);
+	vector<thread> workers;
+	size_t rangeSize = words.size() / maxIndexWorkers + 1;
+	auto *cfg = GetConfig();
+	for (int t = 0; t < maxIndexWorkers; t++) {
+		workers.emplace_back([&words, &parts, rangeSize, cfg](int i) {
+			typos_context tctx[kMaxTyposInWord];
+			auto &part = parts[i];
+			size_t last = std::min(words.size(), (i + 1) * rangeSize);
+			for (WordIdType wordId = i * rangeSize; wordId < WordIdType(last); wordId++) {
+				mktypos(tctx, words[wordId]->c_str(), cfg->maxTyposInWord, cfg->maxTypoLen,
+						[&part, wordId](const string &typo, int) { part.push_back({TyposMap::Signature(typo), wordId}); });
+			}
+		}, t);
+	}
+	for (auto &worker : workers) worker.join();
+
+	segment.typos.Build(std::move(parts));
 }
 
 template <typename T>
-void FastIndexText<T>::buildWordsMap(fast_hash_map<string, WordEntry> &words_um) {
+void FastIndexText<T>::buildWordsMap(fast_hash_map<string, WordEntry> &words_um, VDocIdType firstVdoc) {
 	int maxIndexWorkers = !this->opts_.IsDense() ? std::thread::hardware_concurrency() : 0;
 	if (!maxIndexWorkers) maxIndexWorkers = 1;
 	if (maxIndexWorkers > 8) maxIndexWorkers = 8;
@@ -61,18 +94,12 @@ void FastIndexText<T>::buildWordsMap(fast_hash_map<string, WordEntry> &words_um)
 
 	// buffer strings, for printing non text fields
 	vector<unique_ptr<string>> bufStrs;
-	// array with pointers to docs fields text
+	// array with pointers to docs fields text, starting from firstVdoc. Deleted docs have no text
 	vector<h_vector<pair<string_view, int>, 8>> vdocsTexts;
-	// Prepare vdocs -> addresable array all docs in the index
-	this->vdocs_.reserve(this->idx_map.size());
-	vdocsTexts.reserve(this->idx_map.size());
-	for (auto &doc : this->idx_map) {
-#ifdef REINDEX_FT_EXTRA_DEBUG
-		this->vdocs_.push_back({&doc.first, &doc.second, {}, {}});
-#else
-		this->vdocs_.push_back({&doc.second, {}, {}});
-#endif
-		vdocsTexts.emplace_back(this->getDocFields(doc.first, bufStrs));
+	vdocsTexts.reserve(this->vdocs_.size() - firstVdoc);
+	for (VDocIdType j = firstVdoc; j < VDocIdType(this->vdocs_.size()); j++) {
+		auto &vdoc = this->vdocs_[j];
+		vdocsTexts.emplace_back(vdoc.keyEntry ? this->getDocFields(*vdoc.keyDoc, bufStrs) : h_vector<pair<string_view, int>, 8>());
 	}
 
 	int fieldscount = std::max(1, int(this->fields_.size()));
@@ -80,18 +107,21 @@ void FastIndexText<T>::buildWordsMap(fast_hash_map<string, WordEntry> &words_um)
 	// build words map parallel in maxIndexWorkers threads
 	for (int t = 0; t < maxIndexWorkers; t++)
 		ctxs[t].thread = thread(
-			[this, &ctxs, &vdocsTexts, maxIndexWorkers, fieldscount, &cfg](int i) {
+			[this, &ctxs, &vdocsTexts, maxIndexWorkers, fieldscount, firstVdoc, &cfg](int i) {
 				auto ctx = &ctxs[i];
 				string word, str;
 				vector<const char *> wrds;
 				std::vector<string> virtualWords;
-				for (VDocIdType j = i; j < VDocIdType(vdocsTexts.size()); j += maxIndexWorkers) {
+				for (VDocIdType j = firstVdoc + i; j < VDocIdType(this->vdocs_.size()); j += maxIndexWorkers) {
+					auto &docTexts = vdocsTexts[j - firstVdoc];
+					this->vdocs_[j].wordsCount.clear();
 					this->vdocs_[j].wordsCount.insert(this->vdocs_[j].wordsCount.begin(), fieldscount, 0.0);
+					this->vdocs_[j].mostFreqWordCount.clear();
 					this->vdocs_[j].mostFreqWordCount.insert(this->vdocs_[j].mostFreqWordCount.begin(), fieldscount, 0.0);
 
-					for (size_t field = 0; field < vdocsTexts[j].size(); ++field) {
-						split(vdocsTexts[j][field].first, str, wrds, this->cfg_->extraWordSymbols);
-						int rfield = vdocsTexts[j][field].second;
+					for (size_t field = 0; field < docTexts.size(); ++field) {
+						split(docTexts[field].first, str, wrds, this->cfg_->extraWordSymbols);
+						int rfield = docTexts[field].second;
 						assert(rfield < fieldscount);
 
 						this->vdocs_[j].wordsCount[rfield] = wrds.size();
@@ -149,14 +179,17 @@ void FastIndexText<T>::buildWordsMap(fast_hash_map<string, WordEntry> &words_um)
 		avgWordsCount_.resize(fieldscount);
 		for (int i = 0; i < fieldscount; i++) avgWordsCount_[i] = 0;
 
+		size_t docsCount = 0;
 		for (auto &vdoc : this->vdocs_) {
+			if (!vdoc.keyEntry) continue;
 			for (int i = 0; i < fieldscount; i++) avgWordsCount_[i] += vdoc.wordsCount[i];
+			docsCount++;
 		}
-		for (int i = 0; i < fieldscount; i++) avgWordsCount_[i] /= this->vdocs_.size();
+		for (int i = 0; i < fieldscount; i++) avgWordsCount_[i] /= std::max(docsCount, size_t(1));
 	}
 
 	// Check and print potential stop words
-	if (GetConfig()->logLevel >= LogInfo) {
+	if (GetConfig()->logLevel >= LogInfo && !firstVdoc) {
 		string str;
 		for (auto &w : words_um) {
 			if (w.second.vids_.size() > this->vdocs_.size() / 5) str += w.first + " ";
@@ -185,8 +218,17 @@ void FastIndexText<T>::buildVirtualWord(const string &word, fast_hash_map<string
 
 template <typename T>
 void FastIndexText<T>::prepareVariants(FtSelectContext &ctx, FtDSLEntry &term, std::vector<string> &langs) {
-	ctx.variants.clear();
+	FtVariantsCacheKey key(term.pattern, (term.opts.pref ? 1 : 0) | (term.opts.suff ? 2 : 0) | (term.opts.exact ? 4 : 0) |
+											 (term.opts.number ? 8 : 0));
+	auto cached = variantsCache_->Get(key);
+	if (cached.val.variants) {
+		variantsCacheHits_++;
+		ctx.variants = cached.val.variants;
+		return;
+	}
+	variantsCacheMisses_++;
 
+	auto variants = std::make_shared<FtVariants>();
 	vector<pair<std::wstring, search_engine::ProcType>> variantsUtf16{{term.pattern, kFullMatchProc}};
 
 	if (!GetConfig()->enableNumbersSearch || !term.opts.number) {
@@ -203,7 +245,7 @@ void FastIndexText<T>::prepareVariants(FtSelectContext &ctx, FtDSLEntry &term, s
 	string tmpstr;
 	for (auto &v : variantsUtf16) {
 		utf16_to_utf8(v.first, tmpstr);
-		ctx.variants.push_back({tmpstr, term.opts, v.second});
+		variants->push_back({tmpstr, v.second, term.opts.pref, term.opts.suff});
 		if (!term.opts.exact) {
 			for (auto &lang : langs) {
 				auto stemIt = this->stemmers_.find(lang);
@@ -213,43 +255,41 @@ void FastIndexText<T>::prepareVariants(FtSelectContext &ctx, FtDSLEntry &term, s
 				char *stembuf = reinterpret_cast<char *>(alloca(1 + tmpstr.size() * 4));
 				stemIt->second.stem(stembuf, 1 + tmpstr.size() * 4, tmpstr.data(), tmpstr.length());
 				if (tmpstr != stembuf) {
-					FtDslOpts opts = term.opts;
-					opts.pref = true;
-
-					if (&v != &variantsUtf16[0]) opts.suff = false;
-
-					ctx.variants.push_back({stembuf, opts, v.second - kStemProcDecrease});
+					bool suff = (&v != &variantsUtf16[0]) ? false : term.opts.suff;
+					variants->push_back({stembuf, v.second - kStemProcDecrease, true, suff});
 				}
 			}
 		}
 	}
+	ctx.variants = variants;
+	if (cached.key) variantsCache_->Put(*cached.key, FtVariantsCacheVal{variants});
 }
 
 template <typename T>
-void FastIndexText<T>::processVariants(FtSelectContext &ctx) {
-	TextSearchResults &res = ctx.rawResults.back();
+void FastIndexText<T>::processVariants(FtSelectContext &ctx, WordsSegment &segment) {
+	TextSearchResults &res = *ctx.results;
 
-	for (const FtVariantEntry &variant : ctx.variants) {
-		if (variant.opts.op == OpAnd) {
+	for (const FtVariantEntry &variant : *ctx.variants) {
+		if (res.term.opts.op == OpAnd) {
 			ctx.foundWords.clear();
 		}
 		auto &tmpstr = variant.pattern;
 		//  Lookup current variant in suffixes array
-		auto keyIt = suffixes_.lower_bound(tmpstr);
+		auto keyIt = segment.suffixes.lower_bound(tmpstr);
 
 		int matched = 0, skipped = 0, vids = 0;
-		bool withPrefixes = (variant.opts.pref || variant.opts.suff);
-		bool withSuffixes = variant.opts.suff;
+		bool withPrefixes = (variant.pref || variant.suff);
+		bool withSuffixes = variant.suff;
 
 		// Walk current variant in suffixes array and fill results
 		do {
-			if (keyIt == suffixes_.end()) break;
+			if (keyIt == segment.suffixes.end()) break;
 
 			auto wordId = keyIt->second;
-			assert(wordId < WordIdType(words_.size()));
-			const string::value_type *word = suffixes_.word_at(wordId);
+			assert(wordId < WordIdType(segment.words.size()));
+			const string::value_type *word = segment.suffixes.word_at(wordId);
 
-			int16_t wordLength = suffixes_.word_len_at(wordId);
+			int16_t wordLength = segment.suffixes.word_len_at(wordId);
 
 			ptrdiff_t suffixLen = keyIt->first - word;
 			int matchLen = tmpstr.length();
@@ -261,19 +301,19 @@ void FastIndexText<T>::processVariants(FtSelectContext &ctx) {
 			int proc = std::max(variant.proc - matchDif * kPrefixStepProc / std::max(matchLen / 3, 1),
 								suffixLen ? kSuffixMinProc : kPrefixMinProc);
 
-			auto it = ctx.foundWords.find(wordId);
-			if (it == ctx.foundWords.end() || it->second.first != ctx.rawResults.size() - 1) {
-				res.push_back({&words_[wordId].vids_, keyIt->first, proc, suffixes_.virtual_word_len(wordId)});
-				res.idsCnt_ += words_[wordId].vids_.size();
-				ctx.foundWords[wordId] = std::make_pair(ctx.rawResults.size() - 1, res.size() - 1);
+			auto it = ctx.foundWords.find(&segment.words[wordId]);
+			if (it == ctx.foundWords.end()) {
+				res.push_back({&segment.words[wordId].vids_, keyIt->first, proc, segment.suffixes.virtual_word_len(wordId), word,
+							   int(segment.words[wordId].vids_.size())});
+				res.idsCnt_ += segment.words[wordId].vids_.size();
+				ctx.foundWords.emplace(&segment.words[wordId], res.size() - 1);
 				if (GetConfig()->logLevel >= LogTrace)
 					logPrintf(LogTrace, " matched %s '%s' of word '%s', %d vids, %d%%", suffixLen ? "suffix" : "prefix", keyIt->first, word,
-							  int(words_[wordId].vids_.size()), proc);
+							  int(segment.words[wordId].vids_.size()), proc);
 				matched++;
-				vids += words_[wordId].vids_.size();
+				vids += segment.words[wordId].vids_.size();
 			} else {
-				if (ctx.rawResults[it->second.first][it->second.second].proc_ < proc)
-					ctx.rawResults[it->second.first][it->second.second].proc_ = proc;
+				if (res[it->second].proc_ < proc) res[it->second].proc_ = proc;
 				skipped++;
 			}
 		} while ((keyIt++).lcp() >= int(tmpstr.length()));
@@ -284,34 +324,43 @@ void FastIndexText<T>::processVariants(FtSelectContext &ctx) {
 }
 
 template <typename T>
-void FastIndexText<T>::processTypos(FtSelectContext &ctx, FtDSLEntry &term) {
-	TextSearchResults &res = ctx.rawResults.back();
+void FastIndexText<T>::processTypos(FtSelectContext &ctx, FtDSLEntry &term, WordsSegment &segment) {
+	TextSearchResults &res = *ctx.results;
 
 	typos_context tctx[kMaxTyposInWord];
-	auto &typos = typos_;
+	auto &typos = segment.typos;
 	int matched = 0, skiped = 0, vids = 0;
+	wstring utf16Word, utf16Typo;
 	mktypos(tctx, term.pattern, GetConfig()->maxTyposInWord, GetConfig()->maxTypoLen, [&](const string &typo, int tcount) {
-		auto typoRng = typos.equal_range(typo);
+		auto typoRng = typos.Find(typo);
 		tcount = GetConfig()->maxTyposInWord - tcount;
+		if (typoRng.first != typoRng.second) utf8_to_utf16(typo, utf16Typo);
 		for (auto typoIt = typoRng.first; typoIt != typoRng.second; typoIt++) {
-			auto wordId = typoIt->second;
-			assert(wordId < WordIdType(words_.size()));
-			// bool virtualWord = suffixes_.is_word_virtual(wordId);
-			uint8_t wordLength = suffixes_.word_len_at(wordId);
-			int proc = kTypoProc - tcount * kTypoStepProc / std::max((wordLength - tcount) / 3, 1);
-			auto it = ctx.foundWords.find(wordId);
-			if (it == ctx.foundWords.end()) {
-				res.push_back({&words_[wordId].vids_, typoIt->first, proc, suffixes_.virtual_word_len(wordId)});
-				res.idsCnt_ += words_[wordId].vids_.size();
-				ctx.foundWords.emplace(wordId, std::make_pair(ctx.rawResults.size() - 1, res.size() - 1));
-
-				if (GetConfig()->logLevel >= LogTrace)
-					logPrintf(LogTrace, " matched typo '%s' of word '%s', %d ids, %d%%", typoIt->first, suffixes_.word_at(wordId),
-							  int(words_[wordId].vids_.size()), proc);
-				++matched;
-				vids += words_[wordId].vids_.size();
-			} else
+			auto wordId = typoIt->wordId;
+			assert(wordId < WordIdType(segment.words.size()));
+			auto it = ctx.foundWords.find(&segment.words[wordId]);
+			if (it != ctx.foundWords.end()) {
 				++skiped;
+				continue;
+			}
+			// Map stores only signatures of typos, so candidate word has to be checked
+			const char *word = segment.suffixes.word_at(wordId);
+			utf8_to_utf16(word, utf16Word);
+			if (!istypo(utf16Word, utf16Typo, GetConfig()->maxTyposInWord, GetConfig()->maxTypoLen)) continue;
+
+			// bool virtualWord = segment.suffixes.is_word_virtual(wordId);
+			uint8_t wordLength = segment.suffixes.word_len_at(wordId);
+			int proc = kTypoProc - tcount * kTypoStepProc / std::max((wordLength - tcount) / 3, 1);
+			res.push_back({&segment.words[wordId].vids_, word, proc, segment.suffixes.virtual_word_len(wordId), word,
+						   int(segment.words[wordId].vids_.size())});
+			res.idsCnt_ += segment.words[wordId].vids_.size();
+			ctx.foundWords.emplace(&segment.words[wordId], res.size() - 1);
+
+			if (GetConfig()->logLevel >= LogTrace)
+				logPrintf(LogTrace, " matched typo '%s' of word '%s', %d ids, %d%%", typo.c_str(), word, int(segment.words[wordId].vids_.size()),
+						  proc);
+			++matched;
+			vids += segment.words[wordId].vids_.size();
 		}
 	});
 	if (GetConfig()->logLevel >= LogInfo)
@@ -320,6 +369,86 @@ void FastIndexText<T>::processTypos(FtSelectContext &ctx, FtDSLEntry &term) {
 
 double bound(double k, double weight, double boost) { return (1.0 - weight) + k * boost * weight; }
 
+// Parameters of rank of matches of one word of term
+struct RankParams {
+	double idf;
+	double bm25Weight;
+	double bm25Boost;
+	double termBoost;
+	double termLenBoost;
+};
+
+// Rank of match of term in document: bm25, normalized by config, with boosts of field, matched word proc and term.
+// fboostProc is product of field boost and word proc. Batch kernel repeats exactly the same operations, so ranks are equal
+static inline double termRank(const RankParams &p, double termCount, double wordsInDoc, double avgDocLen, double fboostProc,
+							  double &normBm25) {
+	// Count of the most frequent word of document is not used by TF
+	double bm25 = p.idf * bm25score(termCount, 0, wordsInDoc, avgDocLen);
+	normBm25 = bound(bm25, p.bm25Weight, p.bm25Boost);
+	return fboostProc * normBm25 * p.termBoost * p.termLenBoost;
+}
+
+// Candidate matches of word in documents, which are ranked together. Arrays are addressable by candidate number
+struct RankBatch {
+	static const int kSize = 64;
+	VDocIdType vids[kSize];
+	// Rank of posting list entry, which admits document to merge
+	int ranks[kSize];
+	double termCount[kSize];
+	double wordsInDoc[kSize];
+	double avgDocLen[kSize];
+	double fboostProc[kSize];
+	double normBm25[kSize];
+	double termRank[kSize];
+	IdRelType relids[kSize];
+};
+
+// Evaluate ranks of batch candidates. Loop is branchless, pairs of candidates are ranked by SSE2 instructions
+static void rankBatch(RankBatch &b, int count, const RankParams &p) {
+	int i = 0;
+#if defined(__SSE2__)
+	const __m128d k1 = _mm_set1_pd(kKeofBm25k1), k1Inc = _mm_set1_pd(kKeofBm25k1 + 1.0);
+	const __m128d bm25b = _mm_set1_pd(kKeofBm25b), bm25bDec = _mm_set1_pd(1.0 - kKeofBm25b);
+	const __m128d idf = _mm_set1_pd(p.idf), weight = _mm_set1_pd(p.bm25Weight), weightDec = _mm_set1_pd(1.0 - p.bm25Weight);
+	const __m128d boost = _mm_set1_pd(p.bm25Boost), termBoost = _mm_set1_pd(p.termBoost), termLenBoost = _mm_set1_pd(p.termLenBoost);
+	for (; i + 2 <= count; i += 2) {
+		__m128d tf = _mm_loadu_pd(b.termCount + i);
+		// bm25score: tf * (k1 + 1) / (tf + k1 * (1 - b + b * wordsInDoc / avgDocLen))
+		__m128d lenNorm = _mm_add_pd(bm25bDec, _mm_div_pd(_mm_mul_pd(bm25b, _mm_loadu_pd(b.wordsInDoc + i)), _mm_loadu_pd(b.avgDocLen + i)));
+		__m128d score = _mm_div_pd(_mm_mul_pd(tf, k1Inc), _mm_add_pd(tf, _mm_mul_pd(k1, lenNorm)));
+		// bound: (1 - weight) + bm25 * boost * weight
+		__m128d normBm25 = _mm_add_pd(weightDec, _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(idf, score), boost), weight));
+		__m128d rank = _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(_mm_loadu_pd(b.fboostProc + i), normBm25), termBoost), termLenBoost);
+		_mm_storeu_pd(b.normBm25 + i, normBm25);
+		_mm_storeu_pd(b.termRank + i, rank);
+	}
+#endif
+	for (; i < count; i++) {
+		b.termRank[i] = termRank(p, b.termCount[i], b.wordsInDoc[i], b.avgDocLen[i], b.fboostProc[i], b.normBm25[i]);
+	}
+}
+
+// Minimum rank of posting list entries from vids range, which fit to capacity, if entries are taken in order of rank.
+// ties - number of entries with minimum rank, which fit to capacity after all entries with greater rank.
+// Ranks are counted from ranks stream, blocks out of vids range are skipped
+static int admissionRank(const PackedIdRelSet &vids, VDocIdType firstVdoc, VDocIdType lastVdoc, int capacity, int &ties) {
+	ties = capacity;
+	if (int(vids.size()) <= capacity) return 0;
+
+	int hist[256] = {0};
+	auto &blocks = vids.Blocks();
+	for (size_t b = 0; b < blocks.size(); b++) {
+		if (blocks[b].lastId < firstVdoc || blocks[b].firstId >= lastVdoc) continue;
+		const uint8_t *ranks = vids.Ranks().data() + b * PackedIdRelSet::kBlockSize;
+		for (int i = 0; i < blocks[b].count; i++) hist[ranks[i]]++;
+	}
+
+	int rank = 256, count = 0;
+	while (rank > 0 && count < capacity) count += hist[--rank];
+	ties = capacity - (count - hist[rank]);
+	return rank;
+}
+
 template <typename T>
 void FastIndexText<T>::debugMergeStep(const char *msg, int vid, float normBm25, float normDist, int finalRank, int prevRank) {
 #ifdef REINDEX_FT_EXTRA_DEBUG
@@ -347,143 +476,405 @@ void FastIndexText<T>::debugMergeStep(const char *msg, int vid, float normBm25,
 
 template <typename T>
 void FastIndexText<T>::mergeItaration(TextSearchResults &rawRes, vector<bool> &exists, vector<MergeInfo> &merged,
-									  vector<MergedIdRel> &merged_rd, h_vector<int16_t> &idoffsets, bool need_area) {
+									  vector<MergedIdRel> &merged_rd, h_vector<int> &idoffsets, bool need_area, VDocIdType firstVdoc,
+									  VDocIdType lastVdoc, int mergeLimit) {
 	int totalDocsCount = this->vdocs_.size();
 	bool simple = idoffsets.size() == 0;
 	auto op = rawRes.term.opts.op;
 
-	vector<bool> curExists(simple ? 0 : totalDocsCount, false);
+	// exists, curExists and idoffsets are addressable by vid - firstVdoc
+	vector<bool> curExists(simple ? 0 : lastVdoc - firstVdoc, false);
 
 	for (auto &m_rd : merged_rd) {
 		if (m_rd.next.pos.size()) m_rd.cur = std::move(m_rd.next);
 	}
 
+	auto termLenBoost = bound(rawRes.term.opts.boost, GetConfig()->termLenWeight, GetConfig()->termLenBoost);
+	std::unique_ptr<RankBatch> batch(new RankBatch);
+
 	for (auto &r : rawRes) {
-		auto idf = IDF(totalDocsCount, r.vids_->size());
-		auto termLenBoost = bound(rawRes.term.opts.boost, GetConfig()->termLenWeight, GetConfig()->termLenBoost);
+		RankParams params{IDF(totalDocsCount, r.docsCount_), GetConfig()->bm25Weight, GetConfig()->bm25Boost, rawRes.term.opts.boost,
+						  termLenBoost};
 		if (GetConfig()->logLevel >= LogTrace) {
-			logPrintf(LogTrace, "Pattern %s, idf %f, termLenBoost %f", r.pattern, idf, termLenBoost);
+			logPrintf(LogTrace, "Pattern %s, idf %f, termLenBoost %f", r.pattern, params.idf, termLenBoost);
 		}
 
-		for (auto &relid : *r.vids_) {
-			int vid = relid.id;
+		// Nothing to do with single term, when merge limit is reached
+		if (simple && int(merged.size()) >= mergeLimit) break;
+
+		// Posting lists are ordered by vids, so documents with rank less than minRank are not added to merged,
+		// to add documents with the best ranks before merge limit is reached. Documents with minRank take only capacity,
+		// which is left by documents with greater rank
+		int ties = 0;
+		int minRank = (op == OpOr) ? admissionRank(*r.vids_, firstVdoc, lastVdoc, mergeLimit - int(merged.size()), ties) : 0;
+
+		auto vidsIt = r.vids_->begin(), vidsEnd = r.vids_->end();
+		// Skip blocks of documents before processed partition
+		vidsIt.SkipTo(firstVdoc);
+		bool done = false;
+		while (!done) {
+			// Collect batch of candidates, then rank them at once and merge in order of vids
+			int count = 0;
+			for (; count < RankBatch::kSize; ++vidsIt) {
+				if (vidsIt == vidsEnd) {
+					done = true;
+					break;
+				}
+				int vid = vidsIt.Id();
+				// Document is out of processed partition
+				if (vid >= lastVdoc) {
+					done = true;
+					break;
+				}
+				int pvid = vid - firstVdoc;
 
-			// Do not calc anithing if
-			if (op == OpAnd && !exists[vid]) {
-				continue;
+				// Do not calc anithing if
+				if (op == OpAnd && !exists[pvid]) {
+					continue;
+				}
+				// Document was deleted after segment build
+				if (!this->vdocs_[vid].keyEntry) continue;
+
+				assert(pvid < int(exists.size()));
+
+				auto &relid = *vidsIt;
+
+				int field = relid.pos[0].field();
+				assert(field < int(this->vdocs_[vid].wordsCount.size()));
+				assert(field < int(rawRes.term.opts.fieldsBoost.size()));
+
+				auto fboost = rawRes.term.opts.fieldsBoost[field];
+				if (!fboost) {
+					// TODO: search another fields
+					continue;
+				};
+
+				batch->vids[count] = vid;
+				batch->ranks[count] = vidsIt.Rank();
+				batch->termCount[count] = relid.wordsInField(field);
+				batch->wordsInDoc[count] = this->vdocs_[vid].wordsCount[field];
+				batch->avgDocLen[count] = avgWordsCount_[field];
+				batch->fboostProc[count] = fboost * r.proc_;
+				batch->relids[count] = std::move(relid);
+				count++;
 			}
 
-			assert(vid < int(exists.size()));
-
-			int field = relid.pos[0].field();
-			assert(field < int(this->vdocs_[vid].wordsCount.size()));
-			assert(field < int(rawRes.term.opts.fieldsBoost.size()));
+			rankBatch(*batch, count, params);
+
+			for (int i = 0; i < count; i++) {
+				int vid = batch->vids[i];
+				int pvid = vid - firstVdoc;
+				auto &relid = batch->relids[i];
+				double normBm25 = batch->normBm25[i];
+				double termRank = batch->termRank[i];
+				if (!simple) {
+					auto moffset = idoffsets[pvid];
+					if (exists[pvid]) {
+						assert(relid.pos.size());
+						assert(merged_rd[moffset].cur.pos.size());
+
+						// match of 2-rd, and next terms
+						if (op == OpNot) {
+							merged[moffset].proc = 0;
+							exists[pvid] = false;
+						} else {
+							// Calculate words distance
+							int distance = 0;
+							float normDist = 1;
 
-			auto fboost = rawRes.term.opts.fieldsBoost[field];
-			if (!fboost) {
-				// TODO: search another fields
-				continue;
-			};
-
-			// raw bm25
-			auto bm25 = idf * bm25score(relid.wordsInField(field), this->vdocs_[vid].mostFreqWordCount[field],
-										this->vdocs_[vid].wordsCount[field], avgWordsCount_[field]);
-
-			// normalized bm25
-			auto normBm25 = bound(bm25, GetConfig()->bm25Weight, GetConfig()->bm25Boost);
-
-			// final term rank calculation
-			double termRank = fboost * r.proc_ * normBm25 * rawRes.term.opts.boost * termLenBoost;
-
-			if (!simple) {
-				auto moffset = idoffsets[vid];
-				if (exists[vid]) {
-					assert(relid.pos.size());
-					assert(merged_rd[moffset].cur.pos.size());
-
-					// match of 2-rd, and next terms
-					if (op == OpNot) {
-						merged[moffset].proc = 0;
-						exists[vid] = false;
-					} else {
-						// Calculate words distance
-						int distance = 0;
-						float normDist = 1;
-
-						if (merged_rd[moffset].qpos != rawRes.term.opts.qpos) {
-							distance = merged_rd[moffset].cur.distance(relid, INT_MAX);
-
-							// Normaized distance
-							normDist = bound(1.0 / double(std::max(distance, 1)), GetConfig()->distanceWeight, GetConfig()->distanceBoost);
-						}
-						int finalRank = normDist * termRank;
+							if (merged_rd[moffset].qpos != rawRes.term.opts.qpos) {
+								distance = merged_rd[moffset].cur.distance(relid, INT_MAX);
 
-						if (distance <= rawRes.term.opts.distance && (!curExists[vid] || finalRank > merged_rd[moffset].rank)) {
-							// distance and rank is better, than prev. update rank
-							if (curExists[vid]) {
-								merged[moffset].proc -= merged_rd[moffset].rank;
-								debugMergeStep("merged better score ", vid, normBm25, normDist, finalRank, merged_rd[moffset].rank);
-							} else {
-								debugMergeStep("merged new ", vid, normBm25, normDist, finalRank, merged_rd[moffset].rank);
+								// Normaized distance
+								normDist = bound(1.0 / double(std::max(distance, 1)), GetConfig()->distanceWeight, GetConfig()->distanceBoost);
 							}
-							merged[moffset].proc += finalRank;
-							if (need_area) {
-								for (auto pos : relid.pos) {
-									if (!merged[moffset].holder->AddWord(pos.pos(), r.wordLen_, pos.field())) {
-										break;
+							int finalRank = normDist * termRank;
+
+							// Terms of phrase must be near to positions of previous term. Other positions are not used by next terms
+							bool near = rawRes.term.opts.distance == INT_MAX ||
+										relid.intersect(merged_rd[moffset].cur, rawRes.term.opts.distance, rawRes.term.opts.phrase);
+
+							if (near && (!curExists[pvid] || finalRank > merged_rd[moffset].rank)) {
+								// distance and rank is better, than prev. update rank
+								if (curExists[pvid]) {
+									merged[moffset].proc -= merged_rd[moffset].rank;
+									debugMergeStep("merged better score ", vid, normBm25, normDist, finalRank, merged_rd[moffset].rank);
+								} else {
+									debugMergeStep("merged new ", vid, normBm25, normDist, finalRank, merged_rd[moffset].rank);
+								}
+								merged[moffset].proc += finalRank;
+								if (need_area) {
+									for (auto pos : relid.pos) {
+										if (!merged[moffset].holder->AddWord(pos.pos(), r.wordLen_, pos.field())) {
+											break;
+										}
 									}
 								}
+								merged_rd[moffset].rank = finalRank;
+								merged_rd[moffset].next = std::move(relid);
+								curExists[pvid] = true;
+							} else {
+								debugMergeStep("skiped ", vid, normBm25, normDist, finalRank, merged_rd[moffset].rank);
 							}
-							merged_rd[moffset].rank = finalRank;
-							merged_rd[moffset].next = std::move(relid);
-							curExists[vid] = true;
-						} else {
-							debugMergeStep("skiped ", vid, normBm25, normDist, finalRank, merged_rd[moffset].rank);
 						}
 					}
 				}
-			}
-			if (int(merged.size()) < GetConfig()->mergeLimit && op == OpOr && !exists[vid]) {
-				// match of 1-st term
-				MergeInfo info;
-				info.id = vid;
-				info.proc = termRank;
-				if (need_area) {
-					info.holder.reset(new AreaHolder);
-					info.holder->ReserveField(this->fields_.size());
-					for (auto pos : relid.pos) {
-						info.holder->AddWord(pos.pos(), r.wordLen_, pos.field());
+				int rank = batch->ranks[i];
+				if (int(merged.size()) < mergeLimit && op == OpOr && !exists[pvid] && (rank > minRank || (rank == minRank && ties > 0))) {
+					// match of 1-st term
+					if (rank == minRank) ties--;
+					MergeInfo info;
+					info.id = vid;
+					info.proc = termRank;
+					if (need_area) {
+						info.holder.reset(new AreaHolder);
+						info.holder->ReserveField(this->fields_.size());
+						for (auto pos : relid.pos) {
+							info.holder->AddWord(pos.pos(), r.wordLen_, pos.field());
+						}
 					}
+					merged.push_back(std::move(info));
+					exists[pvid] = true;
+					if (simple) continue;
+					// prepare for intersect with next terms
+					merged_rd.push_back({IdRelType(std::move(relid)), IdRelType(), int(termRank), rawRes.term.opts.qpos});
+					curExists[pvid] = true;
+					idoffsets[pvid] = merged.size() - 1;
 				}
-				merged.push_back(std::move(info));
-				exists[vid] = true;
-				if (simple) continue;
-				// prepare for intersect with next terms
-				merged_rd.push_back({IdRelType(std::move(relid)), IdRelType(), int(termRank), rawRes.term.opts.qpos});
-				curExists[vid] = true;
-				idoffsets[vid] = merged.size() - 1;
 			}
 		}
 	}
 	if (op == OpAnd) {
 		for (auto &info : merged) {
-			auto vid = info.id;
-			if (exists[vid] && !curExists[vid]) {
+			auto pvid = info.id - firstVdoc;
+			if (exists[pvid] && !curExists[pvid]) {
 				info.proc = 0;
-				exists[vid] = false;
+				exists[pvid] = false;
 			}
 		}
 	}
 }  // namespace reindexer
 
+template <typename T>
+void FastIndexText<T>::mergePartition(vector<TextSearchResults> &rawResults, vector<MergeInfo> &merged, int idsMaxCnt, bool need_area,
+									  VDocIdType firstVdoc, VDocIdType lastVdoc, int mergeLimit) {
+	vector<bool> exists(lastVdoc - firstVdoc, false);
+	vector<MergedIdRel> merged_rd;
+	h_vector<int> idoffsets;
+
+	merged.reserve(std::min(mergeLimit, idsMaxCnt));
+
+	if (rawResults.size() > 1) {
+		idoffsets.resize(lastVdoc - firstVdoc);
+		merged_rd.reserve(std::min(mergeLimit, idsMaxCnt));
+	}
+	for (auto &rawRes : rawResults) {
+		mergeItaration(rawRes, exists, merged, merged_rd, idoffsets, need_area, firstVdoc, lastVdoc, mergeLimit);
+	}
+}
+
+// Upper bound of bm25score of word, which occurs in document not more than maxTf times (0 - unknown count)
+static double bm25UpperBound(int maxTf) {
+	// bm25score grows with count of word in document and decreases with count of words in document
+	if (!maxTf) return kKeofBm25k1 + 1.0;
+	return maxTf * (kKeofBm25k1 + 1.0) / (maxTf + kKeofBm25k1 * (1.0 - kKeofBm25b));
+}
+
+template <typename T>
+int FastIndexText<T>::mergeDocument(VDocIdType vid, const vector<DocMatch> &matches, bool simple, AreaHolder *holder) {
+	// Same rank calculation as mergeItaration does for document, when all the terms are OR'ed
+	auto &vdoc = this->vdocs_[vid];
+	auto cfg = GetConfig();
+	bool exists = false, curExists = false;
+	int proc = 0, rdRank = 0, rdQpos = 0;
+	const IdRelType *rdCur = nullptr, *rdNext = nullptr;
+	const TextSearchResults *curTerm = nullptr;
+
+	for (auto &m : matches) {
+		auto &opts = m.term->term.opts;
+		if (m.term != curTerm) {
+			if (rdNext) rdCur = rdNext;
+			rdNext = nullptr;
+			curExists = false;
+			curTerm = m.term;
+		}
+		const IdRelType &relid = *m.relid;
+		int field = relid.pos[0].field();
+		auto fboost = opts.fieldsBoost[field];
+		if (!fboost) continue;
+
+		RankParams params{m.idf, cfg->bm25Weight, cfg->bm25Boost, opts.boost, bound(opts.boost, cfg->termLenWeight, cfg->termLenBoost)};
+		double normBm25;
+		double termRank = reindexer::termRank(params, const_cast<IdRelType &>(relid).wordsInField(field), vdoc.wordsCount[field],
+											  avgWordsCount_[field], fboost * m.word->proc_, normBm25);
+
+		if (!simple && exists) {
+			int distance = 0;
+			float normDist = 1;
+			if (rdQpos != opts.qpos) {
+				distance = rdCur->distance(relid, INT_MAX);
+				normDist = bound(1.0 / double(std::max(distance, 1)), cfg->distanceWeight, cfg->distanceBoost);
+			}
+			int finalRank = normDist * termRank;
+			if (distance <= opts.distance && (!curExists || finalRank > rdRank)) {
+				if (curExists) proc -= rdRank;
+				proc += finalRank;
+				if (holder) {
+					for (auto pos : relid.pos) {
+						if (!holder->AddWord(pos.pos(), m.word->wordLen_, pos.field())) break;
+					}
+				}
+				rdRank = finalRank;
+				rdNext = &relid;
+				curExists = true;
+			}
+		}
+		if (!exists) {
+			proc = termRank;
+			exists = true;
+			if (holder) {
+				for (auto pos : relid.pos) holder->AddWord(pos.pos(), m.word->wordLen_, pos.field());
+			}
+			if (simple) continue;
+			rdCur = &relid;
+			rdNext = nullptr;
+			rdRank = termRank;
+			rdQpos = opts.qpos;
+			curExists = true;
+		}
+	}
+	return proc;
+}
+
+template <typename T>
+void FastIndexText<T>::mergeTopK(vector<TextSearchResults> &rawResults, size_t maxResults, bool need_area, vector<MergeInfo> &merged) {
+	// WAND with block-max check: posting lists are walked together in order of vids. Document is fully evaluated only if sum of
+	// upper bounds of its words ranks is greater than rank of the worst of current top documents
+	struct Cursor {
+		Cursor(const TextSearchResults &t, const TextSearchResult &w) : term(&t), word(&w), it(w.vids_->begin()), end(w.vids_->end()) {}
+		const TextSearchResults *term;
+		const TextSearchResult *word;
+		PackedIdRelSet::iterator it, end;
+		double idf = 0;
+		// Part of word rank, which does not depend on document
+		double rankMul = 0;
+		// Upper bound of word rank in all documents
+		double maxRank = 0;
+	};
+
+	auto cfg = GetConfig();
+	int totalDocsCount = this->vdocs_.size();
+	bool simple = rawResults.size() == 1;
+	// Distance between terms may increase rank of term
+	double distanceMul = std::max(1.0, bound(1.0, cfg->distanceWeight, cfg->distanceBoost));
+	auto wordRankBound = [cfg](const Cursor &c, int maxTf) {
+		return c.rankMul * bound(c.idf * bm25UpperBound(maxTf == PackedIdRelSet::kMaxTfUnknown ? 0 : maxTf), cfg->bm25Weight,
+								 cfg->bm25Boost);
+	};
+
+	vector<Cursor> cursors;
+	for (auto &rawRes : rawResults) {
+		auto &opts = rawRes.term.opts;
+		double maxFieldBoost = 0;
+		for (auto fboost : opts.fieldsBoost) maxFieldBoost = std::max(maxFieldBoost, double(fboost));
+		double termLenBoost = bound(opts.boost, cfg->termLenWeight, cfg->termLenBoost);
+		for (auto &r : rawRes) {
+			if (r.vids_->empty()) continue;
+			cursors.emplace_back(rawRes, r);
+			auto &c = cursors.back();
+			c.idf = IDF(totalDocsCount, r.docsCount_);
+			c.rankMul = maxFieldBoost * r.proc_ * opts.boost * termLenBoost * distanceMul;
+			for (auto &block : r.vids_->Blocks()) c.maxRank = std::max(c.maxRank, wordRankBound(c, block.maxTf));
+		}
+	}
+
+	// Upper bound of word rank in block, which may contain vid
+	auto blockRankBound = [&wordRankBound](const Cursor &c, VDocIdType vid) {
+		auto &blocks = c.word->vids_->Blocks();
+		auto block = std::lower_bound(blocks.begin(), blocks.end(), vid,
+									  [](const PackedIdRelSet::Block &b, VDocIdType id) { return b.lastId < id; });
+		return (block == blocks.end() || block->firstId > vid) ? 0.0 : wordRankBound(c, block->maxTf);
+	};
+
+	// Heap of current top documents. The worst of them is on the top of heap
+	auto better = [](const MergeInfo &lhs, const MergeInfo &rhs) { return lhs.proc > rhs.proc || (lhs.proc == rhs.proc && lhs.id < rhs.id); };
+	merged.reserve(maxResults + 1);
+	int minRelevancy = cfg->minRelevancy * 100;
+
+	vector<Cursor *> order;
+	for (auto &c : cursors) order.push_back(&c);
+	vector<DocMatch> matches;
+	int evaluated = 0;
+
+	while (!order.empty()) {
+		std::sort(order.begin(), order.end(), [](const Cursor *lhs, const Cursor *rhs) { return lhs->it.Id() < rhs->it.Id(); });
+		// Document have to be better than the worst top document. Equal rank is not enough, since vids are increasing
+		double threshold = merged.size() < maxResults ? minRelevancy : merged.front().proc;
+
+		// Find pivot: the first document, which may have rank above threshold
+		double rankSum = 0;
+		size_t pivotIdx = 0;
+		for (; pivotIdx < order.size(); pivotIdx++) {
+			rankSum += order[pivotIdx]->maxRank;
+			if (rankSum > threshold) break;
+		}
+		if (pivotIdx == order.size()) break;
+		VDocIdType pivot = order[pivotIdx]->it.Id();
+		size_t lastIdx = pivotIdx;
+		while (lastIdx + 1 < order.size() && order[lastIdx + 1]->it.Id() == pivot) lastIdx++;
+
+		double blockRankSum = 0;
+		for (size_t i = 0; i <= lastIdx; i++) blockRankSum += blockRankBound(*order[i], pivot);
+
+		if (blockRankSum <= threshold) {
+			// Neither pivot, nor documents before it can get to top by blocks bounds
+			for (size_t i = 0; i <= lastIdx; i++) order[i]->it.SkipTo(pivot + 1);
+		} else if (order[0]->it.Id() == pivot) {
+			// Evaluate pivot document. Matches are processed in order of terms and words, as in mergeItaration
+			matches.clear();
+			for (size_t i = 0; i <= lastIdx; i++) matches.push_back({order[i]->term, order[i]->word, order[i]->idf, &*order[i]->it});
+			std::sort(matches.begin(), matches.end(), [](const DocMatch &lhs, const DocMatch &rhs) {
+				return lhs.term < rhs.term || (lhs.term == rhs.term && lhs.word < rhs.word);
+			});
+
+			if (this->vdocs_[pivot].keyEntry) {
+				evaluated++;
+				int proc = mergeDocument(pivot, matches, simple, nullptr);
+				if (proc > threshold) {
+					MergeInfo info;
+					info.id = pivot;
+					info.proc = proc;
+					if (need_area) {
+						info.holder.reset(new AreaHolder);
+						info.holder->ReserveField(this->fields_.size());
+						mergeDocument(pivot, matches, simple, info.holder.get());
+					}
+					merged.push_back(std::move(info));
+					std::push_heap(merged.begin(), merged.end(), better);
+					if (merged.size() > maxResults) {
+						std::pop_heap(merged.begin(), merged.end(), better);
+						merged.pop_back();
+					}
+				}
+			}
+			for (size_t i = 0; i <= lastIdx; i++) ++order[i]->it;
+		} else {
+			// Move cursors to pivot
+			for (size_t i = 0; i < pivotIdx && order[i]->it.Id() < pivot; i++) order[i]->it.SkipTo(pivot);
+		}
+		order.erase(std::remove_if(order.begin(), order.end(), [](const Cursor *c) { return c->it == c->end; }), order.end());
+	}
+
+	if (cfg->logLevel >= LogInfo)
+		logPrintf(LogInfo, "Top-K merge (%d patterns, %d words): evaluated %d vids, out %d vids", int(rawResults.size()), int(cursors.size()),
+				  evaluated, int(merged.size()));
+}
+
 template <typename T>
 IdSet::Ptr FastIndexText<T>::mergeResults(vector<TextSearchResults> &rawResults, FtCtx::Ptr ctx) {
 	if (!rawResults.size() || !this->vdocs_.size()) return std::make_shared<IdSet>();
 
-	vector<bool> exists(this->vdocs_.size(), false);
 	vector<MergeInfo> merged;
-	vector<MergedIdRel> merged_rd;
-	h_vector<int16_t> idoffsets;
 
 	int mergeCnt = 0, idsMaxCnt = 0;
 	for (auto &rawRes : rawResults) {
@@ -491,23 +882,50 @@ IdSet::Ptr FastIndexText<T>::mergeResults(vector<TextSearchResults> &rawResults,
 				  [](const TextSearchResult &lhs, const TextSearchResult &rhs) { return lhs.proc_ > rhs.proc_; });
 		if (rawRes.term.opts.op == OpOr || !idsMaxCnt) idsMaxCnt += rawRes.idsCnt_;
 	}
-
-	merged.reserve(std::min(GetConfig()->mergeLimit, idsMaxCnt));
-
-	if (rawResults.size() > 1) {
-		idoffsets.resize(this->vdocs_.size());
-		merged_rd.reserve(std::min(GetConfig()->mergeLimit, idsMaxCnt));
-	}
 	rawResults[0].term.opts.op = OpOr;
 	for (auto &rawRes : rawResults) {
-		mergeItaration(rawRes, exists, merged, merged_rd, idoffsets, ctx->NeedArea());
-
 		if (rawRes.term.opts.op != OpNot) mergeCnt++;
 	}
+
+	bool onlyOr = std::all_of(rawResults.begin(), rawResults.end(), [](const TextSearchResults &r) { return r.term.opts.op == OpOr; });
+
+	int totalDocsCount = this->vdocs_.size();
+	int partitions = std::min(selectThreadsCount(), totalDocsCount / kMinMergePartitionSize);
+	if (ctx->MaxResults() && onlyOr && ctx->MaxResults() < size_t(idsMaxCnt)) {
+		// Only the best documents are needed, so other documents are pruned by upper bounds of their ranks
+		mergeTopK(rawResults, ctx->MaxResults(), ctx->NeedArea(), merged);
+	} else if (GetConfig()->parallelMergeThreshold && idsMaxCnt >= GetConfig()->parallelMergeThreshold && partitions > 1) {
+		// Documents ranks are independent, so merge is partitioned by ranges of vids. Each partition is merged in own thread.
+		// Partitions are not limited: documents, which are admitted before limit is reached, depend on partitioning
+		vector<vector<MergeInfo>> mergedParts(partitions);
+		vector<thread> workers;
+		for (int p = 0; p < partitions; p++) {
+			VDocIdType firstVdoc = VDocIdType(int64_t(totalDocsCount) * p / partitions);
+			VDocIdType lastVdoc = VDocIdType(int64_t(totalDocsCount) * (p + 1) / partitions);
+			workers.emplace_back([this, &rawResults, &mergedParts, p, idsMaxCnt, ctx, firstVdoc, lastVdoc]() {
+				mergePartition(rawResults, mergedParts[p], idsMaxCnt, ctx->NeedArea(), firstVdoc, lastVdoc, INT_MAX);
+			});
+		}
+		for (auto &worker : workers) worker.join();
+
+		size_t mergedCnt = 0;
+		for (auto &part : mergedParts) mergedCnt += part.size();
+		merged.reserve(mergedCnt);
+		for (auto &part : mergedParts) std::move(part.begin(), part.end(), std::back_inserter(merged));
+	} else if (GetConfig()->parallelMergeThreshold && idsMaxCnt >= GetConfig()->parallelMergeThreshold) {
+		// Single thread is available, but result must be the same, as result of parallel merge
+		mergePartition(rawResults, merged, idsMaxCnt, ctx->NeedArea(), 0, totalDocsCount, INT_MAX);
+	} else {
+		mergePartition(rawResults, merged, idsMaxCnt, ctx->NeedArea(), 0, totalDocsCount, GetConfig()->mergeLimit);
+	}
 	if (GetConfig()->logLevel >= LogInfo)
 		logPrintf(LogInfo, "Complex merge (%d patterns): out %d vids", int(rawResults.size()), int(merged.size()));
 
-	std::sort(merged.begin(), merged.end(), [](const MergeInfo &lhs, const MergeInfo &rhs) { return lhs.proc > rhs.proc; });
+	// Equal ranks are ordered by vid, so result does not depend on partitioning
+	std::sort(merged.begin(), merged.end(),
+			  [](const MergeInfo &lhs, const MergeInfo &rhs) { return lhs.proc > rhs.proc || (lhs.proc == rhs.proc && lhs.id < rhs.id); });
+	// Merge limit of parallel merge is applied to merged partitions, so only the best documents are kept
+	if (int(merged.size()) > GetConfig()->mergeLimit) merged.erase(merged.begin() + GetConfig()->mergeLimit, merged.end());
 
 	// convert vids(uniq documents id) to ids (real ids)
 	IdSet::Ptr mergedIds = std::make_shared<IdSet>();
@@ -560,66 +978,108 @@ Index *FastIndexText<T>::Clone() {
 template <typename T>
 IndexMemStat FastIndexText<T>::GetMemStat() {
 	auto ret = IndexUnordered<T>::GetMemStat();
-	ret.fulltextSize = typos_.heap_size() + suffixes_.heap_size();
-
-	for (auto &w : words_) {
-		ret.fulltextSize += sizeof(w) + w.vids_.heap_size();
-	}
+	ret.fulltextSize = 0;
+	ret.typosSize = 0;
+	auto addSegment = [&ret](WordsSegment &segment) {
+		ret.fulltextSize += segment.suffixes.heap_size();
+		ret.typosSize += segment.typos.heap_size();
+		for (auto &w : segment.words) {
+			ret.fulltextSize += sizeof(w) + w.vids_.heap_size();
+		}
+	};
+	addSegment(main_);
+	for (auto &delta : deltas_) addSegment(*delta);
 	ret.fulltextSize += this->vdocs_.capacity() * sizeof(typename IndexText<T>::VDocEntry);
+	ret.fulltextSize += this->vdocsIds_.size() * sizeof(typename decltype(this->vdocsIds_)::value_type);
 	if (this->cache_ft_) ret.idsetCache = this->cache_ft_->GetMemStat();
+	ret.variantsCache = variantsCache_->GetMemStat();
+	ret.variantsCache.hitsCount = variantsCacheHits_;
+	ret.variantsCache.missesCount = variantsCacheMisses_;
 
 	return ret;
 }
 
 template <typename T>
 void FastIndexText<T>::Commit() {
-	words_.clear();
-	suffixes_.clear();
-	typos_.clear();
+	size_t vdocsCount = this->vdocs_.size();
+	if (!this->needFullRebuild_) this->applyUpdatedDocs();
+
+	size_t deltaVdocsCount = this->vdocs_.size() - mainVdocsCount_;
+	if (this->needFullRebuild_ ||
+		deltaVdocsCount + this->deletedVdocsCount_ > std::max(size_t(kMinDocsToMerge), size_t(mainVdocsCount_ * kMaxDeltaRatio))) {
+		// Full rebuild: all documents are placed to main segment
+		this->resetVdocs();
+		mainVdocsCount_ = this->vdocs_.size();
+		deltas_.clear();
+		buildSegment(main_, 0);
+	} else if (this->vdocs_.size() != vdocsCount) {
+		// New documents are indexed to new delta segment. It absorbs the last delta segments, which are not larger than it,
+		// so each document is reindexed O(log(delta docs)) times until full rebuild. Main segment is immutable until full rebuild
+		VDocIdType firstVdoc = vdocsCount;
+		while (!deltas_.empty() && firstVdoc - deltas_.back()->firstVdoc <= VDocIdType(this->vdocs_.size()) - firstVdoc) {
+			firstVdoc = deltas_.back()->firstVdoc;
+			deltas_.pop_back();
+		}
+		deltas_.emplace_back(new WordsSegment);
+		buildSegment(*deltas_.back(), firstVdoc);
+	}
+}
+
+template <typename T>
+void FastIndexText<T>::buildSegment(WordsSegment &segment, VDocIdType firstVdoc) {
+	segment.clear();
+	segment.firstVdoc = firstVdoc;
 	auto tm0 = high_resolution_clock::now();
 
-	// Step 1: parse all documents and build hash map of all unique words
+	// Step 1: parse documents and build hash map of all unique words
 	fast_hash_map<string, WordEntry> words_um;
-	buildWordsMap(words_um);
+	buildWordsMap(words_um, firstVdoc);
 
 	// Step 2: Evaluate total size
 	size_t szCnt = 0;
 	vector<unique_ptr<string>> bufStrs;
-	for (auto &doc : this->idx_map) {
-		for (auto f : this->getDocFields(doc.first, bufStrs)) szCnt += f.first.length();
+	for (VDocIdType j = firstVdoc; j < VDocIdType(this->vdocs_.size()); j++) {
+		if (!this->vdocs_[j].keyEntry) continue;
+		for (auto f : this->getDocFields(*this->vdocs_[j].keyDoc, bufStrs)) szCnt += f.first.length();
 	}
 
 	auto tm2 = high_resolution_clock::now();
 
 	// Step 3: Build words array
-	suffixes_.reserve(words_um.size() * 20, words_um.size());
+	segment.suffixes.reserve(words_um.size() * 20, words_um.size());
+	vector<const string *> wordsStrs;
+	wordsStrs.reserve(words_um.size());
 	for (auto keyIt = words_um.begin(); keyIt != words_um.end(); keyIt++) {
-		WordIdType idx = words_.size();
+		WordIdType idx = segment.words.size();
+		wordsStrs.push_back(&keyIt->first);
 		if (GetConfig()->enableNumbersSearch && keyIt->second.virtualWord) {
-			suffixes_.insert(keyIt->first, idx, kDigitUtfSizeof);
+			segment.suffixes.insert(keyIt->first, idx, kDigitUtfSizeof);
 		} else {
-			suffixes_.insert(keyIt->first, idx);
+			segment.suffixes.insert(keyIt->first, idx);
 		}
 		keyIt->second.vids_.Commit();
-		words_.emplace_back(PackedWordEntry());
+		segment.words.emplace_back(PackedWordEntry());
 	}
 
-	// Step 4: Build suffixes array. It runs in parallel with next step
-	auto &suffixes = suffixes_;
+	// Step 4: Build suffixes array. Its shards are sorted in parallel threads. It runs in parallel with next step
+	auto &suffixes = segment.suffixes;
+	int maxIndexWorkers = std::thread::hardware_concurrency();
+	if (!maxIndexWorkers) maxIndexWorkers = 1;
+	if (maxIndexWorkers > 8) maxIndexWorkers = 8;
 	auto tm3 = high_resolution_clock::now(), tm4 = high_resolution_clock::now();
-	thread sufBuildThread([&suffixes, &tm3]() {
-		suffixes.build();
+	thread sufBuildThread([&suffixes, &tm3, maxIndexWorkers]() {
+		suffixes.build(maxIndexWorkers);
 		tm3 = high_resolution_clock::now();
 	});
 
 	// Step 5: Normalize and sort idrelsets. It runs in parallel with next step
-	auto &words = words_;
+	auto &words = segment.words;
 	size_t idsetcnt = 0;
 	thread idrelsetCommitThread([&words, &tm4, &idsetcnt, &words_um]() {
 		auto wIt = words.begin();
 		for (auto keyIt = words_um.begin(); keyIt != words_um.end(); keyIt++, wIt++) {
 			// Pack idrelset
-			wIt->vids_.insert(wIt->vids_.end(), keyIt->second.vids_.begin(), keyIt->second.vids_.end());
+			wIt->vids_.Pack(keyIt->second.vids_);
 			keyIt->second.vids_.clear();
 			wIt->vids_.shrink_to_fit();
 			idsetcnt += sizeof(*wIt) + wIt->vids_.heap_size();
@@ -627,71 +1087,128 @@ void FastIndexText<T>::Commit() {
 		tm4 = high_resolution_clock::now();
 	});
 
-	// Wait for suf array build. It is neccessary for typos
-	sufBuildThread.join();
-
-	// Step 6: Build typos hash map
-	buildTyposMap();
-
+	// Step 6: Build typos map. Typos are generated from words strings, so it does not wait for suf array build
+	buildTyposMap(segment, wordsStrs);
 	auto tm5 = high_resolution_clock::now();
 
+	sufBuildThread.join();
 	idrelsetCommitThread.join();
 
 	auto tm6 = high_resolution_clock::now();
 
-	logPrintf(LogInfo, "FastIndexText built with [%d uniq words, %d typos, %dKB text size, %dKB suffixarray size, %dKB idrelsets size]",
-			  int(words_um.size()), int(typos_.size()), int(szCnt / 1024), int(suffixes_.heap_size() / 1024), int(idsetcnt / 1024));
+	const char *segmentName = (&segment == &main_) ? "main" : "delta";
+	logPrintf(LogInfo,
+			  "FastIndexText built %s segment with [%d docs, %d uniq words, %d typos, %dKB text size, %dKB suffixarray size, %dKB "
+			  "idrelsets size]",
+			  segmentName, int(this->vdocs_.size() - firstVdoc), int(words_um.size()), int(segment.typos.size()), int(szCnt / 1024),
+			  int(segment.suffixes.heap_size() / 1024), int(idsetcnt / 1024));
 
 	logPrintf(LogInfo,
-			  "FastIndexText::Commit elapsed %d ms total [ build words %d ms, build typos %d ms | build suffixarry %d ms | sort "
+			  "FastIndexText::Commit %s segment elapsed %d ms total [ build words %d ms, build typos %d ms | build suffixarry %d ms | sort "
 			  "idrelsets %d ms]",
-			  int(duration_cast<milliseconds>(tm6 - tm0).count()), int(duration_cast<milliseconds>(tm2 - tm0).count()),
-			  int(duration_cast<milliseconds>(tm5 - tm3).count()), int(duration_cast<milliseconds>(tm3 - tm2).count()),
+			  segmentName, int(duration_cast<milliseconds>(tm6 - tm0).count()), int(duration_cast<milliseconds>(tm2 - tm0).count()),
+			  int(duration_cast<milliseconds>(tm5 - tm2).count()), int(duration_cast<milliseconds>(tm3 - tm2).count()),
 			  int(duration_cast<milliseconds>(tm4 - tm2).count()));
 }
 
 template <typename T>
-IdSet::Ptr FastIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery &dsl) {
+void FastIndexText<T>::processTerm(FtDSLEntry &term, TextSearchResults &res) {
 	FtSelectContext ctx;
+	ctx.results = &res;
+	res.term = term;
+
+	// Prepare term variants (original + translit + stemmed + kblayout)
+	this->prepareVariants(ctx, term, GetConfig()->stemmers);
 
+	if (GetConfig()->logLevel >= LogInfo) {
+		string vars;
+		for (auto &variant : *ctx.variants) {
+			if (&variant != &ctx.variants->front()) vars += ", ";
+			vars += variant.pattern;
+		}
+		vars += "], typos: [";
+		typos_context tctx[kMaxTyposInWord];
+		if (term.opts.typos)
+			mktypos(tctx, term.pattern, GetConfig()->maxTyposInWord, GetConfig()->maxTypoLen, [&vars](const string &typo, int) {
+				vars += typo;
+				vars += ", ";
+			});
+		logPrintf(LogInfo, "Variants: [%s]", vars.c_str());
+	}
+
+	// Search in main and delta segments. Deleted documents are skipped on merge
+	auto searchSegment = [&](WordsSegment &segment) {
+		if (segment.words.empty()) return;
+		processVariants(ctx, segment);
+		if (term.opts.typos) {
+			// Lookup typos from typos map and fill results
+			processTypos(ctx, term, segment);
+		}
+	};
+	searchSegment(main_);
+	for (auto &delta : deltas_) searchSegment(*delta);
+
+	// Word is found in each segment, which holds its documents. Posting list can be found by several variants
+	if (deltas_.empty()) return;
+	fast_hash_map<string, int> docsCounts;
+	fast_hash_set<const PackedIdRelSet *> counted;
+	for (auto &r : res) {
+		if (counted.insert(r.vids_).second) docsCounts[r.word_] += r.vids_->size();
+	}
+	for (auto &r : res) r.docsCount_ = docsCounts[r.word_];
+}
+
+template <typename T>
+IdSet::Ptr FastIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery &dsl) {
 	fctx->GetData()->extraWordSymbols_ = GetConfig()->extraWordSymbols;
 	fctx->GetData()->isWordPositions_ = true;
 
 	// STEP 2: Search dsl terms for each variant
-	for (auto &term : dsl) {
-		ctx.rawResults.push_back(TextSearchResults());
-		TextSearchResults &res = ctx.rawResults.back();
-		res.term = term;
-
-		// Prepare term variants (original + translit + stemmed + kblayout)
-		this->prepareVariants(ctx, term, GetConfig()->stemmers);
-
-		if (GetConfig()->logLevel >= LogInfo) {
-			string vars;
-			for (auto &variant : ctx.variants) {
-				if (&variant != &*ctx.variants.begin()) vars += ", ";
-				vars += variant.pattern;
-			}
-			vars += "], typos: [";
-			typos_context tctx[kMaxTyposInWord];
-			if (term.opts.typos)
-				mktypos(tctx, term.pattern, GetConfig()->maxTyposInWord, GetConfig()->maxTypoLen, [&vars](const string &typo, int) {
-					vars += typo;
-					vars += ", ";
-				});
-			logPrintf(LogInfo, "Variants: [%s]", vars.c_str());
+	vector<TextSearchResults> rawResults(dsl.size());
+	int threads = selectThreadsCount();
+	if (GetConfig()->parallelTermsThreshold && int(dsl.size()) >= GetConfig()->parallelTermsThreshold && threads > 1) {
+		// Terms are independent, so process them in parallel. Each thread processes every N-th term
+		threads = std::min(threads, int(dsl.size()));
+		vector<thread> workers;
+		vector<std::exception_ptr> errors(threads);
+		for (int t = 0; t < threads; t++) {
+			workers.emplace_back([this, t, threads, &dsl, &rawResults, &errors]() {
+				try {
+					for (size_t i = t; i < dsl.size(); i += threads) processTerm(dsl[i], rawResults[i]);
+				} catch (...) {
+					errors[t] = std::current_exception();
+				}
+			});
 		}
-
-		processVariants(ctx);
-		if (term.opts.typos) {
-			// Lookup typos from typos_ map and fill results
-			processTypos(ctx, term);
+		for (auto &worker : workers) worker.join();
+		for (auto &error : errors) {
+			if (error) std::rethrow_exception(error);
 		}
+	} else {
+		for (size_t i = 0; i < dsl.size(); i++) processTerm(dsl[i], rawResults[i]);
 	}
 
-	auto mergedIds = mergeResults(ctx.rawResults, fctx);
+	auto mergedIds = mergeResults(rawResults, fctx);
 	return mergedIds;
 }
+template <typename T>
+bool FastIndexText<T>::HasMatches(FtDSLQuery &dsl, const vector<VDocIdType> &vdocs) {
+	for (auto &term : dsl) {
+		if (term.opts.op == OpNot) continue;
+		TextSearchResults res;
+		processTerm(term, res);
+		for (auto &word : res) {
+			auto vidsIt = word.vids_->begin(), vidsEnd = word.vids_->end();
+			for (VDocIdType vdoc : vdocs) {
+				vidsIt.SkipTo(vdoc);
+				if (vidsIt == vidsEnd) break;
+				if (vidsIt.Id() == vdoc) return true;
+			}
+		}
+	}
+	return false;
+}
+
 template <typename T>
 FtFastConfig *FastIndexText<T>::GetConfig() const {
 	return dynamic_cast<FtFastConfig *>(this->cfg_.get());
@@ -700,9 +1217,22 @@ template <typename T>
 void FastIndexText<T>::CreateConfig(const FtFastConfig *cfg) {
 	if (cfg) {
 		this->cfg_.reset(new FtFastConfig(*cfg));
-		return;
+	} else {
+		this->cfg_.reset(new FtFastConfig());
 	}
-	this->cfg_.reset(new FtFastConfig());
+	initVariantsCache();
+}
+
+template <typename T>
+void FastIndexText<T>::Configure(const string &config) {
+	IndexText<T>::Configure(config);
+	// Variants depend on config
+	initVariantsCache();
+}
+
+template <typename T>
+void FastIndexText<T>::initVariantsCache() {
+	variantsCache_.reset(new FtVariantsCache(GetConfig()->variantsCacheSize));
 }
 
 Index *FastIndexText_New(IndexType type, const string &name, const IndexOpts &opts, const PayloadType payloadType,
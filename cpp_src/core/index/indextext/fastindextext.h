@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include "core/ft/config/ftfastconfig.h"
+#include "core/ft/ftvariantscache.h"
 #include "core/ft/typos.h"
+#include "core/ft/typosmap.h"
 #include "core/selectfunc/ctx/ftctx.h"
 #include "indextext.h"
 
@@ -22,8 +25,10 @@ public:
 		CreateConfig();
 	}
 	Index* Clone() override;
+	void Configure(const string& config) override final;
 	IdSet::Ptr Select(FtCtx::Ptr fctx, FtDSLQuery& dsl) override final;
 	void Commit() override final;
+	bool HasMatches(FtDSLQuery& dsl, const vector<VDocIdType>& vdocs) override final;
 	IndexMemStat GetMemStat() override;
 
 protected:
@@ -43,6 +48,10 @@ protected:
 		const char* pattern;
 		int proc_;
 		int16_t wordLen_;
+		// Found word
+		const char* word_;
+		// Count of documents with word in all segments. IDF of word does not depend on segment, which holds its documents
+		int docsCount_;
 	};
 
 	class TextSearchResults : public h_vector<TextSearchResult, 8> {
@@ -51,16 +60,29 @@ protected:
 		FtDSLEntry term;
 	};
 
-	struct FtVariantEntry {
-		string pattern;
-		FtDslOpts opts;
-		int proc;
+	// Set of words with their posting lists
+	struct WordsSegment {
+		void clear() {
+			words.clear();
+			typos.clear();
+			suffixes.clear();
+		}
+		// Key Entries corresponding to words. Addresable by WordIdType
+		vector<PackedWordEntry> words;
+		// Typos map. typo signature <-> original word id
+		TyposMap typos;
+		// Suffix map. suffix <-> original word id
+		suffix_map<string, WordIdType> suffixes;
+		// Documents of segment are placed in vdocs_ from firstVdoc to the first document of next segment
+		VDocIdType firstVdoc = 0;
 	};
 
 	struct FtSelectContext {
-		vector<FtVariantEntry> variants;
-		fast_hash_map<WordIdType, pair<size_t, size_t>> foundWords;
-		vector<TextSearchResults> rawResults;
+		std::shared_ptr<const FtVariants> variants;
+		// Found words of all segments, addressable by word entry. Value is position of word in results
+		fast_hash_map<const PackedWordEntry*, size_t> foundWords;
+		// Results of current term
+		TextSearchResults* results;
 	};
 
 	struct MergedIdRel {
@@ -72,28 +94,46 @@ protected:
 
 	IdSet::Ptr mergeResults(vector<TextSearchResults>& rawResults, FtCtx::Ptr ctx);
 	void mergeItaration(TextSearchResults& rawRes, vector<bool>& exists, vector<MergeInfo>& merged, vector<MergedIdRel>& merged_rd,
-						h_vector<int16_t>& idoffsets, bool need_area);
+						h_vector<int>& idoffsets, bool need_area, VDocIdType firstVdoc, VDocIdType lastVdoc, int mergeLimit);
+	void mergePartition(vector<TextSearchResults>& rawResults, vector<MergeInfo>& merged, int idsMaxCnt, bool need_area,
+						VDocIdType firstVdoc, VDocIdType lastVdoc, int mergeLimit);
+	// Match of word in document, which is evaluated by top-K merge
+	struct DocMatch {
+		const TextSearchResults* term;
+		const TextSearchResult* word;
+		double idf;
+		const IdRelType* relid;
+	};
+	void mergeTopK(vector<TextSearchResults>& rawResults, size_t maxResults, bool need_area, vector<MergeInfo>& merged);
+	int mergeDocument(VDocIdType vid, const vector<DocMatch>& matches, bool simple, AreaHolder* holder);
 
 	void debugMergeStep(const char* msg, int vid, float normBm25, float normDist, int finalRank, int prevRank);
-	void processVariants(FtSelectContext&);
+	void processVariants(FtSelectContext&, WordsSegment&);
 	void prepareVariants(FtSelectContext&, FtDSLEntry&, std::vector<string>& langs);
-	void processTypos(FtSelectContext&, FtDSLEntry&);
+	void processTypos(FtSelectContext&, FtDSLEntry&, WordsSegment&);
+	void processTerm(FtDSLEntry& term, TextSearchResults& res);
 
-	void buildWordsMap(fast_hash_map<string, WordEntry>& m);
+	void buildWordsMap(fast_hash_map<string, WordEntry>& m, VDocIdType firstVdoc);
 	void buildVirtualWord(const string& word, fast_hash_map<string, WordEntry>& words_um, VDocIdType docType, int rfield, size_t insertPos,
 						  std::vector<string>& output);
+	void buildSegment(WordsSegment& segment, VDocIdType firstVdoc);
 
-	void buildTyposMap();
+	void buildTyposMap(WordsSegment& segment, const vector<const string*>& words);
 	void initSearchers();
-
-	// Key Entries corresponding to words. Addresable by WordIdType
-	vector<PackedWordEntry> words_;
-	// Typos map. typo string <-> original word id
-	flat_str_multimap<string, WordIdType> typos_;
-	// Suffix map. suffix <-> original word id
-	suffix_map<string, WordIdType> suffixes_;
+	void initVariantsCache();
+
+	// Main segment with words of documents, which were present on last full rebuild
+	WordsSegment main_;
+	// Delta segments with words of documents, which were added after last full rebuild. Each segment is at least twice
+	// as large as the next one, so there are O(log(delta docs)) segments
+	vector<unique_ptr<WordsSegment>> deltas_;
+	// Count of documents in main segment. Documents of delta segments are placed after them in vdocs_
+	VDocIdType mainVdocsCount_ = 0;
 	// Virtual documents, merged. Addresable by VDocIdType
 	vector<double> avgWordsCount_;
+	// Cache of query terms variants. Stemming, translit and kblayout of repeated terms are not recomputed
+	unique_ptr<FtVariantsCache> variantsCache_;
+	std::atomic<size_t> variantsCacheHits_{0}, variantsCacheMisses_{0};
 };
 
 Index* FastIndexText_New(IndexType type, const string& _name, const IndexOpts& opts, const PayloadType payloadType,
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <thread>
 
 #include "fuzzyindextext.h"
 #include "tools/customlocal.h"
@@ -9,8 +10,14 @@ using std::make_shared;
 
 namespace reindexer {
 using std::wstring;
+using std::thread;
 using search_engine::MergedData;
 
+// Deleted documents are still present in search engine data. Full rebuild is done, when count of them exceeds
+// max(kMinDeletedToRebuild, kMaxDeletedRatio * (count of documents))
+const int kMinDeletedToRebuild = 1000;
+const double kMaxDeletedRatio = 0.1;
+
 template <typename T>
 Index* FuzzyIndexText<T>::Clone() {
 	return new FuzzyIndexText<T>(*this);
@@ -32,6 +39,8 @@ IdSet::Ptr FuzzyIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery& dsl) {
 		it->proc_ *= coof;
 		if (it->proc_ < GetConfig()->minOkProc) continue;
 		assert(it->id_ < this->vdocs_.size());
+		// Document was deleted after build
+		if (!this->vdocs_[it->id_].keyEntry) continue;
 		const auto& id_set = this->vdocs_[it->id_].keyEntry->Sorted(0);
 		fctx->Add(id_set.begin(), id_set.end(), it->proc_);
 		mergedIds->Append(id_set.begin(), id_set.end(), IdSet::Unordered);
@@ -40,21 +49,56 @@ IdSet::Ptr FuzzyIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery& dsl) {
 	return mergedIds;
 }
 
+template <typename T>
+bool FuzzyIndexText<T>::HasMatches(FtDSLQuery& dsl, const vector<VDocIdType>& vdocs) {
+	auto result = engine_.Search(dsl);
+	for (auto& res : *result.data_) {
+		if (std::binary_search(vdocs.begin(), vdocs.end(), VDocIdType(res.id_))) return true;
+	}
+	return false;
+}
+
 template <typename T>
 void FuzzyIndexText<T>::Commit() {
+	VDocIdType firstVdoc = this->vdocs_.size();
+	if (!this->needFullRebuild_) this->applyUpdatedDocs();
+
+	if (this->needFullRebuild_ ||
+		size_t(this->deletedVdocsCount_) > std::max(size_t(kMinDeletedToRebuild), size_t(this->vdocs_.size() * kMaxDeletedRatio))) {
+		// Full rebuild: all documents are added again
+		this->resetVdocs();
+		engine_.Rebuild();
+		firstVdoc = 0;
+	}
+	// Otherwise only new documents are added
+	if (firstVdoc == VDocIdType(this->vdocs_.size())) return;
+
+	int maxIndexWorkers = !this->opts_.IsDense() ? std::thread::hardware_concurrency() : 0;
+	if (!maxIndexWorkers) maxIndexWorkers = 1;
+	if (maxIndexWorkers > 8) maxIndexWorkers = 8;
+
+	// buffer strings, for printing non text fields
 	vector<unique_ptr<string>> bufStrs;
+	// array with pointers to docs fields text, starting from firstVdoc
+	vector<h_vector<pair<string_view, int>, 8>> vdocsTexts;
+	vdocsTexts.reserve(this->vdocs_.size() - firstVdoc);
+	for (VDocIdType j = firstVdoc; j < VDocIdType(this->vdocs_.size()); j++) {
+		vdocsTexts.emplace_back(this->getDocFields(*this->vdocs_[j].keyDoc, bufStrs));
+	}
 
-	for (auto& doc : this->idx_map) {
-		auto res = this->getDocFields(doc.first, bufStrs);
-#ifdef REINDEX_FT_EXTRA_DEBUG
-		this->vdocs_.push_back({&doc.first, &doc.second, {}, {}});
-#else
-		this->vdocs_.push_back({&doc.second, {}, {}});
-#endif
-		for (auto& r : res) {
-			engine_.AddData(r.first, this->vdocs_.size() - 1, r.second, this->cfg_->extraWordSymbols);
-		}
+	// add documents parallel in maxIndexWorkers threads
+	engine_.StartAdding(maxIndexWorkers);
+	vector<thread> threads;
+	for (int t = 0; t < maxIndexWorkers; t++) {
+		threads.emplace_back(
+			[this, &vdocsTexts, maxIndexWorkers, firstVdoc](int i) {
+				for (VDocIdType j = firstVdoc + i; j < VDocIdType(this->vdocs_.size()); j += maxIndexWorkers) {
+					for (auto& f : vdocsTexts[j - firstVdoc]) engine_.AddData(f.first, j, f.second, this->cfg_->extraWordSymbols, i);
+				}
+			},
+			t);
 	}
+	for (auto& th : threads) th.join();
 	engine_.Commit();
 }
 template <typename T>
@@ -26,6 +26,7 @@ public:
 	Index* Clone() override;
 	IdSet::Ptr Select(FtCtx::Ptr fctx, FtDSLQuery& dsl) override final;
 	void Commit() override final;
+	bool HasMatches(FtDSLQuery& dsl, const vector<VDocIdType>& vdocs) override final;
 
 protected:
 	FtFuzzyConfig* GetConfig() const;
@@ -20,12 +20,14 @@ using std::chrono::high_resolution_clock;
 using std::chrono::milliseconds;
 using std::thread;
 template <typename T>
-IndexText<T>::IndexText(IndexType _type, const string &_name) : IndexUnordered<T>(_type, _name, IndexOpts()) {
+IndexText<T>::IndexText(IndexType _type, const string &_name)
+	: IndexUnordered<T>(_type, _name, IndexOpts()), vdocsIds_(1000, this->idx_map.hash_function(), this->idx_map.key_eq()) {
 	initSearchers();
 }
 
 template <typename T>
-IndexText<T>::IndexText(const IndexText<T> &other) : IndexUnordered<T>(other), cache_ft_(other.cache_ft_) {
+IndexText<T>::IndexText(const IndexText<T> &other)
+	: IndexUnordered<T>(other), cache_ft_(other.cache_ft_), vdocsIds_(1000, this->idx_map.hash_function(), this->idx_map.key_eq()) {
 	initSearchers();
 }
 
@@ -54,16 +56,150 @@ void IndexText<T>::initSearchers() {
 	}
 }
 
+template <typename T>
+KeyRef IndexText<T>::Upsert(const KeyRef &key, IdType id) {
+	KeyRef ret = IndexUnordered<T>::Upsert(key, id);
+	if (key.Type() != KeyValueEmpty) markDocUpdated(key, id, 1);
+	return ret;
+}
+
+template <typename T>
+void IndexText<T>::Delete(const KeyRef &key, IdType id) {
+	// Document key have to be stored before deletion: it will be erased from idx_map on commit, if there are no more ids for it
+	if (key.Type() != KeyValueEmpty) markDocUpdated(key, id, -1);
+	IndexUnordered<T>::Delete(key, id);
+}
+
+template <typename T>
+void IndexText<T>::markDocUpdated(const KeyRef &key, IdType id, int delta) {
+	if (needFullRebuild_) return;
+	if (updatedDocs_.size() > this->idx_map.size() / 2) {
+		// Too many updates - full rebuild will be faster
+		needFullRebuild_ = true;
+		updatedDocs_.clear();
+		updatedRows_.clear();
+		return;
+	}
+	auto keyIt = this->find(key);
+	if (keyIt == this->idx_map.end()) return;
+	updatedDocs_.push_back(keyIt->first);
+
+	auto &rowDocs = updatedRows_[id];
+	for (auto it = rowDocs.begin(); it != rowDocs.end(); ++it) {
+		if (this->idx_map.key_eq()(it->first, keyIt->first)) {
+			if (!(it->second += delta)) rowDocs.erase(it);
+			return;
+		}
+	}
+	rowDocs.push_back({keyIt->first, delta});
+}
+
+template <typename T>
+void IndexText<T>::applyUpdatedDocs() {
+	for (auto &key : updatedDocs_) {
+		auto keyIt = this->idx_map.find(key);
+		auto vdocIt = vdocsIds_.find(key);
+		if (keyIt != this->idx_map.end()) {
+			if (vdocIt != vdocsIds_.end()) {
+				// Document is already indexed, but its entry could be reallocated, if it was deleted and inserted again
+				auto &vdoc = vdocs_[vdocIt->second];
+				vdoc.keyDoc = &keyIt->first;
+				vdoc.keyEntry = &keyIt->second;
+				continue;
+			}
+			// New document
+			vdocsIds_.emplace(keyIt->first, VDocIdType(vdocs_.size()));
+			vdocs_.push_back({&keyIt->first, &keyIt->second, {}, {}});
+		} else if (vdocIt != vdocsIds_.end()) {
+			// Deleted document. It is still present in full text structures, so just mark it as deleted
+			auto &vdoc = vdocs_[vdocIt->second];
+			vdoc.keyDoc = nullptr;
+			vdoc.keyEntry = nullptr;
+			vdocsIds_.erase(vdocIt);
+			deletedVdocsCount_++;
+		}
+	}
+}
+
+template <typename T>
+void IndexText<T>::resetVdocs() {
+	vdocs_.clear();
+	vdocsIds_.clear();
+	vdocs_.reserve(this->idx_map.size());
+	for (auto &doc : this->idx_map) {
+		vdocsIds_.emplace(doc.first, VDocIdType(vdocs_.size()));
+		vdocs_.push_back({&doc.first, &doc.second, {}, {}});
+	}
+	deletedVdocsCount_ = 0;
+}
+
 template <typename T>
 void IndexText<T>::Commit(const CommitContext &ctx) {
+	// Cached results are kept, while build is in progress. Index gets empty cache, if build fails
+	auto cache = std::move(cache_ft_);
 	cache_ft_.reset(new FtIdSetCache());
 
 	IndexUnordered<T>::Commit(ctx);
 
-	if (!(ctx.phases() & CommitContext::PrepareForSelect)) return;
+	if (!(ctx.phases() & CommitContext::PrepareForSelect)) {
+		cache_ft_ = std::move(cache);
+		return;
+	}
+
+	// Cached results survive commit, unless full text structures are rebuilt from scratch
+	bool keepCache = !needFullRebuild_ && cache && !cache->Empty();
+	fast_hash_set<IdType> changedRows;
+	vector<typename T::key_type> newDocs;
+	if (keepCache) {
+		for (auto &row : updatedRows_) {
+			for (auto &doc : row.second) {
+				if (doc.second < 0) {
+					changedRows.insert(row.first);
+				} else if (vdocsIds_.find(doc.first) != vdocsIds_.end()) {
+					// Cached results contain other rows of old document, if it was found
+					auto keyIt = this->idx_map.find(doc.first);
+					if (keyIt != this->idx_map.end()) {
+						for (IdType id : keyIt->second.Unsorted()) changedRows.insert(id);
+					}
+				} else {
+					newDocs.push_back(doc.first);
+				}
+			}
+		}
+	}
 
-	vdocs_.clear();
 	Commit();
+	if (keepCache) {
+		if (!changedRows.empty() || !newDocs.empty()) invalidateCache(*cache, changedRows, newDocs);
+		cache_ft_ = std::move(cache);
+	}
+	updatedDocs_.clear();
+	updatedRows_.clear();
+	needFullRebuild_ = false;
+}
+
+template <typename T>
+void IndexText<T>::invalidateCache(FtIdSetCache &cache, const fast_hash_set<IdType> &rows, const vector<typename T::key_type> &newDocs) {
+	vector<VDocIdType> newVdocs;
+	for (auto &key : newDocs) {
+		auto vdocIt = vdocsIds_.find(key);
+		if (vdocIt != vdocsIds_.end()) newVdocs.push_back(vdocIt->second);
+	}
+	std::sort(newVdocs.begin(), newVdocs.end());
+	newVdocs.erase(std::unique(newVdocs.begin(), newVdocs.end()), newVdocs.end());
+
+	cache.Invalidate([&](const IdSetCacheKey &key, const FtIdSetCacheVal &val) {
+		// Result is not cached yet
+		if (!val.ctx) return false;
+		for (IdType id : IdSetRef(val.ids.get())) {
+			if (rows.find(id) != rows.end()) return true;
+		}
+		if (newVdocs.empty()) return false;
+		// Query have to be evaluated against new documents only. Scores of other documents are not recalculated
+		FtDSLQuery dsl(this->ftFields_, this->cfg_->stopWords, this->cfg_->extraWordSymbols);
+		dsl.parse((*key.keys)[0].As<string>());
+		return HasMatches(dsl, newVdocs);
+	});
 }
 
 // Generic implemetation for string index
@@ -147,7 +283,8 @@ SelectKeyResults IndexText<T>::SelectKey(const KeyValues &keys, CondType conditi
 	dsl.parse(keys[0].As<string>());
 	auto mergedIds = Select(ftctx, dsl);
 
-	if (need_put && mergedIds->size()) cache_ft_->Put(*cache_ft.key, FtIdSetCacheVal{mergedIds, ftctx->GetData()});
+	// Results limited by count of the best documents are not complete, so they are not cached
+	if (need_put && mergedIds->size() && !ftctx->MaxResults()) cache_ft_->Put(*cache_ft.key, FtIdSetCacheVal{mergedIds, ftctx->GetData()});
 
 	res.push_back(SingleSelectKeyResult(mergedIds));
 	SelectKeyResults r(res);
@@ -158,6 +295,8 @@ template <typename T>
 void IndexText<T>::Configure(const string &config) {
 	string config_nc = config;
 	cfg_->parse(&config_nc[0]);
+	needFullRebuild_ = true;
+	updatedDocs_.clear();
 };
 
 template class IndexText<unordered_str_map<Index::KeyEntryPlain>>;
@@ -9,6 +9,7 @@
 #include "core/index/indexunordered.h"
 #include "core/selectfunc/ctx/ftctx.h"
 #include "estl/fast_hash_map.h"
+#include "estl/fast_hash_set.h"
 #include "estl/flat_str_map.h"
 #include "estl/suffix_map.h"
 
@@ -38,10 +39,13 @@ public:
 	template <typename U = T>
 	IndexText(IndexType _type, const string& _name, const IndexOpts& opts, const PayloadType payloadType, const FieldsSet& fields,
 			  typename std::enable_if<is_payload_unord_map_key<U>::value>::type* = 0)
-		: IndexUnordered<T>(_type, _name, opts, payloadType, fields) {
+		: IndexUnordered<T>(_type, _name, opts, payloadType, fields),
+		  vdocsIds_(1000, this->idx_map.hash_function(), this->idx_map.key_eq()) {
 		initSearchers();
 	}
 
+	KeyRef Upsert(const KeyRef& key, IdType id) override final;
+	void Delete(const KeyRef& key, IdType id) override final;
 	SelectKeyResults SelectKey(const KeyValues& keys, CondType condition, SortType stype, Index::ResultType res_type,
 							   BaseFunctionCtx::Ptr ctx) override final;
 	void Commit(const CommitContext& ctx) override final;
@@ -49,18 +53,28 @@ public:
 	void Configure(const string& config) override;
 	virtual IdSet::Ptr Select(FtCtx::Ptr fctx, FtDSLQuery& dsl) = 0;
 	virtual void Commit() = 0;
+	// Check, if some of documents vdocs (sorted) could be found by dsl. False positives are allowed
+	virtual bool HasMatches(FtDSLQuery& dsl, const vector<VDocIdType>& vdocs) = 0;
 
 protected:
 	struct VDocEntry {
-#ifdef REINDEX_FT_EXTRA_DEBUG
 		const typename T::key_type* keyDoc;
-#endif
+		// nullptr, if document was deleted from index after build of full text structures
 		typename T::mapped_type* keyEntry;
 		h_vector<float, 3> wordsCount;
 		h_vector<float, 3> mostFreqWordCount;
 	};
 
 	h_vector<pair<string_view, int>, 8> getDocFields(const typename T::key_type&, vector<unique_ptr<string>>& bufStrs);
+	// Remember update of document key in row id: delta is 1 on upsert and -1 on delete
+	void markDocUpdated(const KeyRef& key, IdType id, int delta);
+	// Apply updatedDocs_ to vdocs_: new documents are appended to vdocs_, deleted documents are marked by nullptr keyEntry
+	void applyUpdatedDocs();
+	// Fill vdocs_ by all the documents of index for full rebuild
+	void resetVdocs();
+	// Evict cached results, which could be changed by updatedDocs_. rows are rows, which were removed from documents,
+	// and all the rows of old documents, which got new rows. newDocs are documents, which were not indexed before
+	void invalidateCache(FtIdSetCache& cache, const fast_hash_set<IdType>& rows, const vector<typename T::key_type>& newDocs);
 
 	void initSearchers();
 
@@ -73,6 +87,18 @@ protected:
 	shared_ptr<FtIdSetCache> cache_ft_;
 	fast_hash_map<string, int> ftFields_;
 	unique_ptr<BaseFTConfig> cfg_;
+
+	// Documents, which were added or deleted since last build of full text structures
+	vector<typename T::key_type> updatedDocs_;
+	// Documents keys of rows, which were updated since last build, with balance of upserts and deletes of row for each key.
+	// Update of item without change of indexed text gives zero balance
+	fast_hash_map<IdType, h_vector<pair<typename T::key_type, int>, 2>> updatedRows_;
+	// Full text structures have to be rebuilt from all the documents, instead of applying updatedDocs_
+	bool needFullRebuild_ = true;
+	// Virtual documents ids by documents keys
+	fast_hash_map<typename T::key_type, VDocIdType, typename T::hasher, typename T::key_equal> vdocsIds_;
+	// Count of deleted documents, which are still present in full text structures
+	int deletedVdocsCount_ = 0;
 };
 
 }  // namespace reindexer
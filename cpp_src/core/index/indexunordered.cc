@@ -72,6 +72,14 @@ IdSetRef IndexUnordered<T>::Find(const KeyRef &key) {
 	return (res != idx_map.end()) ? res->second.Sorted(0) : IdSetRef();
 }
 
+template <typename T>
+bool IndexUnordered<T>::ForEachKey(const std::function<void(const KeyRef &key, const IdSetRef &ids)> &visitor) {
+	assertf(!tracker_.updated_.size() && !tracker_.completeUpdated_, "Internal error: enumerate keys of non commited index %s\n",
+			this->name_.c_str());
+	for (auto &keyIt : idx_map) visitor(KeyRef(keyIt.first), keyIt.second.Sorted(0));
+	return true;
+}
+
 template <typename T>
 void IndexUnordered<T>::tryIdsetCache(const KeyValues &keys, CondType condition, SortType sortId,
 									  std::function<void(SelectKeyResult &)> selector, SelectKeyResult &res) {
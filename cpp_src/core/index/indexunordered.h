@@ -57,6 +57,7 @@ public:
 	IndexMemStat GetMemStat() override;
 	size_t Size() const override final { return idx_map.size(); }
 	IdSetRef Find(const KeyRef &key) override final;
+	bool ForEachKey(const std::function<void(const KeyRef &key, const IdSetRef &ids)> &visitor) override;
 
 protected:
 	void tryIdsetCache(const KeyValues &keys, CondType condition, SortType sortId, std::function<void(SelectKeyResult &)> selector,
@@ -1,5 +1,6 @@
 
 #include "core/ft/ftsetcashe.h"
+#include "core/ft/ftvariantscache.h"
 #include "core/idset.h"
 #include "core/idsetcache.h"
 #include "core/keyvalue/keyvalue.h"
@@ -89,6 +90,22 @@ void LRUCache<K, V, hash, equal>::Invalidate() {
 	totalCacheSize_ = 0;
 }
 
+template <typename K, typename V, typename hash, typename equal>
+void LRUCache<K, V, hash, equal>::Invalidate(const std::function<bool(const K &, const V &)> &filter) {
+	std::lock_guard<mutex> lk(lock_);
+
+	for (auto it = items_.begin(); it != items_.end();) {
+		if (!filter(it->first, it->second.val)) {
+			it++;
+			continue;
+		}
+		totalCacheSize_ = totalCacheSize_ - (sizeof(Entry) + kElemSizeOverhead + it->first.Size() + it->second.val.Size());
+		lru_.erase(it->second.lruPos);
+		it = items_.erase(it);
+		++eraseCount_;
+	}
+}
+
 template <typename K, typename V, typename hash, typename equal>
 LRUCacheMemStat LRUCache<K, V, hash, equal>::GetMemStat() {
 	std::lock_guard<mutex> lk(lock_);
@@ -106,6 +123,7 @@ LRUCacheMemStat LRUCache<K, V, hash, equal>::GetMemStat() {
 };
 template class LRUCache<IdSetCacheKey, IdSetCacheVal, hash_idset_cache_key, equal_idset_cache_key>;
 template class LRUCache<IdSetCacheKey, FtIdSetCacheVal, hash_idset_cache_key, equal_idset_cache_key>;
+template class LRUCache<FtVariantsCacheKey, FtVariantsCacheVal, hash_ft_variants_cache_key, equal_ft_variants_cache_key>;
 template class LRUCache<QueryCacheKey, QueryCacheVal, HashQueryCacheKey, EqQueryCacheKey>;
 template class LRUCache<JoinCacheKey, JoinCacheVal, hash_join_cache_key, equal_join_cache_key>;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <estl/fast_hash_set.h>
+#include <functional>
 #include <list>
 #include <mutex>
 #include <unordered_map>
@@ -33,6 +34,8 @@ public:
 
 	bool Empty() const { return items_.empty(); }
 	void Invalidate();
+	// Erase entries, for which filter returns true
+	void Invalidate(const std::function<bool(const K &, const V &)> &filter);
 
 protected:
 	void eraseLRU();
@@ -943,7 +943,8 @@ NamespaceMemStat Namespace::GetMemStat() {
 
 	for (auto &idx : indexes_) {
 		auto istat = idx->GetMemStat();
-		ret.Total.indexesSize += istat.idsetPlainSize + istat.idsetBTreeSize + istat.sortOrdersSize + istat.fulltextSize + istat.columnSize;
+		ret.Total.indexesSize += istat.idsetPlainSize + istat.idsetBTreeSize + istat.sortOrdersSize + istat.fulltextSize + istat.typosSize +
+								 istat.columnSize;
 		ret.Total.dataSize += istat.dataSize;
 		ret.Total.cacheSize += istat.idsetCache.totalSize;
 		ret.indexes.push_back(istat);
@@ -55,6 +55,10 @@ void LRUCacheMemStat::GetJSON(WrSerializer &ser) {
 	ser.Printf("\"items_count\":%" PRI_SIZE_T ",", itemsCount);
 	ser.Printf("\"empty_count\":%" PRI_SIZE_T ",", emptyCount);
 	ser.Printf("\"hit_count_limit\":%" PRI_SIZE_T "", hitCountLimit);
+	if (hitsCount || missesCount) {
+		ser.Printf(",\"hits_count\":%" PRI_SIZE_T ",", hitsCount);
+		ser.Printf("\"misses_count\":%" PRI_SIZE_T "", missesCount);
+	}
 	ser.PutChar('}');
 }
 
@@ -67,6 +71,7 @@ void IndexMemStat::GetJSON(WrSerializer &ser) {
 	if (idsetPlainSize) ser.Printf("\"idset_plain_size\":%" PRI_SIZE_T ",", idsetPlainSize);
 	if (sortOrdersSize) ser.Printf("\"sort_orders_size\":%" PRI_SIZE_T ",", sortOrdersSize);
 	if (fulltextSize) ser.Printf("\"fulltext_size\":%" PRI_SIZE_T ",", fulltextSize);
+	if (typosSize) ser.Printf("\"typos_size\":%" PRI_SIZE_T ",", typosSize);
 	if (columnSize) ser.Printf("\"column_size\":%" PRI_SIZE_T ",", columnSize);
 
 	if (idsetCache.totalSize || idsetCache.itemsCount || idsetCache.emptyCount || idsetCache.hitCountLimit) {
@@ -75,6 +80,12 @@ void IndexMemStat::GetJSON(WrSerializer &ser) {
 		ser.PutChar(',');
 	}
 
+	if (variantsCache.totalSize || variantsCache.itemsCount || variantsCache.hitsCount || variantsCache.missesCount) {
+		ser.Printf("\"variants_cache\":");
+		variantsCache.GetJSON(ser);
+		ser.PutChar(',');
+	}
+
 	ser.Printf("\"name\":\"%s\"", name.c_str());
 
 	ser.PutChar('}');
@@ -17,6 +17,9 @@ struct LRUCacheMemStat {
 	size_t itemsCount = 0;
 	size_t emptyCount = 0;
 	size_t hitCountLimit = 0;
+	// Counts of lookups, which were served from cache and which missed it. Only some caches track them
+	size_t hitsCount = 0;
+	size_t missesCount = 0;
 };
 
 struct IndexMemStat {
@@ -28,8 +31,10 @@ struct IndexMemStat {
 	size_t idsetPlainSize = 0;
 	size_t sortOrdersSize = 0;
 	size_t fulltextSize = 0;
+	size_t typosSize = 0;
 	size_t columnSize = 0;
 	LRUCacheMemStat idsetCache;
+	LRUCacheMemStat variantsCache;
 };
 
 struct NamespaceMemStat {
@@ -81,7 +81,8 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 	// DO NOT use deducted sort order in the following cases:
 	// - query contains explicity specified sort order
 	// - query contains FullText query.
-	bool disableOptimizeSortOrder = !ctx.query.sortingEntries_.empty() || ctx.preResult;
+	// - query is selected by batches, so sort order must be the same for all of them
+	bool disableOptimizeSortOrder = !ctx.query.sortingEntries_.empty() || ctx.preResult || ctx.cursor;
 	SortingEntries sortBy = (isFt || disableOptimizeSortOrder) ? ctx.query.sortingEntries_ : getOptimalSortOrder(*whereEntries);
 	prepareSortingIndexes(sortBy);
 
@@ -103,10 +104,21 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 		}
 	}
 
+	LoopCtx lctx(ctx);
+	lctx.aggregators = getAggregators(ctx.query);
+	FieldsSet aggregationIndexes;
+	for (auto &aggregator : lctx.aggregators) {
+		// Count of all items is known without index keys, so there are no need to commit index for it
+		if (aggregator.Type() != AggCount && canAggregateByIndex(aggregator, ctx, *whereEntries)) {
+			aggregationIndexes.push_back(aggregator.Fields()[0]);
+		}
+	}
+
 	// Check if commit needed
-	bool needSortOrders = !sortBy.empty() && (ns_->sortedQueriesCount_ > kBuildSortOrdersHitCount || ctx.preResult || ctx.joinedSelectors);
-	if (!whereEntries->empty() || needSortOrders) {
-		FieldsSet indexesForCommit;
+	bool needSortOrders =
+		!sortBy.empty() && (ns_->sortedQueriesCount_ > kBuildSortOrdersHitCount || ctx.preResult || ctx.joinedSelectors || ctx.cursor);
+	if (!whereEntries->empty() || needSortOrders || !aggregationIndexes.empty()) {
+		FieldsSet indexesForCommit = aggregationIndexes;
 		for (const QueryEntry &entry : *whereEntries) {
 			if (entry.idxNo != IndexValueType::SetByJsonPath) {
 				indexesForCommit.push_back(entry.idxNo);
@@ -124,6 +136,10 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 	// Prepare sorting context
 	prepareSortingContext(sortBy, ctx, isFt);
 	const auto &sortingData = ctx.sortingCtx.entries;
+	// Select loop can be continued only if its items are produced in final order
+	if (ctx.cursor && (isFt || ctx.isForceAll || sortingData.size() > 1 || (!sortingData.empty() && !sortingData[0].index))) {
+		throw Error(errQueryExec, "Query can't be selected by batches");
+	}
 
 	// Add preresults with common conditions of join Queres
 	RawQueryResult qres;
@@ -144,7 +160,15 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 	}
 	TIMEPOINT(tm1);
 
-	selectWhere(*whereEntries, qres, ctx.sortingCtx.firstColumnSortId, isFt);
+	// Full text index may rank only the best documents, when result is ordered by rank and only first of them are returned
+	size_t ftMaxResults = 0;
+	if (isFt && whereEntries->size() == 1 && sortBy.empty() && !ctx.preResult && !ctx.isForceAll &&
+		(!ctx.joinedSelectors || ctx.joinedSelectors->empty()) && ctx.query.calcTotal == ModeNoTotal && lctx.aggregators.empty() &&
+		ctx.query.count != UINT_MAX) {
+		ftMaxResults = size_t(ctx.query.start) + ctx.query.count;
+	}
+
+	selectWhere(*whereEntries, qres, ctx.sortingCtx.firstColumnSortId, isFt, ftMaxResults);
 
 	TIMEPOINT(tm2);
 
@@ -226,21 +250,23 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 
 	result.addNSContext(ns_->payloadType_, ns_->tagsMatcher_, JsonPrintFilter(ns_->tagsMatcher_, ctx.query.selectFilter_));
 
+	aggregateByIndexes(lctx, *whereEntries);
+
 	TIMEPOINT(tm3);
-	LoopCtx lctx(ctx);
 	lctx.qres = &qres;
 	lctx.ftIndex = isFt;
 	lctx.calcTotal = needCalcTotal;
 	if (isFt) result.haveProcent = true;
 	if (!sortingData.empty()) lctx.sortingCtxIdx = 0;  // Sort by 1st column first
-	if (reverse && hasComparators && hasScan) selectLoop<true, true, true>(lctx, result);
-	if (!reverse && hasComparators && hasScan) selectLoop<false, true, true>(lctx, result);
-	if (reverse && !hasComparators && hasScan) selectLoop<true, false, true>(lctx, result);
-	if (!reverse && !hasComparators && hasScan) selectLoop<false, false, true>(lctx, result);
-	if (reverse && hasComparators && !hasScan) selectLoop<true, true, false>(lctx, result);
-	if (!reverse && hasComparators && !hasScan) selectLoop<false, true, false>(lctx, result);
-	if (reverse && !hasComparators && !hasScan) selectLoop<true, false, false>(lctx, result);
-	if (!reverse && !hasComparators && !hasScan) selectLoop<false, false, false>(lctx, result);
+	if (canCountByIdsets(lctx, hasComparators, hasScan)) countLoop(lctx, result);
+	else if (reverse && hasComparators && hasScan) selectLoop<true, true, true>(lctx, result);
+	else if (!reverse && hasComparators && hasScan) selectLoop<false, true, true>(lctx, result);
+	else if (reverse && !hasComparators && hasScan) selectLoop<true, false, true>(lctx, result);
+	else if (!reverse && !hasComparators && hasScan) selectLoop<false, false, true>(lctx, result);
+	else if (reverse && hasComparators && !hasScan) selectLoop<true, true, false>(lctx, result);
+	else if (!reverse && hasComparators && !hasScan) selectLoop<false, true, false>(lctx, result);
+	else if (reverse && !hasComparators && !hasScan) selectLoop<true, false, false>(lctx, result);
+	else if (!reverse && !hasComparators && !hasScan) selectLoop<false, false, false>(lctx, result);
 
 	TIMEPOINT(tm4);
 
@@ -459,7 +485,7 @@ QueryEntries NsSelecter::lookupQueryIndexes(const QueryEntries &entries) {
 	return ret;
 }
 
-void NsSelecter::selectWhere(const QueryEntries &entries, RawQueryResult &result, unsigned sortId, bool is_ft) {
+void NsSelecter::selectWhere(const QueryEntries &entries, RawQueryResult &result, unsigned sortId, bool is_ft, size_t ftMaxResults) {
 	bool fullText = false;
 	for (const QueryEntry &qe : entries) {
 		TagsPath tagsPath;
@@ -490,7 +516,10 @@ void NsSelecter::selectWhere(const QueryEntries &entries, RawQueryResult &result
 				type = Index::ForceIdset;
 
 			auto ctx = fnc_ ? fnc_->CreateCtx(qe.idxNo) : BaseFunctionCtx::Ptr{};
-			if (ctx && ctx->type == BaseFunctionCtx::kFtCtx) ft_ctx_ = reindexer::reinterpret_pointer_cast<FtCtx>(ctx);
+			if (ctx && ctx->type == BaseFunctionCtx::kFtCtx) {
+				ft_ctx_ = reindexer::reinterpret_pointer_cast<FtCtx>(ctx);
+				ft_ctx_->SetMaxResults(ftMaxResults);
+			}
 
 			if (index->Opts().GetCollateMode() == CollateUTF8 || fullText)
 				for (auto &key : qe.values) key.EnsureUTF8();
@@ -534,7 +563,8 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 		start = sctx.query.start;
 		count = sctx.query.count;
 	}
-	auto aggregators = getAggregators(sctx.query);
+	// All aggregations are already calculated from indexes, so there are nothing to do in loop
+	if (!ctx.aggregators.empty() && ctx.loopAggregators.empty()) count = 0;
 	// do not calc total by loop, if we have only 1 condition with 1 idset
 	bool calcTotal = ctx.calcTotal && (ctx.qres->size() > 1 || hasComparators || (*ctx.qres)[0].size() > 1);
 
@@ -577,6 +607,19 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 	assert(!firstSortIndex || firstSortIndex->IsOrdered());
 	auto &first = *ctx.qres->begin();
 	IdType rowId = first.Val();
+	if (sctx.cursor && sctx.cursor->pos_ >= 0) {
+		IdType pos = sctx.cursor->pos_;
+		if (firstSortIndex) {
+			// Sort orders could be rebuilt by modification of namespace, so position is synchronized by last returned item
+			const auto &sortOrders = firstSortIndex->SortOrders();
+			if (size_t(pos) >= sortOrders.size() || sortOrders[pos] != sctx.cursor->rowId_) {
+				auto it = std::find(sortOrders.begin(), sortOrders.end(), sctx.cursor->rowId_);
+				if (it != sortOrders.end()) pos = IdType(it - sortOrders.begin());
+			}
+		}
+		// Next item is the first one after last returned
+		rowId = reverse ? pos - 1 : pos + 1;
+	}
 	while (first.Next(rowId) && !finish) {
 		rowId = first.Val();
 		IdType properRowId = rowId;
@@ -688,7 +731,7 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 					}
 				}
 				if (!multisortFinished) {
-					addSelectResult(firstSortIndex, hasComparators, proc, rowId, properRowId, sctx, aggregators, result);
+					addSelectResult(firstSortIndex, hasComparators, proc, rowId, properRowId, ctx, result);
 				}
 				if (lastResSize < result.Count()) {
 					if (start) {
@@ -701,7 +744,11 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 			if (start) {
 				--start;
 			} else if (count) {
-				addSelectResult(firstSortIndex, hasComparators, proc, rowId, properRowId, sctx, aggregators, result);
+				addSelectResult(firstSortIndex, hasComparators, proc, rowId, properRowId, ctx, result);
+				if (sctx.cursor) {
+					sctx.cursor->pos_ = rowId;
+					sctx.cursor->rowId_ = properRowId;
+				}
 				--count;
 				if (!count && multiSort && !multisortFinished) getSortIndexValue(sortCtx, properRowId, prevValues);
 			}
@@ -728,7 +775,7 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 		setLimitAndOffset(result.Items(), offset, sctx.query.count);
 	}
 
-	for (auto &aggregator : aggregators) {
+	for (auto &aggregator : ctx.aggregators) {
 		result.aggregationResults.push_back(aggregator.GetResult());
 	}
 
@@ -751,14 +798,15 @@ void NsSelecter::getSortIndexValue(const SelectCtx::SortingCtx::Entry *sortCtx,
 	}
 }
 
-void NsSelecter::addSelectResult(Index *firstSortIndex, bool hasComparators, uint8_t proc, IdType rowId, IdType &properRowId,
-								 const SelectCtx &sctx, h_vector<Aggregator, 4> &aggregators, QueryResults &result) {
+void NsSelecter::addSelectResult(Index *firstSortIndex, bool hasComparators, uint8_t proc, IdType rowId, IdType &properRowId, LoopCtx &ctx,
+								 QueryResults &result) {
+	const SelectCtx &sctx = ctx.sctx;
 	if (!hasComparators && firstSortIndex) {
 		assert(firstSortIndex->SortOrders().size() > static_cast<size_t>(rowId));
 		properRowId = firstSortIndex->SortOrders()[rowId];
 	}
-	if (aggregators.size()) {
-		for (auto &aggregator : aggregators) aggregator.Aggregate(ns_->items_[properRowId], properRowId);
+	if (ctx.aggregators.size()) {
+		for (auto aggregator : ctx.loopAggregators) aggregator->Aggregate(ns_->items_[properRowId]);
 	} else if (sctx.preResult && sctx.preResult->mode == SelectCtx::PreResult::ModeBuild) {
 		sctx.preResult->ids.Add(rowId, IdSet::Unordered);
 	} else {
@@ -770,14 +818,129 @@ h_vector<Aggregator, 4> NsSelecter::getAggregators(const Query &q) {
 	h_vector<Aggregator, 4> ret;
 
 	for (auto &ag : q.aggregations_) {
-		int idx = ns_->getIndexByName(ag.index_);
-		ret.push_back(Aggregator(ns_->indexes_[idx]->KeyType(), ns_->indexes_[idx]->Opts().IsArray(), nullptr, ag.type_));
-		ret.back().Bind(ns_->payloadType_, idx);
+		if (ag.fields_.empty()) throw Error(errQueryExec, "Empty set of fields for aggregation");
+		FieldsSet fields;
+		for (auto &name : ag.fields_) {
+			int idx = -1;
+			if (!ns_->getIndexByName(name, idx)) throw Error(errQueryExec, "Aggregation can be applied only to indexed field '%s'", name.c_str());
+			if (idx >= ns_->payloadType_.NumFields()) {
+				throw Error(errQueryExec, "Aggregation can't be applied to sparse or composite index '%s'", name.c_str());
+			}
+			fields.push_back(idx);
+		}
+		ret.push_back(Aggregator(ns_->payloadType_, fields, ag.type_, ag.fields_));
 	}
 
 	return ret;
 }
 
+bool NsSelecter::canAggregateByIndex(const Aggregator &aggregator, const SelectCtx &ctx, const QueryEntries &whereEntries) {
+	// Keys of index contain values of all items of namespace, so they can be used only if query does not filter items at all
+	if (!whereEntries.empty() || ctx.preResult || (ctx.joinedSelectors && !ctx.joinedSelectors->empty())) return false;
+	if (!ctx.isForceAll && (ctx.query.start != 0 || ctx.query.count != UINT_MAX)) return false;
+	if (aggregator.Fields().size() != 1) return false;
+	const Index &index = *ns_->indexes_[aggregator.Fields()[0]];
+	if (isFullText(index.Type())) return false;
+	// Keys, which are equal by collation, are merged by index, while select loop aggregates their values separately
+	if (index.Opts().GetCollateMode() != CollateNone) return false;
+	switch (aggregator.Type()) {
+		case AggFacet:
+		case AggCount:
+		case AggCountDistinct:
+		case AggCountDistinctApprox:
+			return true;
+		case AggSum:
+		case AggAvg:
+		case AggMin:
+		case AggMax:
+			// Item with array field is present in idsets of several keys, and each key is accounted only once per item
+			return !index.Opts().IsArray();
+		default:
+			return false;
+	}
+}
+
+void NsSelecter::aggregateByIndexes(LoopCtx &ctx, const QueryEntries &whereEntries) {
+	for (auto &aggregator : ctx.aggregators) {
+		bool done = false;
+		if (canAggregateByIndex(aggregator, ctx.sctx, whereEntries)) {
+			if (aggregator.Type() == AggCount) {
+				aggregator.AggregateCount(ns_->items_.size() - ns_->free_.size());
+				done = true;
+			} else {
+				done = ns_->indexes_[aggregator.Fields()[0]]->ForEachKey(
+					[&aggregator](const KeyRef &key, const IdSetRef &ids) { aggregator.AggregateKey(key, ids.size()); });
+			}
+		}
+		if (!done) ctx.loopAggregators.push_back(&aggregator);
+	}
+}
+
+bool NsSelecter::canCountByIdsets(const LoopCtx &ctx, bool hasComparators, bool hasScan) {
+	const SelectCtx &sctx = ctx.sctx;
+	if (hasComparators || hasScan || ctx.ftIndex) return false;
+	if ((sctx.preResult && sctx.preResult->mode == SelectCtx::PreResult::ModeBuild) || (sctx.joinedSelectors && sctx.joinedSelectors->size())) {
+		return false;
+	}
+	for (auto &r : *ctx.qres) {
+		if (r.op != OpAnd || r.distinct) return false;
+	}
+	if (ctx.aggregators.empty()) {
+		// Items are requested - so they have to be fetched by select loop
+		if (!sctx.isForceAll && sctx.query.count == 0) return ctx.calcTotal;
+		return false;
+	}
+	for (auto aggregator : ctx.loopAggregators) {
+		if (aggregator->Type() != AggCount) return false;
+	}
+	return true;
+}
+
+size_t NsSelecter::countByIdsets(RawQueryResult &qres) {
+	// Single idset contains each item only once
+	if (qres.size() == 1 && qres[0].size() == 1) return qres[0].GetMaxIterations();
+
+	// Results are sorted by cost, so the 1st one is the smallest idset. Leapfrog by rest of idsets
+	for (auto &r : qres) r.Start(false);
+	auto &first = qres[0];
+	size_t matched = 0;
+	IdType hint = first.Val();
+	while (first.Next(hint)) {
+		IdType rowId = first.Val();
+		hint = rowId;
+		bool found = true;
+		for (auto cur = qres.begin() + 1; cur != qres.end(); cur++) {
+			while (cur->Val() < rowId && cur->Next(rowId)) {
+			}
+			if (cur->End()) return matched;
+			if (cur->Val() > rowId) {
+				hint = cur->Val();
+				found = false;
+				break;
+			}
+		}
+		if (found) matched++;
+	}
+	return matched;
+}
+
+void NsSelecter::countLoop(LoopCtx &ctx, QueryResults &result) {
+	SelectCtx &sctx = ctx.sctx;
+	size_t matched = countByIdsets(*ctx.qres);
+	if (matched) sctx.matchedAtLeastOnce = true;
+
+	// Aggregations are calculated only by items in query's limit/offset window
+	size_t start = sctx.isForceAll ? 0 : sctx.query.start;
+	size_t count = sctx.isForceAll ? UINT_MAX : sctx.query.count;
+	size_t aggregated = matched > start ? std::min(matched - start, count) : 0;
+	for (auto aggregator : ctx.loopAggregators) aggregator->AggregateCount(aggregated);
+	for (auto &aggregator : ctx.aggregators) {
+		result.aggregationResults.push_back(aggregator.GetResult());
+	}
+
+	if (ctx.calcTotal) result.totalCount = matched;
+}
+
 void NsSelecter::substituteCompositeIndexes(QueryEntries &entries) {
 	FieldsSet fields;
 	for (auto cur = entries.begin(), first = entries.begin(); cur != entries.end(); cur++) {
@@ -4,6 +4,7 @@
 #include "core/nsselecter/selectiterator.h"
 #include "core/query/query.h"
 #include "core/query/queryresults.h"
+#include "core/query/selectcursor.h"
 #include "core/selectfunc/ctx/basefunctionctx.h"
 #include "core/selectfunc/ctx/ftctx.h"
 #include "core/selectfunc/selectfunc.h"
@@ -63,6 +64,8 @@ struct SelectCtx {
 	bool reqMatchedOnceFlag = false;
 	PreResult::Ptr preResult;
 	SortingCtx sortingCtx;
+	// Select loop is continued from position of cursor, and position of last selected item is saved to it
+	SelectCursor *cursor = nullptr;
 };
 
 class NsSelecter {
@@ -81,6 +84,9 @@ private:
 		bool calcTotal = false;
 		int sortingCtxIdx = IndexValueType::NotSet;
 		SelectCtx &sctx;
+		h_vector<Aggregator, 4> aggregators;
+		// Aggregators, which have to be calculated in select loop. Rest of aggregators are calculated from index keys
+		h_vector<Aggregator *, 4> loopAggregators;
 	};
 
 	template <bool reverse, bool haveComparators, bool haveDistinct>
@@ -92,13 +98,19 @@ private:
 	void applyGeneralSort(ConstItemIterator itFirst, ConstItemIterator itLast, ConstItemIterator itEnd, const SelectCtx &ctx);
 
 	bool containsFullTextIndexes(const QueryEntries &entries);
-	void selectWhere(const QueryEntries &entries, RawQueryResult &result, SortType sortId, bool is_ft);
-	void addSelectResult(Index *firstSortIdx, bool hasComparators, uint8_t proc, IdType rowId, IdType &properRowId, const SelectCtx &sctx,
-						 h_vector<Aggregator, 4> &aggregators, QueryResults &result);
+	void selectWhere(const QueryEntries &entries, RawQueryResult &result, SortType sortId, bool is_ft, size_t ftMaxResults);
+	void addSelectResult(Index *firstSortIdx, bool hasComparators, uint8_t proc, IdType rowId, IdType &properRowId, LoopCtx &ctx,
+						 QueryResults &result);
 	QueryEntries lookupQueryIndexes(const QueryEntries &entries);
 	void substituteCompositeIndexes(QueryEntries &entries);
 	SortingEntries getOptimalSortOrder(const QueryEntries &entries);
 	h_vector<Aggregator, 4> getAggregators(const Query &q);
+	bool canAggregateByIndex(const Aggregator &aggregator, const SelectCtx &ctx, const QueryEntries &whereEntries);
+	void aggregateByIndexes(LoopCtx &ctx, const QueryEntries &whereEntries);
+	// Count of matched items by intersection of idsets, without access to items payloads
+	bool canCountByIdsets(const LoopCtx &ctx, bool hasComparators, bool hasScan);
+	size_t countByIdsets(RawQueryResult &qres);
+	void countLoop(LoopCtx &ctx, QueryResults &result);
 	int getCompositeIndex(const FieldsSet &fieldsmask);
 	bool mergeQueryEntries(QueryEntry *lhs, QueryEntry *rhs);
 	void setLimitAndOffset(ItemRefVector &result, size_t offset, size_t limit);
@@ -115,7 +115,7 @@ bool SelectIterator::nextFwdSingleIdset(IdType minHint) {
 
 	auto it = begin();
 	if (it->bsearch_) {
-		if (it->it_ != it->end_ && *it->it_ <= lastVal_) it->it_ = std::lower_bound(it->it_ + 1, it->end_, lastVal_);
+		if (it->it_ != it->end_ && *it->it_ <= lastVal_) it->it_ = std::upper_bound(it->it_ + 1, it->end_, lastVal_);
 	} else
 		for (; it->it_ != it->end_ && *it->it_ <= lastVal_; it->it_++) {
 		}
@@ -0,0 +1,127 @@
+#include "core/query/aggregationresult.h"
+#include <string.h>
+#include "core/cjson/msgpackencoder.h"
+#include "gason/gason.h"
+#include "tools/jsontools.h"
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+static const struct {
+	AggType type;
+	string_view name;
+} aggTypeNames[] = {{AggSum, "sum"_sv},	  {AggAvg, "avg"_sv},	  {AggFacet, "facet"_sv},
+					{AggMin, "min"_sv},	  {AggMax, "max"_sv},	  {AggCount, "count"_sv},
+					{AggCountDistinct, "count_distinct"_sv}, {AggCountDistinctApprox, "count_distinct_approx"_sv}};
+
+string_view AggregationResult::TypeToStr(AggType type) {
+	for (auto &t : aggTypeNames) {
+		if (t.type == type) return t.name;
+	}
+	return "?"_sv;
+}
+
+AggType AggregationResult::StrToType(string_view type) {
+	for (auto &t : aggTypeNames) {
+		if (t.name == type) return t.type;
+	}
+	throw Error(errParams, "Unknown aggregation type '%s'", type.ToString().c_str());
+}
+
+Error AggregationResult::FromJSON(char *json) {
+	JsonAllocator jalloc;
+	JsonValue jvalue;
+	char *endp;
+
+	int status = jsonParse(json, &endp, &jvalue, jalloc);
+	if (status != JSON_OK) {
+		return Error(errParseJson, "Malformed JSON with aggregation results");
+	}
+	return FromJSON(jvalue);
+}
+
+Error AggregationResult::FromJSON(JsonValue &jvalue) {
+	try {
+		if (jvalue.getTag() != JSON_OBJECT) throw Error(errParseJson, "Expected json object");
+		for (auto elem : jvalue) {
+			if (elem->value.getTag() == JSON_NULL) continue;
+			parseJsonField("value", value, elem, -std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+			if (!strcmp("type", elem->key)) {
+				string typeName;
+				parseJsonField("type", typeName, elem);
+				type = StrToType(typeName);
+			} else if (!strcmp("fields", elem->key)) {
+				if (elem->value.getTag() != JSON_ARRAY) throw Error(errParseJson, "Expected array in 'fields' field");
+				for (auto field : elem->value) fields.push_back(field->value.toString());
+			} else if (!strcmp("facets", elem->key)) {
+				if (elem->value.getTag() != JSON_ARRAY) throw Error(errParseJson, "Expected array in 'facets' field");
+				for (auto facetElem : elem->value) {
+					FacetResult facet;
+					for (auto subElem : facetElem->value) {
+						parseJsonField("count", facet.count, subElem, 0, std::numeric_limits<int>::max());
+						if (!strcmp("values", subElem->key)) {
+							for (auto v : subElem->value) facet.values.push_back(v->value.toString());
+						}
+					}
+					facets.push_back(std::move(facet));
+				}
+			}
+		}
+	} catch (const Error &err) {
+		return err;
+	}
+	return 0;
+}
+
+void AggregationResult::GetJSON(WrSerializer &ser) const {
+	ser.PutChars("{\"type\":");
+	ser.PrintJsonString(TypeToStr(type));
+	ser.PutChars(",\"fields\":[");
+	for (size_t i = 0; i < fields.size(); i++) {
+		if (i != 0) ser.PutChar(',');
+		ser.PrintJsonString(fields[i]);
+	}
+	ser.PutChar(']');
+	if (type == AggFacet) {
+		ser.PutChars(",\"facets\":[");
+		for (size_t i = 0; i < facets.size(); i++) {
+			if (i != 0) ser.PutChar(',');
+			ser.PutChars("{\"values\":[");
+			for (size_t j = 0; j < facets[i].values.size(); j++) {
+				if (j != 0) ser.PutChar(',');
+				ser.PrintJsonString(facets[i].values[j]);
+			}
+			ser.Printf("],\"count\":%d}", facets[i].count);
+		}
+		ser.PutChar(']');
+	} else {
+		ser.Printf(",\"value\":%.20g", value);
+	}
+	ser.PutChar('}');
+}
+
+void AggregationResult::GetMsgPack(WrSerializer &ser) const {
+	msgpack::putMap(ser, 3);
+	msgpack::putString(ser, "type"_sv);
+	msgpack::putString(ser, TypeToStr(type));
+	msgpack::putString(ser, "fields"_sv);
+	msgpack::putArray(ser, fields.size());
+	for (auto &field : fields) msgpack::putString(ser, field);
+	if (type == AggFacet) {
+		msgpack::putString(ser, "facets"_sv);
+		msgpack::putArray(ser, facets.size());
+		for (auto &facet : facets) {
+			msgpack::putMap(ser, 2);
+			msgpack::putString(ser, "values"_sv);
+			msgpack::putArray(ser, facet.values.size());
+			for (auto &v : facet.values) msgpack::putString(ser, v);
+			msgpack::putString(ser, "count"_sv);
+			msgpack::putInt(ser, facet.count);
+		}
+	} else {
+		msgpack::putString(ser, "value"_sv);
+		msgpack::putDouble(ser, value);
+	}
+}
+
+}  // namespace reindexer
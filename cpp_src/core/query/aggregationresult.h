@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "core/type_consts.h"
+#include "estl/h_vector.h"
+#include "estl/string_view.h"
+#include "tools/errors.h"
+
+union JsonValue;
+
+namespace reindexer {
+
+using std::string;
+using std::vector;
+
+class WrSerializer;
+
+struct FacetResult {
+	FacetResult(const h_vector<string, 1> &v, int c) : values(v), count(c) {}
+	FacetResult() {}
+	h_vector<string, 1> values;
+	int count = 0;
+};
+
+struct AggregationResult {
+	Error FromJSON(char *json);
+	Error FromJSON(JsonValue &jvalue);
+	void GetJSON(WrSerializer &ser) const;
+	void GetMsgPack(WrSerializer &ser) const;
+
+	static string_view TypeToStr(AggType type);
+	static AggType StrToType(string_view type);
+
+	AggType type = AggSum;
+	h_vector<string, 1> fields;
+	double value = 0;
+	vector<FacetResult> facets;
+};
+
+}  // namespace reindexer
@@ -61,8 +61,12 @@ const unordered_map<OpType, string, EnumClassHash> op_map = {{OpOr, "or"}, {OpAn
 const unordered_map<CalcTotalMode, string, EnumClassHash> reqtotal_values = {
 	{ModeNoTotal, "disabled"}, {ModeAccurateTotal, "enabled"}, {ModeCachedTotal, "cached"}};
 
-const unordered_map<Aggregation, string, EnumClassHash> aggregation_map = {{Aggregation::Field, "field"}, {Aggregation::Type, "type"}};
-const unordered_map<AggType, string, EnumClassHash> aggregation_types = {{AggSum, "sum"}, {AggAvg, "avg"}};
+const unordered_map<Aggregation, string, EnumClassHash> aggregation_map = {
+	{Aggregation::Field, "field"}, {Aggregation::Fields, "fields"}, {Aggregation::Type, "type"}};
+const unordered_map<AggType, string, EnumClassHash> aggregation_types = {{AggSum, "sum"},	 {AggAvg, "avg"},	 {AggFacet, "facet"},
+																		  {AggMin, "min"},	 {AggMax, "max"},	 {AggCount, "count"},
+																		  {AggCountDistinct, "count_distinct"},
+																		  {AggCountDistinctApprox, "count_distinct_approx"}};
 
 template <typename T>
 string get(unordered_map<T, string, EnumClassHash> const& m, const T& key) {
@@ -269,7 +273,12 @@ void encodeAggregationFunctions(const Query& query, string& dsl) {
 	for (size_t i = 0; i < query.aggregations_.size(); i++) {
 		const AggregateEntry& entry(query.aggregations_[i]);
 		dsl += leftBracket;
-		encodeStringField(get(aggregation_map, Aggregation::Field), entry.index_, dsl);
+		if (entry.fields_.size() == 1) {
+			encodeStringField(get(aggregation_map, Aggregation::Field), entry.fields_[0], dsl);
+		} else {
+			encodeNodeName(get(aggregation_map, Aggregation::Fields), dsl);
+			encodeStringArray(entry.fields_, dsl);
+		}
 		addComa(dsl);
 		encodeStringField(get(aggregation_map, Aggregation::Type), get(aggregation_types, entry.type_), dsl);
 		dsl += rightBracket;
@@ -62,8 +62,12 @@ static const fast_hash_map<string, CalcTotalMode> reqtotal_values = {
 
 // additional for 'Root::Aggregations' field
 
-static const fast_hash_map<string, Aggregation> aggregation_map = {{"field", Aggregation::Field}, {"type", Aggregation::Type}};
-static const fast_hash_map<string, AggType> aggregation_types = {{"sum", AggSum}, {"avg", AggAvg}};
+static const fast_hash_map<string, Aggregation> aggregation_map = {
+	{"field", Aggregation::Field}, {"fields", Aggregation::Fields}, {"type", Aggregation::Type}};
+static const fast_hash_map<string, AggType> aggregation_types = {{"sum", AggSum},	 {"avg", AggAvg},	 {"facet", AggFacet},
+																 {"min", AggMin},	 {"max", AggMax},	 {"count", AggCount},
+																 {"count_distinct", AggCountDistinct},
+																 {"count_distinct_approx", AggCountDistinctApprox}};
 
 void checkJsonValueType(JsonValue& val, const string& name, JsonTag expectedType) {
 	if (val.getTag() != expectedType) throw Error(errParseJson, "Wrong type of field '%s'", name.c_str());
@@ -296,7 +300,11 @@ void parseAggregation(JsonValue& aggregation, Query& query) {
 		switch (get(aggregation_map, name)) {
 			case Aggregation::Field:
 				checkJsonValueType(value, name, JSON_STRING);
-				aggEntry.index_ = value.toString();
+				aggEntry.fields_.push_back(value.toString());
+				break;
+			case Aggregation::Fields:
+				checkJsonValueType(value, name, JSON_ARRAY);
+				parseStringArray(value, aggEntry.fields_);
 				break;
 			case Aggregation::Type:
 				checkJsonValueType(value, name, JSON_STRING);
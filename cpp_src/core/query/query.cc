@@ -78,9 +78,14 @@ void Query::deserialize(Serializer &ser) {
 				entries.push_back(std::move(qe));
 				break;
 			}
-			case QueryAggregation:
-				aggregations_.push_back({ser.GetVString().ToString(), AggType(ser.GetVarUint())});
+			case QueryAggregation: {
+				AggregateEntry ae;
+				ae.type_ = AggType(ser.GetVarUint());
+				int fieldsCount = ser.GetVarUint();
+				while (fieldsCount--) ae.fields_.push_back(ser.GetVString().ToString());
+				aggregations_.push_back(std::move(ae));
 				break;
+			}
 			case QueryDistinct:
 				qe.index = ser.GetVString().ToString();
 				qe.distinct = true;
@@ -156,21 +161,44 @@ int Query::selectParse(tokenizer &parser) {
 		tok = parser.peek_token();
 		if (tok.text() == "("_sv) {
 			parser.next_token();
-			tok = parser.next_token();
+			AggregateEntry entry;
 			if (name.text() == "avg"_sv) {
-				aggregations_.push_back({tok.text().ToString(), AggAvg});
+				entry.type_ = AggAvg;
 			} else if (name.text() == "sum"_sv) {
-				aggregations_.push_back({tok.text().ToString(), AggSum});
-			} else if (name.text() == "count"_sv) {
-				calcTotal = ModeAccurateTotal;
-				count = 0;
-			} else {
+				entry.type_ = AggSum;
+			} else if (name.text() == "min"_sv) {
+				entry.type_ = AggMin;
+			} else if (name.text() == "max"_sv) {
+				entry.type_ = AggMax;
+			} else if (name.text() == "facet"_sv) {
+				entry.type_ = AggFacet;
+			} else if (name.text() == "count_distinct"_sv) {
+				entry.type_ = AggCountDistinct;
+			} else if (name.text() == "count_distinct_approx"_sv) {
+				entry.type_ = AggCountDistinctApprox;
+			} else if (name.text() != "count"_sv) {
 				throw Error(errParams, "Unknown function name SQL - %s, %s", name.text().data(), parser.where().c_str());
 			}
-			tok = parser.next_token();
+			for (;;) {
+				tok = parser.next_token(false);
+				entry.fields_.push_back(tok.text().ToString());
+				tok = parser.next_token();
+				if (tok.text() != ","_sv) break;
+			}
 			if (tok.text() != ")"_sv) {
 				throw Error(errParams, "Expected ')', but found %s, %s", tok.text().data(), parser.where().c_str());
 			}
+			if (name.text() == "count"_sv) {
+				if (entry.fields_.size() == 1 && entry.fields_[0] == "*") {
+					calcTotal = ModeAccurateTotal;
+					count = 0;
+				} else {
+					entry.type_ = AggCount;
+					aggregations_.push_back(std::move(entry));
+				}
+			} else {
+				aggregations_.push_back(std::move(entry));
+			}
 			tok = parser.peek_token();
 
 		} else if (name.text() != "*"_sv) {
@@ -409,8 +437,9 @@ void Query::Serialize(WrSerializer &ser, uint8_t mode) const {
 
 	for (auto &agg : aggregations_) {
 		ser.PutVarUint(QueryAggregation);
-		ser.PutVString(agg.index_);
 		ser.PutVarUint(agg.type_);
+		ser.PutVarUint(agg.fields_.size());
+		for (auto &field : agg.fields_) ser.PutVString(field);
 	}
 
 	for (const SortingEntry &sortginEntry : sortingEntries_) {
@@ -583,11 +612,33 @@ string Query::Dump(bool stripArgs) const {
 				case AggSum:
 					filt += "SUM(";
 					break;
+				case AggFacet:
+					filt += "FACET(";
+					break;
+				case AggMin:
+					filt += "MIN(";
+					break;
+				case AggMax:
+					filt += "MAX(";
+					break;
+				case AggCount:
+					filt += "COUNT(";
+					break;
+				case AggCountDistinct:
+					filt += "COUNT_DISTINCT(";
+					break;
+				case AggCountDistinctApprox:
+					filt += "COUNT_DISTINCT_APPROX(";
+					break;
 				default:
 					filt += "<?> (";
 					break;
 			}
-			filt += a.index_ + ")";
+			for (auto &f : a.fields_) {
+				if (&f != &*a.fields_.begin()) filt += ",";
+				filt += f;
+			}
+			filt += ")";
 		}
 	} else if (selectFilter_.size()) {
 		for (auto &f : selectFilter_) {
@@ -237,10 +237,26 @@ public:
 	/// Adds an aggregate function for certain column.
 	/// Analog to sql aggregate functions (min, max, avg, etc).
 	/// @param idx - name of the field to be aggregated.
-	/// @param type - aggregation function type (Sum, Avg).
+	/// @param type - aggregation function type (Sum, Avg, Min, Max, Count, CountDistinct, CountDistinctApprox, Facet).
 	/// @return Query object ready to be executed.
 	Query &Aggregate(const string &idx, AggType type) {
-		aggregations_.push_back({idx, type});
+		AggregateEntry entry;
+		entry.fields_.push_back(idx);
+		entry.type_ = type;
+		aggregations_.push_back(std::move(entry));
+		return *this;
+	}
+
+	/// Adds an aggregate function for several columns.
+	/// Facet on several columns counts items for each distinct combination of values (analog to sql GROUP BY ... COUNT(*)).
+	/// @param fields - names of the fields to be aggregated.
+	/// @param type - aggregation function type (Facet, CountDistinct, CountDistinctApprox).
+	/// @return Query object ready to be executed.
+	Query &Aggregate(std::initializer_list<string> fields, AggType type) {
+		AggregateEntry entry;
+		entry.fields_.assign(fields.begin(), fields.end());
+		entry.type_ = type;
+		aggregations_.push_back(std::move(entry));
 		return *this;
 	}
 
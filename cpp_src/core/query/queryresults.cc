@@ -2,6 +2,7 @@
 #include "core/cjson/cjsonencoder.h"
 #include "core/cjson/jsonencoder.h"
 #include "core/cjson/jsonprintfilter.h"
+#include "core/cjson/msgpackencoder.h"
 #include "tools/logger.h"
 
 namespace reindexer {
@@ -177,6 +178,25 @@ void QueryResults::Iterator::GetJSON(WrSerializer &ser, bool withHdrLen) {
 	}
 }
 
+void QueryResults::encodeMsgPack(int idx, WrSerializer &ser) const {
+	auto &itemRef = items_[idx];
+	assert(ctxs.size() > itemRef.nsid);
+	auto &ctx = ctxs[itemRef.nsid];
+
+	ConstPayload pl(ctx.type_, itemRef.value);
+	MsgPackEncoder encoder(ctx.tagsMatcher_, ctx.jsonFilter_);
+	const QRVector &itJoined = (begin() + idx).GetJoined();
+
+	if (!itJoined.empty()) {
+		JsonEncoderDatasourceWithJoins ds(itJoined, ctxs);
+		encoder.Encode(&pl, ser, &ds);
+		return;
+	}
+	encoder.Encode(&pl, ser);
+}
+
+void QueryResults::Iterator::GetMsgPack(WrSerializer &ser) { qr_->encodeMsgPack(idx_, ser); }
+
 void QueryResults::Iterator::GetCJSON(WrSerializer &ser, bool withHdrLen) {
 	auto &itemRef = qr_->items_[idx_];
 	assert(qr_->ctxs.size() > itemRef.nsid);
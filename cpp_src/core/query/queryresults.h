@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include "core/item.h"
 #include "core/itemimpl.h"
+#include "core/query/aggregationresult.h"
 #include "estl/h_vector.h"
 
 namespace reindexer {
@@ -56,6 +57,7 @@ public:
 	public:
 		void GetJSON(WrSerializer &wrser, bool withHdrLen = true);
 		void GetCJSON(WrSerializer &wrser, bool withHdrLen = true);
+		void GetMsgPack(WrSerializer &wrser);
 		Item GetItem();
 		const QRVector &GetJoined();
 		const ItemRef &GetItemRef() const { return qr_->items_[idx_]; }
@@ -89,7 +91,7 @@ public:
 
 	// joinded fields 0 - 1st joined ns, 1 - second joined
 	vector<nc_map<IdType, QRVector>> joined_;  // joinded items
-	h_vector<double> aggregationResults;
+	vector<AggregationResult> aggregationResults;
 	int totalCount = 0;
 	bool haveProcent = false;
 	bool nonCacheableData = false;
@@ -116,6 +118,7 @@ protected:
 private:
 	void unlockResults();
 	void encodeJSON(int idx, WrSerializer &ser) const;
+	void encodeMsgPack(int idx, WrSerializer &ser) const;
 	bool lockedResults_ = false;
 	ItemRefVector items_;
 };
@@ -28,7 +28,7 @@ bool QueryJoinEntry::operator==(const QueryJoinEntry &obj) const {
 }
 
 bool AggregateEntry::operator==(const AggregateEntry &obj) const {
-	if (index_ != obj.index_) return false;
+	if (fields_ != obj.fields_) return false;
 	if (type_ != obj.type_) return false;
 	return true;
 }
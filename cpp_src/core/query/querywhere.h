@@ -48,7 +48,7 @@ struct QueryEntries : public h_vector<QueryEntry, 4> {};
 struct AggregateEntry {
 	bool operator==(const AggregateEntry &) const;
 	bool operator!=(const AggregateEntry &) const;
-	string index_;
+	h_vector<string, 1> fields_;
 	AggType type_;
 };
 
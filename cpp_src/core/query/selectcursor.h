@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stddef.h>
+#include "core/type_consts.h"
+
+namespace reindexer {
+
+/// Position of query, which is selected by batches (see Reindexer::SelectBatch).
+/// Next batch is selected by continuation of select loop from the position, where previous batch was finished.
+/// Items, which are inserted or deleted by concurrent modifications, can be missed by next batches
+class SelectCursor {
+public:
+	/// All results are selected
+	bool Done() const { return done_; }
+	/// Results are selected by batches. If false, query could not be continued, and all its results were returned by first batch
+	bool Streamed() const { return streamed_; }
+	/// Number of items, returned by previous batches
+	size_t Returned() const { return returned_; }
+
+protected:
+	friend class ReindexerImpl;
+	friend class NsSelecter;
+
+	// Position of last returned item in select loop: row id, or position in sort order of sorting index. -1 before first batch
+	IdType pos_ = -1;
+	// Row id of last returned item. Position is found by it, if sort orders were rebuilt by modification of namespace
+	IdType rowId_ = -1;
+	size_t returned_ = 0;
+	bool started_ = false;
+	bool done_ = false;
+	bool streamed_ = true;
+};
+
+}  // namespace reindexer
@@ -28,6 +28,9 @@ Error Reindexer::EnumMeta(const string& _namespace, vector<string>& keys) { retu
 Error Reindexer::Delete(const Query& q, QueryResults& result) { return impl_->Delete(q, result); }
 Error Reindexer::Select(const string& query, QueryResults& result) { return impl_->Select(query, result); }
 Error Reindexer::Select(const Query& q, QueryResults& result) { return impl_->Select(q, result); }
+Error Reindexer::SelectBatch(const Query& q, QueryResults& result, SelectCursor& cursor, unsigned batchSize) {
+	return impl_->SelectBatch(q, result, cursor, batchSize);
+}
 Error Reindexer::Commit(const string& _namespace) { return impl_->Commit(_namespace); }
 Error Reindexer::ConfigureIndex(const string& _namespace, const string& index, const string& config) {
 	return impl_->ConfigureIndex(_namespace, index, config);
@@ -3,6 +3,7 @@
 #include "core/namespacedef.h"
 #include "core/query/query.h"
 #include "core/query/queryresults.h"
+#include "core/query/selectcursor.h"
 
 namespace reindexer {
 using std::vector;
@@ -103,6 +104,13 @@ public:
 	/// @param query - Query object with query attributes
 	/// @param result - QueryResults with found items
 	Error Select(const Query &query, QueryResults &result);
+	/// Execute Query and return next batch of results. Namespace is not locked between batches
+	/// Query, which can't be selected by batches (with joins, aggregations, total count, etc.), returns all results by first batch
+	/// @param query - Query object with query attributes. Must be the same for all batches of cursor
+	/// @param result - QueryResults with items of batch. Empty, if cursor is done
+	/// @param cursor - Position of query after previous batch
+	/// @param batchSize - Maximum number of items in batch
+	Error SelectBatch(const Query &query, QueryResults &result, SelectCursor &cursor, unsigned batchSize);
 	/// Flush changes to storage
 	/// @param nsName - Name of namespace
 	Error Commit(const string &nsName);
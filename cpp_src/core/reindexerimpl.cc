@@ -390,6 +390,72 @@ Error ReindexerImpl::Select(const Query& q, QueryResults& result) {
 	return errOK;
 }
 
+// Select loop can be continued by next batch, if it produces items in final order of results
+bool ReindexerImpl::canSelectBatches(const Query& q, Namespace& ns) {
+	if (!q.joinQueries_.empty() || !q.mergeQueries_.empty() || !q.aggregations_.empty() || !q.selectFunctions_.empty() ||
+		!q.forcedSortOrder.empty() || q.calcTotal != ModeNoTotal || q.sortingEntries_.size() > 1)
+		return false;
+	if (q._namespace.size() && q._namespace[0] == '#') return false;
+
+	int idx;
+	for (auto& entry : q.entries) {
+		if (entry.distinct) return false;
+		if (ns.getIndexByName(entry.index, idx) && isFullText(ns.indexes_[idx]->Type())) return false;
+	}
+	if (q.sortingEntries_.empty()) return true;
+	if (!ns.getIndexByName(q.sortingEntries_[0].column, idx)) return false;
+	return ns.indexes_[idx]->IsOrdered() && !ns.indexes_[idx]->Opts().IsSparse();
+}
+
+Error ReindexerImpl::SelectBatch(const Query& q, QueryResults& result, SelectCursor& cursor, unsigned batchSize) {
+	if (cursor.done_) return errOK;
+
+	try {
+		Namespace::Ptr ns = getNamespace(q._namespace);
+		if (!cursor.started_) {
+			bool canBatch;
+			{
+				smart_lock<shared_timed_mutex> lck(ns->mtx_, false);
+				canBatch = canSelectBatches(q, *ns);
+			}
+			if (!canBatch) {
+				cursor.started_ = cursor.done_ = true;
+				cursor.streamed_ = false;
+				Error err = Select(q, result);
+				cursor.returned_ = result.Count();
+				return err;
+			}
+		}
+
+		// Offset of query is applied by first batch only, limit - by all of them
+		Query bq(q);
+		bq.start = cursor.started_ ? 0 : q.start;
+		bq.count = std::min(size_t(batchSize), size_t(q.count) - cursor.returned_);
+		cursor.started_ = true;
+		if (!bq.count) {
+			cursor.done_ = true;
+			return errOK;
+		}
+
+		PerfStatCalculatorMT calc(ns->selectPerfCounter_, ns->enablePerfCounters_);
+		NsLocker locks;
+		locks.Add(ns);
+		locks.Lock();
+		calc.LockHit();
+
+		SelectCtx ctx(bq, &locks);
+		ctx.cursor = &cursor;
+		ns->Select(result, ctx);
+		result.lockResults();
+
+		cursor.returned_ += result.Count();
+		if (size_t(result.Count()) < bq.count) cursor.done_ = true;
+	} catch (const Error& err) {
+		return err;
+	}
+	return errOK;
+}
+
 JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResults& result, NsLocker& locks, h_vector<Query, 4>& queries,
 													  SelectFunctionsHolder& func) {
 	JoinedSelectors joinedSelectors;
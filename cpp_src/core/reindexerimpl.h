@@ -43,6 +43,7 @@ public:
 	Error Delete(const Query &query, QueryResults &result);
 	Error Select(const string &query, QueryResults &result);
 	Error Select(const Query &query, QueryResults &result);
+	Error SelectBatch(const Query &query, QueryResults &result, SelectCursor &cursor, unsigned batchSize);
 	Error Commit(const string &namespace_);
 	Item NewItem(const string &_namespace);
 	Error GetMeta(const string &_namespace, const string &key, string &data);
@@ -95,6 +96,7 @@ protected:
 		bool locked_ = false;
 		bool upgraded_ = false;
 	};
+	bool canSelectBatches(const Query &q, Namespace &ns);
 	void doSelect(const Query &q, QueryResults &res, NsLocker &locker, SelectFunctionsHolder &func);
 	JoinedSelectors prepareJoinedSelectors(const Query &q, QueryResults &result, NsLocker &locks, h_vector<Query, 4> &queries,
 										   SelectFunctionsHolder &func);
@@ -37,8 +37,13 @@ public:
 	void SetData(Data::Ptr data);
 	Data::Ptr GetData();
 
+	// Maximum count of the best ranked documents, which are needed for query result. 0 - all documents are needed
+	void SetMaxResults(size_t maxResults) { maxResults_ = maxResults; }
+	size_t MaxResults() const { return maxResults_; }
+
 private:
 	Data::Ptr data_;
+	size_t maxResults_ = 0;
 
 };  // namespace reindexer
 }  // namespace reindexer
@@ -27,29 +27,28 @@ bool Highlight::process(ItemRef &res, PayloadType &pl_type, const SelectFuncStru
 	if (!pva || pva->empty()) return false;
 	auto &va = *pva;
 
-	string result_string;
-	result_string.reserve(result_string.size() + va.size() * (func.funcArgs[0].size() + func.funcArgs[1].size()));
-	result_string = *data;
-
-	int offset = 0;
-
-	Word2PosHelper word2pos(*data, ftctx->GetData()->extraWordSymbols_);
-	for (auto area : va) {
-		std::pair<int, int> pos =
-			ftctx->GetData()->isWordPositions_ ? word2pos.convert(area.start_, area.end_) : std::make_pair(area.start_, area.end_);
-
-		// printf("%d(%d),%d(%d) %s\n", area.start_, pos.first, area.end_, pos.second, data->c_str());
-
-		result_string.insert(pos.first + offset, func.funcArgs[0]);
-		offset += func.funcArgs[0].size();
-
-		result_string.insert(pos.second + offset, func.funcArgs[1]);
-
-		offset += func.funcArgs[1].size();
+	result_.clear();
+	result_.reserve(data->size() + va.size() * (func.funcArgs[0].size() + func.funcArgs[1].size()));
+
+	// Areas are sorted and do not overlap, so result is built by appending text between them
+	bool isWordPositions = ftctx->GetData()->isWordPositions_;
+	if (isWordPositions) word2pos_.Reset(*data, ftctx->GetData()->extraWordSymbols_);
+	size_t pos = 0;
+	for (auto &area : va) {
+		std::pair<int, int> bounds = isWordPositions ? word2pos_.convert(area.start_, area.end_) : std::make_pair(area.start_, area.end_);
+		size_t start = std::min(std::max(size_t(bounds.first), pos), data->size());
+		size_t end = std::min(std::max(size_t(bounds.second), start), data->size());
+
+		result_.append(*data, pos, start - pos);
+		result_.append(func.funcArgs[0]);
+		result_.append(*data, start, end - start);
+		result_.append(func.funcArgs[1]);
+		pos = end;
 	}
+	if (pos < data->size()) result_.append(*data, pos, string::npos);
 
 	key_string_release(const_cast<string *>(data));
-	auto str = make_key_string(result_string);
+	auto str = make_key_string(string_view(result_));
 	key_string_add_ref(str.get());
 	res.value.AllocOrClone(0);
 
@@ -2,11 +2,17 @@
 #include "core/item.h"
 #include "core/query/queryresults.h"
 #include "core/selectfunc/selectfuncparser.h"
+#include "tools/stringstools.h"
 
 namespace reindexer {
 
 class Highlight {
 public:
-	static bool process(ItemRef &res, PayloadType &pl_type, const SelectFuncStruct &func);
+	bool process(ItemRef &res, PayloadType &pl_type, const SelectFuncStruct &func);
+
+protected:
+	// Buffers are reused for all the items of query results
+	Word2PosHelper word2pos_;
+	string result_;
 };
 }  // namespace reindexer
@@ -38,77 +38,52 @@ bool Snippet::process(ItemRef &res, PayloadType &pl_type, const SelectFuncStruct
 		throw Error(errParams, "Invalid snippet param front - %s is not a number", func.funcArgs[3].c_str());
 	}
 
-	AreaVec va = *pva;
-
+	areas_.clear();
 	if (ftctx->GetData()->isWordPositions_) {
-		Word2PosHelper word2pos(*data, ftctx->GetData()->extraWordSymbols_);
-		for (auto &a : va) {
-			auto pos = word2pos.convert(a.start_, a.end_);
-			a.start_ = pos.first;
-			a.end_ = pos.second;
+		word2pos_.Reset(*data, ftctx->GetData()->extraWordSymbols_);
+		for (auto &a : *pva) {
+			auto pos = word2pos_.convert(a.start_, a.end_);
+			areas_.push_back(Area(pos.first, pos.second));
 		}
+	} else {
+		areas_.insert(areas_.end(), pva->begin(), pva->end());
 	}
 
-	AreaVec sva(va);
-
-	for (auto &a : sva) {
+	// Windows of text around areas. Overlapped windows are merged
+	windows_.clear();
+	for (auto &area : areas_) {
+		Area a = area;
 		a.start_ -= calcUTf8SizeEnd(data->data() + a.start_, a.start_, back);
 		if (a.start_ < 0 || back < 0) a.start_ = 0;
 
 		a.end_ += calcUTf8Size(data->data() + a.end_, data->size() - a.end_, front);
 		if (size_t(a.end_) > data->size() || front < 0) a.end_ = int(data->size());
+		if (windows_.empty() || !windows_.back().Concat(a)) windows_.push_back(a);
 	}
-	if (!sva.empty()) {
-		for (auto vit = sva.begin() + 1; vit != sva.end(); ++vit) {
-			auto prev = vit - 1;
-			if (vit->Concat(*prev)) {
-				vit = sva.erase(prev);
-			}
-		}
-	}
-	int offset = 0;
-	int snippet_offset = 0;
 
-	int va_offset = 0;
-
-	string result_string;
-	result_string.reserve(data->size());
-	int cur_pos = 0;
-	for (auto &area : sva) {
-		offset = offset - (area.start_ - snippet_offset);
-		snippet_offset = area.end_;
-		cur_pos = result_string.size();
-		result_string.insert(result_string.end(), data->begin() + area.start_, data->begin() + area.end_);
-		for (; size_t(va_offset) < va.size(); ++va_offset) {
-			if (area.IsIn(va[va_offset].start_, true) || area.IsIn(va[va_offset].end_, true)) {
-				int start = va[va_offset].start_ + offset;
-				if (start < 0) start = 0;
-
-				result_string.insert(start, func.funcArgs[0]);
-				offset += func.funcArgs[0].size();
-				int end = va[va_offset].end_ + offset;
-				if (size_t(end) > result_string.size() - 1) end = result_string.size();
-				result_string.insert(end, func.funcArgs[1]);
-				offset += func.funcArgs[1].size();
-			} else {
-				break;
-			}
-		}
-		if (func.funcArgs.size() > 5) {
-			result_string.append(func.funcArgs[5]);
-			offset += func.funcArgs[5].size();
-		} else {
-			result_string.append(" ");
-			offset++;
-		}
-		if (func.funcArgs.size() > 4) {
-			result_string.insert(cur_pos, func.funcArgs[4]);
-			offset += func.funcArgs[4].size();
+	result_.clear();
+	result_.reserve(data->size());
+	size_t areaIdx = 0;
+	for (auto &window : windows_) {
+		if (func.funcArgs.size() > 4) result_.append(func.funcArgs[4]);
+		int pos = window.start_;
+		for (; areaIdx < areas_.size(); ++areaIdx) {
+			const Area &a = areas_[areaIdx];
+			if (!window.IsIn(a.start_, true) && !window.IsIn(a.end_, true)) break;
+			int start = std::max(a.start_, pos), end = std::max(std::min(a.end_, window.end_), start);
+
+			result_.append(*data, pos, start - pos);
+			result_.append(func.funcArgs[0]);
+			result_.append(*data, start, end - start);
+			result_.append(func.funcArgs[1]);
+			pos = end;
 		}
+		result_.append(*data, pos, window.end_ - pos);
+		result_.append(func.funcArgs.size() > 5 ? func.funcArgs[5] : " ");
 	}
 
 	key_string_release(const_cast<string *>(data));
-	auto str = make_key_string(result_string);
+	auto str = make_key_string(string_view(result_));
 	key_string_add_ref(str.get());
 	res.value.AllocOrClone(0);
 
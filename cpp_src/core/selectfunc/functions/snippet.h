@@ -1,12 +1,20 @@
 #pragma once
+#include "core/ft/areaholder.h"
 #include "core/item.h"
 #include "core/query/queryresults.h"
 #include "core/selectfunc/selectfuncparser.h"
+#include "tools/stringstools.h"
 
 namespace reindexer {
 
 class Snippet {
 public:
-	static bool process(ItemRef &res, PayloadType &pl_type, const SelectFuncStruct &func);
+	bool process(ItemRef &res, PayloadType &pl_type, const SelectFuncStruct &func);
+
+protected:
+	// Buffers are reused for all the items of query results
+	Word2PosHelper word2pos_;
+	AreaVec areas_, windows_;
+	string result_;
 };
 }  // namespace reindexer
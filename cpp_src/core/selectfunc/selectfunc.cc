@@ -3,8 +3,6 @@
 #include <memory>
 #include "core/namespacedef.h"
 #include "ctx/ftctx.h"
-#include "functions/highlight.h"
-#include "functions/snippet.h"
 
 namespace reindexer {
 using std::make_pair;
@@ -158,12 +156,17 @@ void SelectFunctionsHolder::Process(QueryResults &res) {
 	if (!querys_ || querys_->empty() || force_only_) return;
 	bool changed = false;
 
-	for (size_t i = 0; i < res.Count(); ++i) {
-		auto &pl_type = res.getPayloadType(res.Items()[i].nsid);
-		auto it = querys_->find(pl_type.Name());
-		if (it != querys_->end()) {
-			if (it->second->ProcessItem(res.Items()[i], pl_type)) changed = true;
+	// Items of the same namespace go in a row, so functions are looked up only on change of namespace
+	int nsid = -1;
+	SelectFunction *func = nullptr;
+	for (auto &item : res.Items()) {
+		auto &pl_type = res.getPayloadType(item.nsid);
+		if (item.nsid != nsid) {
+			nsid = item.nsid;
+			auto it = querys_->find(pl_type.Name());
+			func = (it != querys_->end()) ? it->second.get() : nullptr;
 		}
+		if (func && func->ProcessItem(item, pl_type)) changed = true;
 	}
 	res.nonCacheableData = changed;
 }
@@ -173,10 +176,10 @@ bool SelectFunction::ProcessItem(ItemRef &res, PayloadType &pl_type) {
 		if (!func.second.ctx) continue;
 		switch (func.second.type) {
 			case SelectFuncStruct::kSelectFuncSnippet:
-				if (Snippet::process(res, pl_type, func.second)) changed = true;
+				if (snippet_.process(res, pl_type, func.second)) changed = true;
 				break;
 			case SelectFuncStruct::kSelectFuncHighlight:
-				if (Highlight::process(res, pl_type, func.second)) changed = true;
+				if (highlight_.process(res, pl_type, func.second)) changed = true;
 				break;
 			case SelectFuncStruct::kSelectFuncNone:
 			case SelectFuncStruct::kSelectFuncProc:
@@ -3,6 +3,8 @@
 #include "core/query/query.h"
 #include "core/query/queryresults.h"
 #include "ctx/basefunctionctx.h"
+#include "functions/highlight.h"
+#include "functions/snippet.h"
 #include "nsselectfuncinterface.h"
 #include "selectfuncparser.h"
 
@@ -25,6 +27,8 @@ private:
 
 	fast_hash_map<int, SelectFuncStruct> functions_;
 	NsSelectFuncInterface nm_;
+	Highlight highlight_;
+	Snippet snippet_;
 
 	// You won't find these fields in the list of regular indexes
 	// (for example in PayloadType or ns_->indexes), you can only
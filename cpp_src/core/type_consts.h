@@ -86,7 +86,7 @@ enum ErrorCode {
 
 enum OpType { OpOr = 1, OpAnd = 2, OpNot = 3 };
 
-enum AggType { AggSum, AggAvg };
+enum AggType { AggSum, AggAvg, AggFacet, AggMin, AggMax, AggCount, AggCountDistinct, AggCountDistinctApprox };
 
 enum { TAG_VARINT, TAG_DOUBLE, TAG_STRING, TAG_ARRAY, TAG_BOOL, TAG_NULL, TAG_OBJECT, TAG_END };
 
@@ -112,6 +112,8 @@ enum {
 	kResultsWithCJson = 0x2,
 	kResultsWithJson = 0x3,
 	kResultsWithPayloadTypes = 0x8,
+	// Results are selected by server-side cursor batch by batch, and must be fetched sequentially
+	kResultsStream = 0x10,
 };
 
 typedef enum IndexOpt {
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <new>
+#include <string>
+
+namespace reindexer {
+
+// Contiguous piece of data: malloc'ed buffer owned by chunk, or read-only view of external data, which is kept alive by holder
+class chunk {
+public:
+	chunk() = default;
+	explicit chunk(size_t cap) : buf_(reinterpret_cast<char *>(malloc(cap))), data_(buf_), cap_(cap) {
+		if (!buf_ && cap) throw std::bad_alloc();
+	}
+	// Adopt malloc'ed buffer with len bytes of data
+	chunk(uint8_t *buf, size_t len, size_t cap) : buf_(reinterpret_cast<char *>(buf)), data_(buf_), len_(len), cap_(cap) {}
+	// Reference external data without copying
+	chunk(std::shared_ptr<const void> holder, const char *data, size_t len) : data_(data), len_(len), holder_(std::move(holder)) {}
+	explicit chunk(std::string &&str) {
+		auto holder = std::make_shared<std::string>(std::move(str));
+		data_ = holder->data();
+		len_ = holder->size();
+		holder_ = std::move(holder);
+	}
+	chunk(chunk &&other) noexcept { *this = std::move(other); }
+	chunk &operator=(chunk &&other) noexcept {
+		if (this != &other) {
+			free(buf_);
+			buf_ = other.buf_;
+			data_ = other.data_;
+			len_ = other.len_;
+			cap_ = other.cap_;
+			offset_ = other.offset_;
+			holder_ = std::move(other.holder_);
+			other.buf_ = nullptr;
+			other.data_ = nullptr;
+			other.len_ = other.cap_ = other.offset_ = 0;
+		}
+		return *this;
+	}
+	chunk(const chunk &) = delete;
+	chunk &operator=(const chunk &) = delete;
+	~chunk() { free(buf_); }
+
+	const char *data() const { return data_ + offset_; }
+	size_t size() const { return len_ - offset_; }
+	size_t capacity() const { return cap_; }
+	// Free space at the end of owned buffer
+	size_t available() const { return buf_ ? cap_ - len_ : 0; }
+
+	size_t append(const char *data, size_t len) {
+		len = std::min(len, available());
+		memcpy(buf_ + len_, data, len);
+		len_ += len;
+		return len;
+	}
+	// Drop n bytes from the beginning
+	void shift(size_t n) { offset_ += n; }
+	void clear() { len_ = offset_ = 0; }
+
+protected:
+	char *buf_ = nullptr;
+	const char *data_ = nullptr;
+	size_t len_ = 0, cap_ = 0, offset_ = 0;
+	std::shared_ptr<const void> holder_;
+};
+
+// Queue of chunks, which is written by one vectored write. Small writes are copied to the last chunk,
+// big chunks are moved to the queue without copying, so the buffer is never reallocated
+class chain_buf {
+public:
+	struct span {
+		const char *data;
+		size_t len;
+	};
+
+	chain_buf(size_t chunkSize = 0x8000) : chunkSize_(chunkSize) {}
+	chain_buf(const chain_buf &) = delete;
+	chain_buf &operator=(const chain_buf &) = delete;
+
+	void write(const char *data, size_t len) {
+		size_ += len;
+		while (len) {
+			if (chunks_.empty() || !chunks_.back().available()) chunks_.push_back(get_chunk(len));
+			size_t n = chunks_.back().append(data, len);
+			data += n;
+			len -= n;
+		}
+	}
+	void write(chunk &&ch) {
+		// Copy of small chunk is cheaper, than separate entry of vectored write
+		if (ch.size() < kMinChunkSize || (!chunks_.empty() && chunks_.back().available() >= ch.size())) {
+			write(ch.data(), ch.size());
+			return;
+		}
+		size_ += ch.size();
+		chunks_.push_back(std::move(ch));
+	}
+
+	size_t size() const { return size_; }
+	// Get up to cnt spans of data from the beginning of buffer. Returns number of spans
+	size_t tail(span *spans, size_t cnt) const {
+		size_t i = 0;
+		for (auto it = chunks_.begin(); it != chunks_.end() && i < cnt; ++it) {
+			if (it->size()) spans[i++] = span{it->data(), it->size()};
+		}
+		return i;
+	}
+	void erase(size_t len) {
+		size_ -= len;
+		while (len) {
+			auto &ch = chunks_.front();
+			size_t n = std::min(len, ch.size());
+			ch.shift(n);
+			len -= n;
+			if (!ch.size()) pop_front();
+		}
+	}
+	void clear() {
+		while (!chunks_.empty()) pop_front();
+		size_ = 0;
+	}
+
+protected:
+	static const size_t kMinChunkSize = 0x1000;
+
+	chunk get_chunk(size_t len) {
+		if (len <= chunkSize_ && spare_.capacity()) return std::move(spare_);
+		return chunk(std::max(len, chunkSize_));
+	}
+	// Buffer of default size is kept for next writes, so idle connection does not allocate memory for each responce
+	void pop_front() {
+		if (chunks_.front().capacity() == chunkSize_ && !spare_.capacity()) {
+			spare_ = std::move(chunks_.front());
+			spare_.clear();
+		}
+		chunks_.pop_front();
+	}
+
+	std::deque<chunk> chunks_;
+	chunk spare_;
+	size_t size_ = 0;
+	size_t chunkSize_;
+};
+
+}  // namespace reindexer
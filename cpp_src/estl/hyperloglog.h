@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace reindexer {
+
+// HyperLogLog cardinality sketch. Estimates count of distinct hashes with relative error about 1.04/sqrt(2^precision),
+// using 2^precision bytes of memory. Sketches with the same precision can be merged, which gives sketch of union of sets
+class HyperLogLog {
+public:
+	explicit HyperLogLog(int precision = kDefaultPrecision) : precision_(precision), registers_(size_t(1) << precision, 0) {
+		assert(precision >= 4 && precision <= 18);
+	}
+
+	// Add value by its hash. Hash must be well distributed over all 64 bits, use Mix for weak hashes
+	void Add(uint64_t hash) {
+		size_t idx = hash >> (64 - precision_);
+		// Guard bit limits rank, when all remaining bits are zero
+		uint64_t rest = (hash << precision_) | (uint64_t(1) << (precision_ - 1));
+		uint8_t rank = uint8_t(clz64(rest) + 1);
+		if (registers_[idx] < rank) registers_[idx] = rank;
+	}
+
+	void Merge(const HyperLogLog &other) {
+		assert(precision_ == other.precision_);
+		for (size_t i = 0; i < registers_.size(); i++) registers_[i] = std::max(registers_[i], other.registers_[i]);
+	}
+
+	double Estimate() const {
+		const double m = registers_.size();
+		double sum = 0;
+		size_t zeros = 0;
+		for (uint8_t r : registers_) {
+			sum += std::ldexp(1.0, -r);
+			zeros += (r == 0);
+		}
+		double estimate = alpha(m) * m * m / sum;
+		// Linear counting is more precise for small cardinalities
+		if (estimate <= 2.5 * m && zeros) estimate = m * std::log(m / zeros);
+		return estimate;
+	}
+
+	void Clear() { std::fill(registers_.begin(), registers_.end(), 0); }
+	int Precision() const { return precision_; }
+
+	// Finalizer of MurmurHash3, spreads bits of weak hashes (e.g. identity hash of integers)
+	static uint64_t Mix(uint64_t h) {
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+
+	static const int kDefaultPrecision = 14;
+
+protected:
+	static double alpha(double m) {
+		if (m <= 16) return 0.673;
+		if (m <= 32) return 0.697;
+		if (m <= 64) return 0.709;
+		return 0.7213 / (1 + 1.079 / m);
+	}
+	static int clz64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_clzll(v);
+#else
+		int n = 0;
+		for (uint64_t mask = uint64_t(1) << 63; !(v & mask); mask >>= 1) n++;
+		return n;
+#endif
+	}
+
+	int precision_;
+	std::vector<uint8_t> registers_;
+};
+
+}  // namespace reindexer
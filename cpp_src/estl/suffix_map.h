@@ -1,13 +1,18 @@
 #pragma once
 
-#include <unordered_map>
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
 #include <vector>
-#include "libdivsufsort/divsufsort.h"
 
 namespace reindexer {
 
 using std::vector;
 
+// Suffix array of words. Suffixes are partitioned to shards by their first two bytes: each shard is a contiguous range of
+// suffix array, so shards are built in parallel and lookups of pattern are done only in shard of its first bytes.
+// Two bytes are used, because first byte of utf8 is the same for whole alphabets, e.g. 0xD0 or 0xD1 for cyrillic
 template <typename K, typename V>
 class suffix_map {
 	typedef size_t size_type;
@@ -79,45 +84,18 @@ public:
 		return {start, iterator(idx_, this)};
 	}
 
+	// First suffix, which starts with str
 	iterator lower_bound(const K &str) const {
 		if (!built_) throw std::logic_error("Should call suffix_map::build before search");
-
-		size_type lo = 0, hi = sa_.size(), mid;
-		int lcp_lo = 0, lcp_hi = 0;
-		auto P = reinterpret_cast<const char_type *>(str.c_str());
-		auto T = reinterpret_cast<const char_type *>(text_.c_str());
-		while (lo <= hi) {
-			mid = (lo + hi) / 2;
-			int i = std::min(lcp_hi, lcp_lo);
-			bool plt = true;
-			if (mid >= sa_.size()) return end();
-			while (i < int(str.length()) && sa_[mid] + i < int(text_.length())) {
-				if (P[i] < T[sa_[mid] + i]) {
-					break;
-				} else if (P[i] > T[sa_[mid] + i]) {
-					plt = false;
-					break;
-				}
-				i++;
-			}
-			if (plt) {
-				if (mid == lo + 1) {
-					if (strncmp(str.c_str(), &text_[sa_[mid]], std::min(str.length(), strlen(&text_[sa_[mid]])))) return end();
-					return iterator(mid, this);
-				}
-				lcp_hi = i;
-				hi = mid;
-			} else {
-				if (mid == hi - 1) {
-					if (hi >= sa_.size() || strncmp(str.c_str(), &text_[sa_[hi]], std::min(str.length(), strlen(&text_[sa_[hi]]))))
-						return end();
-					return iterator(hi, this);
-				}
-				lcp_lo = i;
-				lo = mid;
-			}
-		}
-		return end();
+		if (str.empty()) return begin();
+
+		// All suffixes with the same first bytes are in one shard. Shards of the same first byte are adjacent
+		int first = char_type(str[0]) << 8;
+		auto lo = sa_.begin() + shards_[str.length() > 1 ? first | char_type(str[1]) : first];
+		auto hi = sa_.begin() + shards_[str.length() > 1 ? (first | char_type(str[1])) + 1 : first + 0x100];
+		auto it = std::lower_bound(lo, hi, str, [this](int pos, const K &s) { return strncmp(&text_[pos], s.c_str(), s.length()) < 0; });
+		if (it == hi || strncmp(&text_[*it], str.c_str(), str.length())) return end();
+		return iterator(it - sa_.begin(), this);
 	}
 
 	int insert(const K &word, const V &val, int virtual_len = -1) {
@@ -137,12 +115,47 @@ public:
 	int16_t word_len_at(int idx) const { return words_len_[idx].first; }
 	int16_t virtual_word_len(int idx) { return words_len_[idx].second; }
 
-	void build() {
+	// Build suffix array in threads. Each thread sorts shards of suffixes starting with some range of bytes
+	void build(int threads = 1) {
 		if (built_) return;
 		text_.shrink_to_fit();
-		sa_.resize(text_.length());
-		::divsufsort(reinterpret_cast<const char_type *>(text_.c_str()), &sa_[0], text_.length());
-		build_lcp();
+
+		// Count suffixes by first bytes. Positions of words terminators are not suffixes
+		shards_.assign(kShardsCount + 1, 0);
+		for (size_t pos = 0; pos < text_.length(); pos++) {
+			if (text_[pos]) shards_[shard_of(pos) + 1]++;
+		}
+		for (int i = 0; i < kShardsCount; i++) shards_[i + 1] += shards_[i];
+
+		sa_.resize(shards_[kShardsCount]);
+		lcp_.resize(sa_.size());
+		vector<int> fill(shards_.begin(), shards_.end() - 1);
+		for (size_t pos = 0; pos < text_.length(); pos++) {
+			if (text_[pos]) sa_[fill[shard_of(pos)]++] = pos;
+		}
+
+		// Split shards to threads by count of suffixes
+		threads = std::max(1, std::min(threads, int(sa_.size() / kMinSuffixesPerThread)));
+		vector<std::thread> workers;
+		int shard = 0;
+		for (int t = 0; t < threads; t++) {
+			int firstShard = shard;
+			size_t limit = sa_.size() * (t + 1) / threads;
+			while (shard < kShardsCount && (t == threads - 1 || size_t(shards_[shard + 1]) <= limit)) shard++;
+			if (t == threads - 1) {
+				build_shards(firstShard, shard);
+			} else {
+				workers.emplace_back([this, firstShard, shard]() { build_shards(firstShard, shard); });
+			}
+		}
+		for (auto &worker : workers) worker.join();
+
+		// Suffixes of adjacent shards have common first byte, if shards differ by second byte only
+		for (int shard = 0; shard < kShardsCount; shard++) {
+			int last = shards_[shard + 1] - 1;
+			if (last < shards_[shard]) continue;
+			lcp_[last] = (last + 1 < int(sa_.size()) && text_[sa_[last]] == text_[sa_[last + 1]]) ? 1 : 0;
+		}
 		built_ = true;
 	}
 
@@ -153,6 +166,7 @@ public:
 		words_len_.reserve(sz_words);
 	}
 	void clear() {
+		shards_.clear();
 		sa_.clear();
 		lcp_.clear();
 		mapped_.clear();
@@ -164,30 +178,41 @@ public:
 	size_type size() { return sa_.size(); }
 	const K &text() const { return text_; }
 	size_t heap_size() {
-		return (sa_.capacity() + words_.capacity()) * sizeof(int) +			  //
+		return (sa_.capacity() + words_.capacity() + shards_.capacity()) * sizeof(int) +  //
 			   (lcp_.capacity() + words_len_.capacity()) * sizeof(int16_t) +  //
 			   mapped_.capacity() * sizeof(V) + text_.capacity();
 	}
 
 protected:
-	void build_lcp() {
-		vector<int> rank_;
-		rank_.resize(sa_.size());
-		lcp_.resize(sa_.size());
-		int k = 0, n = size();
-
-		for (int i = 0; i < n; i++) rank_[sa_[i]] = i;
-		for (int i = 0; i < n; i++, k ? k-- : 0) {
-			if (rank_[i] == n - 1) {
-				k = 0;
-				continue;
+	// Shard of suffix: its first two bytes. Second byte is 0 for suffix of one byte
+	int shard_of(size_t pos) const { return (char_type(text_[pos]) << 8) | char_type(text_[pos + 1]); }
+
+	// Sort suffixes of shards [first, last) and evaluate lcp of them. Suffixes are compared to the end of word,
+	// equal suffixes of different words are ordered by position. Lcp of the last suffix of shard is evaluated by build
+	void build_shards(int first, int last) {
+		for (int shard = first; shard < last; shard++) {
+			auto begin = sa_.begin() + shards_[shard], end = sa_.begin() + shards_[shard + 1];
+			// Suffixes of one byte are equal, and they are already ordered by position
+			if (shard & 0xFF) {
+				std::sort(begin, end, [this](int lhs, int rhs) {
+					int res = strcmp(&text_[lhs + 2], &text_[rhs + 2]);
+					return res < 0 || (res == 0 && lhs < rhs);
+				});
+			}
+			for (int i = shards_[shard]; i + 1 < shards_[shard + 1]; i++) {
+				const char *lhs = &text_[sa_[i]], *rhs = &text_[sa_[i + 1]];
+				int k = 0;
+				while (lhs[k] && lhs[k] == rhs[k]) k++;
+				lcp_[i] = k;
 			}
-			int j = sa_[rank_[i] + 1];
-			while (i + k < n && j + k < n && text_[i + k] == text_[j + k]) k++;
-			lcp_[rank_[i]] = k;
 		}
 	}
 
+	static const int kShardsCount = 0x10000;
+	static const int kMinSuffixesPerThread = 10000;
+
+	// Bounds of shards in suffix array: suffixes of shard s = b0 << 8 | b1 (first bytes) are in range [shards_[s], shards_[s + 1])
+	std::vector<int> shards_;
 	std::vector<int> sa_, words_;
 	std::vector<int16_t> lcp_;
 	std::vector<std::pair<uint8_t, uint8_t>> words_len_;
@@ -2,7 +2,9 @@
 
 #include <fstream>
 #include <iterator>
+#include <thread>
 
+#include "estl/suffix_map.h"
 #include "tools/stringstools.h"
 
 using benchmark::State;
@@ -80,6 +82,10 @@ void FullText::RegisterAllCases() {
 	Register("BuildCommonIndexes", &FullText::BuildCommonIndexes, this)->Iterations(1)->Unit(benchmark::kMicrosecond);
 	Register("BuildFastTextIndex", &FullText::BuildFastTextIndex, this)->Iterations(1)->Unit(benchmark::kMicrosecond);
 	Register("BuildFuzzyTextIndex", &FullText::BuildFuzzyTextIndex, this)->Iterations(1)->Unit(benchmark::kMicrosecond);
+	Register("BuildSuffixMap", &FullText::BuildSuffixMap, this)
+		->Arg(1)
+		->Arg(std::thread::hardware_concurrency())
+		->Unit(benchmark::kMicrosecond);
 
 	Register("Fast1WordMatch", &FullText::Fast1WordMatch, this)->Unit(benchmark::kMicrosecond);
 	Register("Fast2WordsMatch", &FullText::Fast2WordsMatch, this)->Unit(benchmark::kMicrosecond);
@@ -162,6 +168,18 @@ void FullText::BuildFastTextIndex(benchmark::State& state) {
 	state.SetLabel("Commit ratio: " + std::to_string(ratio));
 }
 
+// Dictionary is cyrillic, so the most of suffixes start with two-byte utf8 characters. Argument is count of threads
+void FullText::BuildSuffixMap(benchmark::State& state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		reindexer::suffix_map<string, int> suffixes;
+		for (size_t i = 0; i < words_.size(); i++) suffixes.insert(words_[i], int(i));
+		state.ResumeTiming();
+
+		suffixes.build(state.range(0));
+	}
+}
+
 void FullText::BuildFuzzyTextIndex(benchmark::State& state) {
 	AllocsTracker allocsTracker(state, printFlags);
 	size_t mem = 0;
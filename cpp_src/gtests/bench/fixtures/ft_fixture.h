@@ -25,6 +25,7 @@ protected:
 	void BuildCommonIndexes(State& state);
 	void BuildFastTextIndex(State& state);
 	void BuildFuzzyTextIndex(State& state);
+	void BuildSuffixMap(State& state);
 
 	void Fast1WordMatch(State& state);
 	void Fast2WordsMatch(State& state);
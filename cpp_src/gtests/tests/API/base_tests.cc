@@ -1,4 +1,5 @@
 #include <fstream>
+#include <map>
 #include <vector>
 #include "reindexer_api.h"
 #include "tools/errors.h"
@@ -535,6 +536,43 @@ TEST_F(ReindexerApi, SortByUnorderedIndexWithJoins) {
 	}
 }
 
+TEST_F(ReindexerApi, FacetOfCollatedIndex) {
+	auto err = reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled(false));
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->AddIndex(default_namespace, {"id", "", "hash", "int", IndexOpts().PK()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->AddIndex(default_namespace, {"name", "", "hash", "string", IndexOpts().SetCollateMode(CollateASCII)});
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	// Keys are equal by collation of index
+	const char* names[] = {"Foo", "foo", "FOO", "bar", "foo"};
+	for (int i = 0; i < 5; ++i) {
+		Item item(reindexer->NewItem(default_namespace));
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		item["id"] = i;
+		item["name"] = names[i];
+		Upsert(default_namespace, item);
+	}
+	Commit(default_namespace);
+
+	auto aggregate = [&](Query q) {
+		QueryResults qr;
+		auto err = reindexer->Select(q.Aggregate("name", AggFacet).Aggregate("name", AggCountDistinct), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::map<string, int> facet;
+		if (qr.aggregationResults.size() != 2) return facet;
+		for (auto& f : qr.aggregationResults[0].facets) facet[f.values[0]] = f.count;
+		EXPECT_EQ(qr.aggregationResults[1].value, facet.size());
+		return facet;
+	};
+
+	// Result does not depend on filter, which selects items by loop
+	auto facet = aggregate(Query(default_namespace));
+	EXPECT_TRUE(facet == aggregate(Query(default_namespace).Where("id", CondGe, 0)));
+	EXPECT_EQ(facet.size(), 4u);
+	EXPECT_EQ(facet["foo"], 2);
+}
+
 void TestDSLParseCorrectness(const string& testDsl) {
 	Query query;
 	Error err = query.ParseJson(testDsl);
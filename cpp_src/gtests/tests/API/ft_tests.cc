@@ -1,4 +1,5 @@
 #include <iostream>
+#include <set>
 #include <unordered_set>
 #include "ft_api.h"
 #include "tools/stringstools.h"
@@ -57,3 +58,348 @@ TEST_F(FTApi, NumberToWordsSelect) {
 		EXPECT_TRUE(result == val);
 	}
 }
+
+TEST_F(FTApi, SelectAfterUpdates) {
+	for (int i = 0; i < 20; i++) Add("nm1", "common document number " + std::to_string(i), "");
+
+	EXPECT_EQ(SimpleSelect("common").Count(), 20);
+
+	// Replace text of existing document
+	Item item = NewItem("nm1");
+	item["id"] = 0;
+	item["ft1"] = "replaced document";
+	item["ft2"] = "";
+	Upsert("nm1", item);
+	Commit("nm1");
+
+	// Delete document
+	Item delItem = NewItem("nm1");
+	delItem["id"] = 1;
+	auto err = reindexer->Delete("nm1", delItem);
+	ASSERT_TRUE(err.ok()) << err.what();
+	Commit("nm1");
+
+	// Add new document
+	Add("nm1", "added document", "");
+
+	EXPECT_EQ(SimpleSelect("common").Count(), 18);
+	EXPECT_EQ(SimpleSelect("replaced").Count(), 1);
+	EXPECT_EQ(SimpleSelect("added").Count(), 1);
+	EXPECT_EQ(SimpleSelect("document").Count(), 20);
+}
+
+TEST_F(FTApi, SelectAfterManyCommits) {
+	for (int i = 0; i < 1500; i++) Add("nm1", "common main document " + std::to_string(i), "");
+	EXPECT_EQ(SimpleSelect("common").Count(), 1500);
+
+	// Each select commits one new document to delta segments, which are merged with each other on the way
+	for (int i = 0; i < 300; i++) {
+		Add("nm1", "common delta" + std::to_string(i) + " document", "");
+		EXPECT_EQ(SimpleSelect("delta" + std::to_string(i)).Count(), 1) << i;
+		if (i % 50 == 49) {
+			EXPECT_EQ(SimpleSelect("common").Count(), 1501 + i) << i;
+			EXPECT_EQ(SimpleSelect("delta0 delta" + std::to_string(i / 2)).Count(), 2) << i;
+		}
+	}
+	EXPECT_EQ(SimpleSelect("document").Count(), 1800);
+}
+
+TEST_F(FTApi, DeltaSegmentRanks) {
+	for (int i = 0; i < 1500; i++) Add("nm1", "common document" + std::to_string(i), "");
+	EXPECT_EQ(SimpleSelect("common").Count(), 1500);
+
+	// New document is committed to delta segment. IDF of word is evaluated by all segments, so document is ranked as equal ones of main
+	Add("nm1", "common document1500", "");
+	auto res = SimpleSelect("common");
+	ASSERT_EQ(res.Count(), 1501);
+	int proc = res.begin().GetItemRef().proc;
+	for (auto it : res) EXPECT_EQ(it.GetItemRef().proc, proc) << it.GetItemRef().id;
+}
+
+TEST_F(FTApi, ParallelSelect) {
+	for (int i = 0; i < 5000; i++) {
+		Item item = NewItem("nm1");
+		item["id"] = i;
+		item["ft1"] = "alpha beta" + std::to_string(i % 10) + " gamma" + std::to_string(i % 7) + " delta";
+		item["ft2"] = "";
+		Upsert("nm1", item);
+	}
+	Commit("nm1");
+
+	auto selectRanks = [&](const char* config) {
+		auto err = reindexer->ConfigureIndex("nm1", "ft3", config);
+		EXPECT_TRUE(err.ok()) << err.what();
+		auto res = SimpleSelect("alpha beta1 gamma2 delta*");
+		vector<pair<IdType, int>> ranks;
+		for (auto it : res) ranks.push_back({it.GetItemRef().id, it.GetItemRef().proc});
+		return ranks;
+	};
+
+	auto sequential = selectRanks(R"xxx({"parallel_terms_threshold": 0, "parallel_merge_threshold": 0})xxx");
+	auto parallel = selectRanks(R"xxx({"parallel_terms_threshold": 1, "parallel_merge_threshold": 1})xxx");
+	EXPECT_FALSE(sequential.empty());
+	EXPECT_TRUE(sequential == parallel);
+}
+
+TEST_F(FTApi, ParallelSelectMergeLimit) {
+	// Cached results are not reset by ConfigureIndex, so each config is used by own namespace
+	auto err = reindexer->ConfigureIndex("nm1", "ft3", R"xxx({"parallel_terms_threshold": 0, "parallel_merge_threshold": 0})xxx");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->ConfigureIndex("nm2", "ft3",
+									R"xxx({"parallel_terms_threshold": 1, "parallel_merge_threshold": 1, "merge_limit": 100})xxx");
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (const char* ns : {"nm1", "nm2"}) {
+		for (int i = 0; i < 5000; i++) {
+			Item item = NewItem(ns);
+			item["id"] = i;
+			// Documents with equal text are merged once, so each text is unique
+			item["ft1"] = "alpha beta" + std::to_string(i % 10) + " gamma" + std::to_string(i % 7) + " delta" + std::to_string(i);
+			item["ft2"] = "";
+			Upsert(ns, item);
+		}
+		Commit(ns);
+	}
+
+	auto selectRanks = [&](const char* ns) {
+		QueryResults res;
+		auto err = reindexer->Select(Query(ns).Where("ft3", CondEq, "alpha beta1 gamma2 delta*"), res);
+		EXPECT_TRUE(err.ok()) << err.what();
+		vector<pair<IdType, int>> ranks;
+		for (auto it : res) ranks.push_back({it.GetItemRef().id, it.GetItemRef().proc});
+		return ranks;
+	};
+
+	// Every document matches, so merge limit is reached. Limited result must be the best documents of full result,
+	// regardless of partitioning of merge
+	auto full = selectRanks("nm1");
+	auto limited = selectRanks("nm2");
+	ASSERT_EQ(full.size(), 5000u);
+	ASSERT_EQ(limited.size(), 100u);
+	full.erase(full.begin() + 100, full.end());
+	EXPECT_TRUE(full == limited);
+}
+
+TEST_F(FTApi, MergeLimitRankTies) {
+	auto err = reindexer->ConfigureIndex("nm1", "ft3", R"xxx({"merge_limit": 10})xxx");
+	ASSERT_TRUE(err.ok()) << err.what();
+	// Rank of posting list entry depends on position of word. Many documents with equal rank precede few better ones
+	for (int i = 0; i < 205; i++) {
+		Item item = NewItem("nm1");
+		item["id"] = i;
+		item["ft1"] = i >= 5 ? "first" + std::to_string(i) + " second" + std::to_string(i) + " word" : "word third" + std::to_string(i);
+		item["ft2"] = "";
+		Upsert("nm1", item);
+	}
+	Commit("nm1");
+
+	QueryResults res;
+	err = reindexer->Select(Query("nm1").Where("ft3", CondEq, "word"), res);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(res.Count(), 10u);
+	// Better documents are merged, and ties fill the rest of limit
+	std::set<int> better;
+	for (auto it : res) {
+		if (it.GetItemRef().id < 5) better.insert(it.GetItemRef().id);
+	}
+	EXPECT_EQ(better.size(), 5u);
+}
+
+TEST_F(FTApi, SelectTopK) {
+	for (int i = 0; i < 3000; i++) {
+		Item item = NewItem("nm1");
+		item["id"] = i;
+		item["ft1"] = "alpha beta" + std::to_string(i % 10) + " gamma" + std::to_string(i % 7) + " alpha" + std::to_string(i % 13);
+		item["ft2"] = (i % 3) ? "delta" : "";
+		Upsert("nm1", item);
+	}
+	Commit("nm1");
+
+	auto selectRanks = [&](const string& dsl, unsigned offset, unsigned limit) {
+		Query q = Query("nm1").Where("ft3", CondEq, dsl).Offset(offset).Limit(limit);
+		q.selectFunctions_.push_back("ft3 = highlight(!,!)");
+		QueryResults res;
+		auto err = reindexer->Select(q, res);
+		EXPECT_TRUE(err.ok()) << err.what();
+		vector<pair<IdType, int>> ranks;
+		for (auto it : res) ranks.push_back({it.GetItemRef().id, it.GetItemRef().proc});
+		return ranks;
+	};
+
+	// Only the best documents are ranked, when query has limit. They must be the same, as first documents of full result
+	for (const string dsl : {"alpha", "beta1 gamma2", "alpha* beta3 delta", "gamma4 beta5~"}) {
+		auto limited = selectRanks(dsl, 5, 20);
+		auto full = selectRanks(dsl, 0, UINT_MAX);
+		ASSERT_GE(full.size(), 25u) << dsl;
+		full.erase(full.begin() + 25, full.end());
+		full.erase(full.begin(), full.begin() + 5);
+		EXPECT_TRUE(limited == full) << dsl;
+	}
+}
+
+TEST_F(FTApi, PhraseSearch) {
+	Add("nm1", "the quick brown fox", "");
+	Add("nm1", "brown quick fox", "");
+	Add("nm1", "quick red brown fox", "");
+	Add("nm1", "quick", "brown");
+	Add("nm1", "end of days", "");
+	Add("nm1", "end days", "");
+
+	auto selectTexts = [&](const string& dsl) {
+		Query q = Query("nm1").Where("ft3", CondEq, dsl);
+		QueryResults res;
+		auto err = reindexer->Select(q, res);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::set<string> texts;
+		for (auto it : res) {
+			Item ritem(it.GetItem());
+			texts.insert(ritem["ft1"].As<string>());
+		}
+		return texts;
+	};
+
+	// Words of phrase must be in the same order one after another in the same field
+	EXPECT_EQ(selectTexts("\"quick brown\""), (std::set<string>{"the quick brown fox"}));
+	EXPECT_EQ(selectTexts("\"brown quick\""), (std::set<string>{"brown quick fox"}));
+	EXPECT_EQ(selectTexts("\"quick brown fox\""), (std::set<string>{"the quick brown fox"}));
+	// Stop words are counted in distance between words of phrase
+	EXPECT_EQ(selectTexts("\"end of days\""), (std::set<string>{"end of days"}));
+	// Proximity does not depend on order of words
+	EXPECT_EQ(selectTexts("\"quick brown\"~1"), (std::set<string>{"the quick brown fox", "brown quick fox"}));
+	EXPECT_EQ(selectTexts("\"quick brown\"~2"), (std::set<string>{"the quick brown fox", "brown quick fox", "quick red brown fox"}));
+}
+
+TEST_F(FTApi, FuzzySelectAfterUpdates) {
+	// The same documents are added to nm3 incrementally and to nm4 at once
+	for (const char* ns : {"nm3", "nm4"}) {
+		auto err = reindexer->OpenNamespace(ns);
+		ASSERT_TRUE(err.ok()) << err.what();
+		DefineNamespaceDataset(ns, {IndexDeclaration{"id", "hash", "int", IndexOpts().PK()},
+									IndexDeclaration{"ft1", "fuzzytext", "string", IndexOpts()}});
+	}
+	auto upsert = [&](const char* ns, int id, const string& text) {
+		Item item = NewItem(ns);
+		item["id"] = id;
+		item["ft1"] = text;
+		Upsert(ns, item);
+	};
+	auto selectIds = [&](const char* ns, const string& dsl) {
+		QueryResults res;
+		auto err = reindexer->Select(Query(ns).Where("ft1", CondEq, dsl), res);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::set<int> ids;
+		for (auto it : res) ids.insert(it.GetItem()["id"].As<int>());
+		return ids;
+	};
+
+	for (int i = 0; i < 50; i++) upsert("nm3", i, "common text number " + std::to_string(i));
+	Commit("nm3");
+	EXPECT_EQ(selectIds("nm3", "common").size(), 50u);
+
+	// Replace, delete and add documents
+	upsert("nm3", 0, "replaced document");
+	Item delItem = NewItem("nm3");
+	delItem["id"] = 1;
+	auto err = reindexer->Delete("nm3", delItem);
+	ASSERT_TRUE(err.ok()) << err.what();
+	upsert("nm3", 100, "added document");
+	Commit("nm3");
+
+	upsert("nm4", 0, "replaced document");
+	for (int i = 2; i < 50; i++) upsert("nm4", i, "common text number " + std::to_string(i));
+	upsert("nm4", 100, "added document");
+	Commit("nm4");
+
+	for (const string dsl : {"common", "replaced", "added", "document", "number 7", "text common document"}) {
+		EXPECT_EQ(selectIds("nm3", dsl), selectIds("nm4", dsl)) << dsl;
+	}
+	EXPECT_EQ(selectIds("nm3", "common").size(), 48u);
+}
+
+TEST_F(FTApi, CachedSelectAfterUpdates) {
+	for (int i = 0; i < 20; i++) Add("nm1", "common document number " + std::to_string(i), "");
+	// Results are cached on repeated selects
+	auto selectCount = [&](const string& dsl) {
+		for (int i = 0; i < 2; i++) SimpleSelect(dsl);
+		return SimpleSelect(dsl).Count();
+	};
+	for (const char* dsl : {"common", "document", "added", "replaced", "number"}) selectCount(dsl);
+	EXPECT_EQ(selectCount("common"), 20);
+
+	// Update item without change of text
+	Item item = NewItem("nm1");
+	item["id"] = 2;
+	item["ft1"] = "common document number 2";
+	item["ft2"] = "";
+	Upsert("nm1", item);
+	Commit("nm1");
+	EXPECT_EQ(selectCount("common"), 20);
+
+	// Add new document
+	Add("nm1", "common added document", "");
+	EXPECT_EQ(selectCount("common"), 21);
+	EXPECT_EQ(selectCount("added"), 1);
+	EXPECT_EQ(selectCount("number"), 20);
+
+	// Replace text of existing document
+	item = NewItem("nm1");
+	item["id"] = 0;
+	item["ft1"] = "replaced document";
+	item["ft2"] = "";
+	Upsert("nm1", item);
+	Commit("nm1");
+	EXPECT_EQ(selectCount("common"), 20);
+	EXPECT_EQ(selectCount("replaced"), 1);
+	EXPECT_EQ(selectCount("number"), 19);
+
+	// Text of document is the same, as text of other existing document
+	item = NewItem("nm1");
+	item["id"] = 5;
+	item["ft1"] = "replaced document";
+	item["ft2"] = "";
+	Upsert("nm1", item);
+	Commit("nm1");
+	EXPECT_EQ(selectCount("replaced"), 2);
+
+	// Delete document
+	Item delItem = NewItem("nm1");
+	delItem["id"] = 1;
+	auto err = reindexer->Delete("nm1", delItem);
+	ASSERT_TRUE(err.ok()) << err.what();
+	Commit("nm1");
+	EXPECT_EQ(selectCount("common"), 18);
+	EXPECT_EQ(selectCount("document"), 20);
+}
+
+TEST_F(FTApi, SnippetAndHighlight) {
+	Add("nm1", "One two three four five six seven", "");
+	Add("nm1", "four", "");
+	auto selectFt1 = [&](const string& dsl, const string& func) {
+		Query qr = Query("nm1").Where("ft1", CondEq, dsl).Sort("id", false);
+		qr.selectFunctions_.push_back(func);
+		QueryResults res;
+		auto err = reindexer->Select(qr, res);
+		EXPECT_TRUE(err.ok()) << err.what();
+		vector<string> texts;
+		for (auto it : res) texts.push_back(it.GetItem()["ft1"].As<string>());
+		return texts;
+	};
+
+	EXPECT_EQ(selectFt1("four seven", "ft1 = highlight(<b>,</b>)"),
+			  (vector<string>{"One two three <b>four</b> five six <b>seven</b>", "<b>four</b>"}));
+	EXPECT_EQ(selectFt1("four", "ft1 = snippet(<b>,</b>,5,5)"), (vector<string>{"hree <b>four</b> five ", "<b>four</b> "}));
+	// Windows around words are merged
+	EXPECT_EQ(selectFt1("four seven", "ft1 = snippet(<b>,</b>,5,5)"),
+			  (vector<string>{"hree <b>four</b> five six <b>seven</b> ", "<b>four</b> "}));
+	EXPECT_EQ(selectFt1("one seven", "ft1 = snippet(<b>,</b>,2,2)"), (vector<string>{"<b>One</b> t x <b>seven</b> "}));
+}
+
+TEST_F(FTApi, CachedTermVariants) {
+	Add("nm1", "лунтик", "");
+	Add("nm1", "luntik", "");
+
+	// Translit variants are taken from cache on repeated queries. Exact term has other variants
+	for (int i = 0; i < 3; i++) {
+		EXPECT_EQ(SimpleSelect("luntik").Count(), 2) << i;
+		EXPECT_EQ(SimpleSelect("=luntik").Count(), 1) << i;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <thread>
+#include "net/ev/ev.h"
+
+// Loop, which runs in its own thread, until it is stopped
+class LoopThread {
+public:
+	LoopThread() {
+		stop_.set(loop_);
+		stop_.set([this](reindexer::net::ev::async &sig) {
+			terminate_ = true;
+			sig.loop.break_loop();
+		});
+		stop_.start();
+	}
+	template <typename F>
+	void Run(F onStop) {
+		thread_ = std::thread([this, onStop]() {
+			while (!terminate_) loop_.run();
+			onStop();
+		});
+	}
+	void Stop() {
+		stop_.send();
+		if (thread_.joinable()) thread_.join();
+	}
+	reindexer::net::ev::dynamic_loop &Loop() { return loop_; }
+
+protected:
+	reindexer::net::ev::dynamic_loop loop_;
+	reindexer::net::ev::async stop_;
+	std::thread thread_;
+	bool terminate_ = false;
+};
@@ -781,8 +781,158 @@ protected:
 			yearSum += item[kFieldNameYear].Get<int>();
 		}
 
-		EXPECT_DOUBLE_EQ(testQr.aggregationResults[1], yearSum) << "Aggregation Sum result is incorrect!";
-		EXPECT_DOUBLE_EQ(testQr.aggregationResults[0], yearSum / checkQr.Count()) << "Aggregation Sum result is incorrect!";
+		EXPECT_DOUBLE_EQ(testQr.aggregationResults[1].value, yearSum) << "Aggregation Sum result is incorrect!";
+		EXPECT_DOUBLE_EQ(testQr.aggregationResults[0].value, yearSum / checkQr.Count()) << "Aggregation Sum result is incorrect!";
+
+		CheckMinMaxCountAggregations(Query(default_namespace).Where(kFieldNameGenre, CondEq, 10).Limit(limit));
+		CheckFacetAggregations(Query(default_namespace).Where(kFieldNameGenre, CondLt, 10));
+		// Facets without filtering conditions are calculated from index keys
+		CheckFacetAggregations(Query(default_namespace));
+		// Aggregations without filtering conditions are calculated from index keys
+		CheckMinMaxCountAggregations(Query(default_namespace));
+		CheckSumAvgAggregations(Query(default_namespace));
+		// Count of items, matched by several idsets, is calculated without select loop
+		CheckCountAggregations(Query(default_namespace).Where(kFieldNameGenre, CondLt, 25).Where(kFieldNameYear, CondGt, 2010));
+		CheckCountAggregations(Query(default_namespace)
+								   .Where(kFieldNameGenre, CondGe, 5)
+								   .Where(kFieldNamePackages, CondSet, RandIntVector(10, 10000, 50))
+								   .Where(kFieldNameYear, CondLe, 2015));
+	}
+
+	void CheckSumAvgAggregations(const Query& checkQuery) {
+		Query testQuery = checkQuery;
+		testQuery.Aggregate(kFieldNameYear, AggSum).Aggregate(kFieldNameYear, AggAvg);
+
+		reindexer::QueryResults testQr;
+		Error err = reindexer->Select(testQuery, testQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(testQr.aggregationResults.size(), 2);
+
+		reindexer::QueryResults checkQr;
+		err = reindexer->Select(checkQuery, checkQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		double yearSum = 0.0;
+		for (auto it : checkQr) {
+			Item item(it.GetItem());
+			yearSum += item[kFieldNameYear].Get<int>();
+		}
+
+		EXPECT_DOUBLE_EQ(testQr.aggregationResults[0].value, yearSum) << "Aggregation Sum result is incorrect!";
+		if (checkQr.Count()) {
+			EXPECT_DOUBLE_EQ(testQr.aggregationResults[1].value, yearSum / checkQr.Count()) << "Aggregation Avg result is incorrect!";
+		}
+	}
+
+	void CheckCountAggregations(const Query& checkQuery) {
+		Query totalQuery = checkQuery;
+		totalQuery.Limit(0).ReqTotal();
+		Query countQuery = checkQuery;
+		countQuery.Aggregate(kFieldNameYear, AggCount);
+		Query countWithOffsetQuery = checkQuery;
+		countWithOffsetQuery.Offset(10).Limit(20).Aggregate(kFieldNameYear, AggCount);
+
+		reindexer::QueryResults checkQr;
+		Error err = reindexer->Select(checkQuery, checkQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		reindexer::QueryResults totalQr;
+		err = reindexer->Select(totalQuery, totalQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(size_t(totalQr.totalCount), checkQr.Count()) << "Total count is incorrect!";
+		EXPECT_EQ(totalQr.Count(), size_t(0));
+
+		reindexer::QueryResults countQr;
+		err = reindexer->Select(countQuery, countQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(countQr.aggregationResults.size(), 1);
+		EXPECT_DOUBLE_EQ(countQr.aggregationResults[0].value, checkQr.Count()) << "Aggregation Count result is incorrect!";
+
+		reindexer::QueryResults countWithOffsetQr;
+		err = reindexer->Select(countWithOffsetQuery, countWithOffsetQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(countWithOffsetQr.aggregationResults.size(), 1);
+		size_t expected = checkQr.Count() > 10 ? std::min(checkQr.Count() - 10, size_t(20)) : 0;
+		EXPECT_DOUBLE_EQ(countWithOffsetQr.aggregationResults[0].value, expected) << "Aggregation Count result is incorrect!";
+	}
+
+	void CheckMinMaxCountAggregations(const Query& checkQuery) {
+		Query testQuery = checkQuery;
+		testQuery.Aggregate(kFieldNameYear, AggMin).Aggregate(kFieldNameYear, AggMax).Aggregate(kFieldNameYear, AggCount);
+
+		reindexer::QueryResults testQr;
+		Error err = reindexer->Select(testQuery, testQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(testQr.aggregationResults.size(), 3);
+
+		reindexer::QueryResults checkQr;
+		err = reindexer->Select(checkQuery, checkQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		double yearMin = numeric_limits<double>::max(), yearMax = -numeric_limits<double>::max();
+		for (auto it : checkQr) {
+			Item item(it.GetItem());
+			double year = item[kFieldNameYear].Get<int>();
+			yearMin = std::min(yearMin, year);
+			yearMax = std::max(yearMax, year);
+		}
+		if (checkQr.Count() == 0) yearMin = yearMax = 0;
+
+		EXPECT_DOUBLE_EQ(testQr.aggregationResults[0].value, yearMin) << "Aggregation Min result is incorrect!";
+		EXPECT_DOUBLE_EQ(testQr.aggregationResults[1].value, yearMax) << "Aggregation Max result is incorrect!";
+		EXPECT_DOUBLE_EQ(testQr.aggregationResults[2].value, checkQr.Count()) << "Aggregation Count result is incorrect!";
+	}
+
+	void CheckFacetAggregations(const Query& checkQuery) {
+		Query testQuery = checkQuery;
+		testQuery.Aggregate(kFieldNameGenre, AggFacet)
+			.Aggregate({kFieldNameGenre, kFieldNameYear}, AggFacet)
+			.Aggregate(kFieldNameGenre, AggCountDistinct)
+			.Aggregate(kFieldNameGenre, AggCountDistinctApprox)
+			.Aggregate({kFieldNameGenre, kFieldNameYear}, AggCountDistinctApprox);
+
+		reindexer::QueryResults testQr;
+		Error err = reindexer->Select(testQuery, testQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(testQr.aggregationResults.size(), 5);
+
+		reindexer::QueryResults checkQr;
+		err = reindexer->Select(checkQuery, checkQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		map<string, int> genreFacet;
+		map<std::pair<string, string>, int> genreYearFacet;
+		for (auto it : checkQr) {
+			Item item(it.GetItem());
+			string genre = item[kFieldNameGenre].As<string>();
+			string year = item[kFieldNameYear].As<string>();
+			genreFacet[genre]++;
+			genreYearFacet[{genre, year}]++;
+		}
+
+		const auto& facet = testQr.aggregationResults[0].facets;
+		ASSERT_EQ(facet.size(), genreFacet.size()) << "Aggregation Facet result is incorrect!";
+		for (size_t i = 0; i < facet.size(); ++i) {
+			ASSERT_EQ(facet[i].values.size(), 1);
+			EXPECT_EQ(facet[i].count, genreFacet[facet[i].values[0]]) << "Aggregation Facet result is incorrect!";
+			if (i) {
+				EXPECT_GE(facet[i - 1].count, facet[i].count) << "Aggregation Facet result is not sorted!";
+			}
+		}
+
+		const auto& multiFacet = testQr.aggregationResults[1].facets;
+		ASSERT_EQ(multiFacet.size(), genreYearFacet.size()) << "Aggregation multifield Facet result is incorrect!";
+		for (auto& f : multiFacet) {
+			ASSERT_EQ(f.values.size(), 2);
+			EXPECT_EQ(f.count, (genreYearFacet[{f.values[0], f.values[1]}])) << "Aggregation multifield Facet result is incorrect!";
+		}
+
+		EXPECT_DOUBLE_EQ(testQr.aggregationResults[2].value, genreFacet.size()) << "Aggregation CountDistinct result is incorrect!";
+		// HyperLogLog sketch is almost exact on small cardinalities
+		EXPECT_NEAR(testQr.aggregationResults[3].value, genreFacet.size(), 1 + genreFacet.size() * 0.02)
+			<< "Aggregation CountDistinctApprox result is incorrect!";
+		EXPECT_NEAR(testQr.aggregationResults[4].value, genreYearFacet.size(), 1 + genreYearFacet.size() * 0.02)
+			<< "Aggregation multifield CountDistinctApprox result is incorrect!";
 	}
 
 	void CheckSqlQueries() {
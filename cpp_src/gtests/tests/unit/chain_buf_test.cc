@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include "estl/chain_buf.h"
+#include "tools/serializer.h"
+
+using reindexer::chain_buf;
+using reindexer::chunk;
+
+// Read whole content of buffer by pieces of limited size, as socket does
+static std::string drain(chain_buf &buf, size_t maxSpans, size_t maxLen) {
+	std::string out;
+	while (buf.size()) {
+		chain_buf::span spans[4];
+		size_t cnt = buf.tail(spans, std::min(maxSpans, sizeof(spans) / sizeof(spans[0]))), len = 0;
+		EXPECT_GT(cnt, 0u);
+		for (size_t i = 0; i < cnt && len < maxLen; i++) {
+			size_t n = std::min(spans[i].len, maxLen - len);
+			out.append(spans[i].data, n);
+			len += n;
+		}
+		buf.erase(len);
+	}
+	return out;
+}
+
+TEST(ChainBuf, WriteAndErase) {
+	chain_buf buf(64);
+	std::string expected;
+	for (int i = 0; i < 200; i++) {
+		std::string piece(i % 37 + 1, char('a' + i % 26));
+		if (i % 10 == 0) {
+			// Big pieces are moved to buffer as chunks
+			piece.assign(0x1000 + i, char('A' + i % 26));
+			buf.write(chunk(std::string(piece)));
+		} else {
+			buf.write(piece.data(), piece.size());
+		}
+		expected += piece;
+		ASSERT_EQ(buf.size(), expected.size());
+	}
+	EXPECT_EQ(drain(buf, 3, 1000), expected);
+	EXPECT_EQ(buf.size(), 0u);
+
+	// Buffer is usable after drain
+	buf.write("xyz", 3);
+	EXPECT_EQ(drain(buf, 4, 1), "xyz");
+}
+
+TEST(ChainBuf, SerializerChunk) {
+	reindexer::WrSerializer small, big;
+	small.PutChars("small");
+	std::string expected = "small";
+	for (int i = 0; i < 10000; i++) {
+		big.PrintJsonString("item" + std::to_string(i));
+	}
+	expected.append(reinterpret_cast<const char *>(big.Buf()), big.Len());
+
+	chain_buf buf;
+	buf.write(small.DetachChunk());
+	buf.write(big.DetachChunk());
+	EXPECT_EQ(big.Len(), 0u);
+	EXPECT_EQ(small.Len(), 0u);
+
+	// Serializer is usable after its buffer was detached
+	big.PutChars("tail");
+	buf.write(big.DetachChunk());
+	expected += "tail";
+
+	EXPECT_EQ(drain(buf, 4, 0x10000), expected);
+}
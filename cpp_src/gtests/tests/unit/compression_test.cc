@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include "net/cproto/cproto.h"
+#include "tools/errors.h"
+#include "vendor/lz4/lz4.h"
+
+using namespace reindexer::net::cproto;
+using reindexer::string_view;
+
+static std::string compressible(size_t size, std::mt19937 &rnd) {
+	static const char *words[] = {"{\"id\":", "\"name\":\"", "\"year\":", "\"genre\":\"", "comedy", "drama", "\"},", "1998", "2010"};
+	std::string str;
+	while (str.size() < size) str += words[rnd() % (sizeof(words) / sizeof(words[0]))];
+	str.resize(size);
+	return str;
+}
+
+TEST(Compression, LZ4RoundTrip) {
+	std::mt19937 rnd(1);
+	for (size_t size : {0, 1, 5, 12, 13, 100, 4096, 70000, 300000}) {
+		for (int kind = 0; kind < 3; kind++) {
+			std::string src;
+			if (kind == 0) {
+				src = compressible(size, rnd);
+			} else if (kind == 1) {
+				for (size_t i = 0; i < size; i++) src.push_back(char(rnd()));
+			} else {
+				src.assign(size, 'a');
+			}
+
+			std::string packed(lz4::CompressBound(size), '\0');
+			packed.resize(lz4::Compress(src.data(), src.size(), &packed[0]));
+			std::string unpacked(size + 1, '\0');
+			long len = lz4::Decompress(packed.data(), packed.size(), &unpacked[0], unpacked.size());
+			ASSERT_EQ(len, long(size)) << "size=" << size << " kind=" << kind;
+			unpacked.resize(len);
+			ASSERT_EQ(src, unpacked) << "size=" << size << " kind=" << kind;
+		}
+	}
+}
+
+TEST(Compression, LZ4RejectsMalformedBlock) {
+	std::mt19937 rnd(2);
+	std::string src = compressible(10000, rnd);
+	std::string packed(lz4::CompressBound(src.size()), '\0');
+	packed.resize(lz4::Compress(src.data(), src.size(), &packed[0]));
+
+	// Output smaller than data
+	std::string unpacked(src.size(), '\0');
+	EXPECT_EQ(lz4::Decompress(packed.data(), packed.size(), &unpacked[0], src.size() - 1), -1);
+	// Truncated and corrupted blocks never write out of buffer
+	for (int i = 0; i < 1000; i++) {
+		std::string broken = packed.substr(0, rnd() % packed.size());
+		if (broken.size()) broken[rnd() % broken.size()] = char(rnd());
+		long len = lz4::Decompress(broken.data(), broken.size(), &unpacked[0], unpacked.size());
+		EXPECT_LE(len, long(unpacked.size()));
+	}
+}
+
+TEST(Compression, CprotoFrame) {
+	std::mt19937 rnd(3);
+	std::string packed, unpacked;
+
+	// Small frames are sent as is
+	std::string small = compressible(kCprotoMinCompressSize - 1, rnd);
+	EXPECT_FALSE(CompressFrame(small, packed));
+
+	std::string large = compressible(100000, rnd);
+	ASSERT_TRUE(CompressFrame(large, packed));
+	EXPECT_LT(packed.size(), large.size() / 2);
+	DecompressFrame(packed, unpacked);
+	EXPECT_EQ(unpacked, large);
+
+	// Incompressible frames are sent as is
+	std::string noise;
+	for (int i = 0; i < 10000; i++) noise.push_back(char(rnd()));
+	EXPECT_FALSE(CompressFrame(noise, packed));
+
+	EXPECT_THROW(DecompressFrame(string_view(packed.data(), 3), unpacked), reindexer::Error);
+}
@@ -33,14 +33,22 @@ TEST_F(JoinSelectsApi, AggregateFunctonsDSLTest) {
 	Query query = Query(books_namespace, 10, 100).Where(pages, CondGe, 150);
 
 	reindexer::AggregateEntry aggEntry;
-	aggEntry.index_ = price;
+	aggEntry.fields_ = {price};
 	aggEntry.type_ = AggAvg;
 	query.aggregations_.push_back(aggEntry);
 
-	aggEntry.index_ = pages;
+	aggEntry.fields_ = {pages};
 	aggEntry.type_ = AggSum;
 	query.aggregations_.push_back(aggEntry);
 
+	aggEntry.fields_ = {pages};
+	aggEntry.type_ = AggMax;
+	query.aggregations_.push_back(aggEntry);
+
+	aggEntry.fields_ = {pages, price};
+	aggEntry.type_ = AggFacet;
+	query.aggregations_.push_back(aggEntry);
+
 	string dsl = query.GetJSON();
 	Query testLoadDslQuery;
 	Error err = testLoadDslQuery.ParseJson(dsl);
@@ -125,10 +133,10 @@ TEST_F(JoinSelectsApi, GeneralDSLTest) {
 	testDslQuery.selectFunctions_.push_back("f2()");
 
 	reindexer::AggregateEntry aggEntry;
-	aggEntry.index_ = bookid;
+	aggEntry.fields_ = {bookid};
 	aggEntry.type_ = AggAvg;
 	testDslQuery.aggregations_.push_back(aggEntry);
-	aggEntry.index_ = genreid;
+	aggEntry.fields_ = {genreid};
 	aggEntry.type_ = AggSum;
 	testDslQuery.aggregations_.push_back(aggEntry);
 	const string dsl1 = testDslQuery.GetJSON();
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include "loop_thread.h"
+#include "net/http/serverconnection.h"
+#include "net/listener.h"
+#include "server/bulkitemsconsumer.h"
+
+using namespace reindexer;
+using namespace reindexer::net;
+using reindexer_server::BulkItemsConsumer;
+
+#ifndef _WIN32
+static const std::string kHTTPSocketPath = "/tmp/reindexer_http_bulk_test.sock";
+static const char *kBulkNs = "bulk_items";
+
+// Bulk route of HTTPServer without database manager and auth
+class BulkHandler {
+public:
+	BulkHandler(std::shared_ptr<Reindexer> db) : db_(db) {}
+	int Post(http::Context &ctx) {
+		int batchSize = atoi(ctx.request->params.Get("batch_size").ToString().c_str());
+		ctx.bodyConsumer.reset(new BulkItemsConsumer(db_, kBulkNs, batchSize > 0 ? batchSize : 1000));
+		return 0;
+	}
+
+protected:
+	std::shared_ptr<Reindexer> db_;
+};
+
+class HTTPBulkApi : public ::testing::Test {
+protected:
+	void SetUp() override {
+		db_ = std::make_shared<Reindexer>();
+		Error err = db_->OpenNamespace(kBulkNs);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = db_->AddIndex(kBulkNs, {"id", "id", "hash", "int", IndexOpts().PK()});
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		handler_.reset(new BulkHandler(db_));
+		router_.POST<BulkHandler, &BulkHandler::Post>("/bulk", handler_.get(), true);
+		listener_.reset(new Listener(server_.Loop(), http::ServerConnection::NewFactory(router_)));
+		ASSERT_TRUE(listener_->Bind("unix://" + kHTTPSocketPath));
+		server_.Run([this]() {
+			listener_->Stop();
+			listener_.reset();
+		});
+	}
+	void TearDown() override { server_.Stop(); }
+
+	// Sends raw request and returns raw responce. Connection is closed by server after responce
+	std::string request(const std::string &req) {
+		int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		EXPECT_GE(fd, 0);
+		struct sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		strncpy(addr.sun_path, kHTTPSocketPath.c_str(), sizeof(addr.sun_path) - 1);
+		struct timeval tv = {5, 0};
+		setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+		EXPECT_EQ(::connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)), 0);
+		EXPECT_EQ(::write(fd, req.data(), req.size()), ssize_t(req.size()));
+
+		std::string resp;
+		char buf[0x1000];
+		ssize_t n;
+		while ((n = ::read(fd, buf, sizeof(buf))) > 0) resp.append(buf, n);
+		::close(fd);
+		return resp;
+	}
+
+	std::string post(const std::string &headers, const std::string &body, const char *query = "") {
+		return request(std::string("POST /bulk") + query + " HTTP/1.1\r\nConnection: close\r\n" + headers + "\r\n" + body);
+	}
+
+	size_t count() {
+		QueryResults qr;
+		Error err = db_->Select(Query(kBulkNs), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	}
+
+	std::shared_ptr<Reindexer> db_;
+	std::unique_ptr<BulkHandler> handler_;
+	http::Router router_;
+	LoopThread server_;
+	std::unique_ptr<Listener> listener_;
+};
+
+static bool contains(const std::string &str, const std::string &sub) { return str.find(sub) != std::string::npos; }
+
+TEST_F(HTTPBulkApi, ContentLengthBody) {
+	// Item 2 does not match type of index, and is reported by its batch. Other items are upserted
+	std::string body = "{\"id\":0}\n{\"id\":1}\n{\"id\":\"x\"}\n{\"id\":3,\"data\":\"}{\"}\n{\"id\":4}\n";
+	auto resp = post("Content-Length: " + std::to_string(body.size()) + "\r\n", body, "?batch_size=2");
+	EXPECT_TRUE(contains(resp, "HTTP/1.1 200 ")) << resp;
+	EXPECT_TRUE(contains(resp, "\"success\":false,\"total_items\":5,\"updated\":4,\"batches\":[")) << resp;
+	EXPECT_TRUE(contains(resp, "{\"first_item\":0,\"items\":2,\"updated\":2,\"failed\":0,\"errors\":[]}")) << resp;
+	EXPECT_TRUE(contains(resp, "{\"first_item\":2,\"items\":2,\"updated\":1,\"failed\":1,\"errors\":[{\"item\":2,")) << resp;
+	EXPECT_TRUE(contains(resp, "{\"first_item\":4,\"items\":1,\"updated\":1,\"failed\":0,\"errors\":[]}")) << resp;
+	EXPECT_EQ(count(), 4u);
+}
+
+TEST_F(HTTPBulkApi, ChunkedBody) {
+	// Items are split between chunks
+	std::string body = "6\r\n[{\"id\"\r\n" + std::string("d\r\n:10},{\"id\":11\r\n") + "3\r\n}]\n\r\n" + "0\r\n\r\n";
+	auto resp = post("Transfer-Encoding: chunked\r\n", body);
+	EXPECT_TRUE(contains(resp, "HTTP/1.1 200 ")) << resp;
+	EXPECT_TRUE(contains(resp, "\"success\":true,\"total_items\":2,\"updated\":2,")) << resp;
+	EXPECT_EQ(count(), 2u);
+
+	resp = post("Transfer-Encoding: chunked\r\n", "zz\r\n{}\r\n0\r\n\r\n");
+	EXPECT_TRUE(contains(resp, "HTTP/1.1 400 ")) << resp;
+}
+
+TEST_F(HTTPBulkApi, EmptyBody) {
+	auto resp = post("Content-Length: 0\r\n", "");
+	EXPECT_TRUE(contains(resp, "HTTP/1.1 200 ")) << resp;
+	EXPECT_TRUE(contains(resp, "\"success\":true,\"total_items\":0,\"updated\":0,\"batches\":[]")) << resp;
+	EXPECT_EQ(count(), 0u);
+}
+
+TEST_F(HTTPBulkApi, MalformedBody) {
+	// Syntax error stops processing of body. Items before it are upserted
+	std::string body = "{\"id\":1} x {\"id\":2}";
+	auto resp = post("Content-Length: " + std::to_string(body.size()) + "\r\n", body);
+	EXPECT_TRUE(contains(resp, "HTTP/1.1 400 ")) << resp;
+	EXPECT_TRUE(contains(resp, "\"description\":\"Unexpected character 'x' after item 1\"")) << resp;
+	EXPECT_EQ(count(), 1u);
+
+	for (const char *len : {"-5", "abc", "12abc", ""}) {
+		resp = post(std::string("Content-Length: ") + len + "\r\n", "{\"id\":3}");
+		EXPECT_TRUE(contains(resp, "HTTP/1.1 400 ")) << len << ": " << resp;
+	}
+	EXPECT_EQ(count(), 1u);
+}
+#endif
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+
+#include "estl/hyperloglog.h"
+
+using reindexer::HyperLogLog;
+
+TEST(HyperLogLog, EstimateCardinality) {
+	for (uint64_t cardinality : {0, 1, 100, 10000, 1000000}) {
+		HyperLogLog sketch;
+		// Each value is added several times - duplicates must not affect estimation
+		for (int pass = 0; pass < 3; pass++) {
+			for (uint64_t i = 0; i < cardinality; i++) sketch.Add(HyperLogLog::Mix(i));
+		}
+		EXPECT_NEAR(sketch.Estimate(), cardinality, 1 + cardinality * 0.03) << "Cardinality " << cardinality;
+	}
+}
+
+TEST(HyperLogLog, MergeSketches) {
+	const uint64_t count = 100000;
+	HyperLogLog lhs, rhs;
+	// Sets are intersected by half of values
+	for (uint64_t i = 0; i < count; i++) lhs.Add(HyperLogLog::Mix(i));
+	for (uint64_t i = count / 2; i < count + count / 2; i++) rhs.Add(HyperLogLog::Mix(i));
+
+	lhs.Merge(rhs);
+	EXPECT_NEAR(lhs.Estimate(), count + count / 2, (count + count / 2) * 0.03);
+
+	lhs.Clear();
+	EXPECT_EQ(lhs.Estimate(), 0);
+}
@@ -0,0 +1,169 @@
+#include "core/cjson/msgpackencoder.h"
+#include "reindexer_api.h"
+#include "tools/serializer.h"
+
+using reindexer::WrSerializer;
+
+class MsgPackApi : public ReindexerApi {
+public:
+	void SetUp() override {
+		ReindexerApi::SetUp();
+		Error err = reindexer->OpenNamespace(default_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+		DefineNamespaceDataset(default_namespace, {IndexDeclaration{"id", "hash", "int", IndexOpts().PK()},
+												   IndexDeclaration{"price", "tree", "double", IndexOpts()},
+												   IndexDeclaration{"tags", "hash", "string", IndexOpts().Array()}});
+	}
+
+	void upsertJSON(const string &json) {
+		Item item = NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		Error err = item.FromJSON(json);
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+
+	// Decode MessagePack value to JSON, printed the same way, as JSON encoder does
+	static void toJSON(reindexer::string_view &data, WrSerializer &ser) {
+		auto get = [&data](int n) {
+			uint64_t v = 0;
+			for (int i = 0; i < n; i++) v = (v << 8) | uint8_t(data[i]);
+			data = data.substr(n);
+			return v;
+		};
+		auto str = [&](size_t len) {
+			ser.PrintJsonString(data.substr(0, len));
+			data = data.substr(len);
+		};
+		auto arr = [&](size_t len) {
+			ser.PutChar('[');
+			for (size_t i = 0; i < len; i++) {
+				if (i) ser.PutChar(',');
+				toJSON(data, ser);
+			}
+			ser.PutChar(']');
+		};
+		auto map = [&](size_t len) {
+			ser.PutChar('{');
+			for (size_t i = 0; i < len; i++) {
+				if (i) ser.PutChar(',');
+				toJSON(data, ser);
+				ser.PutChar(':');
+				toJSON(data, ser);
+			}
+			ser.PutChar('}');
+		};
+
+		uint8_t code = get(1);
+		if (code < 0x80) return ser.Print(int64_t(code));
+		if (code >= 0xe0) return ser.Print(int64_t(int8_t(code)));
+		if ((code & 0xf0) == 0x80) return map(code & 0xf);
+		if ((code & 0xf0) == 0x90) return arr(code & 0xf);
+		if ((code & 0xe0) == 0xa0) return str(code & 0x1f);
+		switch (code) {
+			case 0xc0:
+				return ser.PutChars("null");
+			case 0xc2:
+				return ser.PutChars("false");
+			case 0xc3:
+				return ser.PutChars("true");
+			case 0xcb: {
+				uint64_t bits = get(8);
+				double v;
+				memcpy(&v, &bits, sizeof(v));
+				return ser.Printf("%.20g", v);
+			}
+			case 0xcc:
+				return ser.Print(int64_t(get(1)));
+			case 0xcd:
+				return ser.Print(int64_t(get(2)));
+			case 0xce:
+				return ser.Print(int64_t(get(4)));
+			case 0xcf:
+				return ser.Print(int64_t(get(8)));
+			case 0xd0:
+				return ser.Print(int64_t(int8_t(get(1))));
+			case 0xd1:
+				return ser.Print(int64_t(int16_t(get(2))));
+			case 0xd2:
+				return ser.Print(int64_t(int32_t(get(4))));
+			case 0xd3:
+				return ser.Print(int64_t(get(8)));
+			case 0xd9:
+				return str(get(1));
+			case 0xda:
+				return str(get(2));
+			case 0xdb:
+				return str(get(4));
+			case 0xdc:
+				return arr(get(2));
+			case 0xdd:
+				return arr(get(4));
+			case 0xde:
+				return map(get(2));
+			case 0xdf:
+				return map(get(4));
+			default:
+				FAIL() << "Unexpected msgpack code " << int(code);
+		}
+	}
+
+	const string default_namespace = "msgpack_namespace";
+};
+
+TEST_F(MsgPackApi, SameAsJSON) {
+	string wide = "{\"id\":3";
+	for (int i = 0; i < 40; i++) wide += ",\"f" + std::to_string(i) + "\":" + std::to_string(i * 1000);
+	wide += "}";
+
+	upsertJSON(R"({"id":1,"price":1.5,"tags":["a","b"],"name":"item \"1\"","flag":true,"none":null})");
+	upsertJSON(R"({"id":2,"price":-3,"neg":[-1,-33,-200,-40000,-3000000000],"pos":[127,255,65535,4294967295,4294967296],)"
+			   R"("nested":{"obj":{"x":[{"a":1},{"b":[true,false]}]},"empty":{}},"tags":[]})");
+	upsertJSON(wide);
+	upsertJSON("{\"id\":4,\"long\":\"" + string(40, 'x') + "\",\"longer\":\"" + string(300, 'y') + "\",\"longest\":\"" +
+			   string(70000, 'z') + "\"}");
+
+	QueryResults qr;
+	Error err = reindexer->Select(Query(default_namespace), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 4u);
+
+	for (auto it : qr) {
+		WrSerializer json, msgpack, decoded;
+		it.GetJSON(json, false);
+		it.GetMsgPack(msgpack);
+		reindexer::string_view data = msgpack.Slice();
+		toJSON(data, decoded);
+		EXPECT_EQ(data.size(), 0u);
+		EXPECT_EQ(decoded.Slice().ToString(), json.Slice().ToString());
+		EXPECT_LT(msgpack.Len(), json.Len());
+	}
+}
+
+TEST_F(MsgPackApi, Primitives) {
+	for (int64_t v : {0LL, 1LL, 127LL, 128LL, 255LL, 256LL, 65535LL, 65536LL, 4294967295LL, 4294967296LL, -1LL, -32LL, -33LL, -128LL,
+					  -129LL, -32768LL, -32769LL, -2147483648LL, -2147483649LL}) {
+		WrSerializer ser, decoded;
+		reindexer::msgpack::putInt(ser, v);
+		reindexer::string_view data = ser.Slice();
+		toJSON(data, decoded);
+		EXPECT_EQ(decoded.Slice().ToString(), std::to_string(v));
+	}
+
+	// Size of map is written after its fields
+	for (uint32_t size : {0, 15, 16, 65535, 65536}) {
+		WrSerializer ser, decoded;
+		size_t pos = reindexer::msgpack::beginMap(ser);
+		for (uint32_t i = 0; i < size; i++) {
+			reindexer::msgpack::putInt(ser, i);
+			reindexer::msgpack::putNil(ser);
+		}
+		reindexer::msgpack::endMap(ser, pos, size);
+		reindexer::string_view data = ser.Slice();
+		toJSON(data, decoded);
+		EXPECT_EQ(data.size(), 0u);
+		string expected = "{";
+		for (uint32_t i = 0; i < size; i++) expected += (i ? "," : "") + std::to_string(i) + ":null";
+		EXPECT_EQ(decoded.Slice().ToString(), expected + "}");
+	}
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "core/ft/idrelset.h"
+
+using reindexer::IdRelSet;
+using reindexer::IdRelType;
+using reindexer::PackedIdRelSet;
+using reindexer::VDocIdType;
+
+static IdRelSet makeIdRelSet(int count) {
+	IdRelSet set;
+	VDocIdType id = 0;
+	for (int i = 0; i < count; i++) {
+		// Gaps of different size to use all widths of ids deltas
+		id += 1 + (i % 3 == 0 ? 1 : 0) + (i % 300 == 0 ? 1000 : 0) + (i % 1000 == 0 ? 100000 : 0);
+		for (int p = 0; p < 1 + i % 5; p++) set.Add(id, p * 7 + i % 11, p % 2);
+	}
+	set.Commit();
+	return set;
+}
+
+TEST(PackedIdRelSet, PackAndIterate) {
+	IdRelSet set = makeIdRelSet(1000);
+	PackedIdRelSet packed;
+	packed.Pack(set);
+
+	ASSERT_EQ(packed.size(), set.size());
+	EXPECT_EQ(packed.Blocks().size(), (set.size() + PackedIdRelSet::kBlockSize - 1) / PackedIdRelSet::kBlockSize);
+
+	size_t i = 0;
+	for (auto it = packed.begin(); it != packed.end(); ++it, i++) {
+		ASSERT_LT(i, set.size());
+		EXPECT_EQ(it.Id(), set[i].id);
+		EXPECT_EQ(it.Rank(), std::min(set[i].rank(), 0xFF));
+		// Positions are unpacked only for odd entries, even entries are skipped
+		if (i % 2) {
+			IdRelType &rel = *it;
+			EXPECT_EQ(rel.id, set[i].id);
+			ASSERT_EQ(rel.pos.size(), set[i].pos.size());
+			for (size_t p = 0; p < rel.pos.size(); p++) EXPECT_EQ(rel.pos[p].fpos, set[i].pos[p].fpos);
+		}
+	}
+	EXPECT_EQ(i, set.size());
+}
+
+TEST(PackedIdRelSet, SkipTo) {
+	IdRelSet set = makeIdRelSet(1000);
+	PackedIdRelSet packed;
+	packed.Pack(set);
+
+	for (size_t i = 0; i < set.size(); i += 97) {
+		auto it = packed.begin();
+		it.SkipTo(set[i].id);
+		ASSERT_TRUE(it != packed.end());
+		EXPECT_EQ(it.Id(), set[i].id);
+		EXPECT_EQ(it->pos.size(), set[i].pos.size());
+
+		// Skip to id, which is absent in set
+		it = packed.begin();
+		it.SkipTo(set[i].id + 1);
+		if (i + 1 < set.size()) {
+			ASSERT_TRUE(it != packed.end());
+			EXPECT_EQ(it.Id(), set[i + 1].id);
+		}
+	}
+
+	auto it = packed.begin();
+	it.SkipTo(set.back().id + 1);
+	EXPECT_TRUE(it == packed.end());
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include "loop_thread.h"
+#include "net/cproto/clientconnection.h"
+#include "net/cproto/dispatcher.h"
+#include "net/cproto/serverconnection.h"
+#include "net/listener.h"
+#include "net/workerpool.h"
+
+using namespace reindexer;
+using namespace reindexer::net;
+
+#ifndef _WIN32
+static const std::string kRPCSocketAddr = "unix:///tmp/reindexer_rpc_workers_test.sock";
+
+// Handlers throw, like handlers of RPCServer do on invalid query id or malformed query
+class ThrowingRPC {
+public:
+	Error Login(cproto::Context &, p_string, p_string, p_string) { return 0; }
+	Error Ping(cproto::Context &) { return 0; }
+	Error FetchResults(cproto::Context &, int id) { throw Error(errLogic, "Invalid query id %d", id); }
+	Error Select(cproto::Context &) { throw std::runtime_error("Malformed query"); }
+};
+
+TEST(RPCWorkers, HandlerThrows) {
+	ThrowingRPC rpc;
+	cproto::Dispatcher dispatcher;
+	dispatcher.Register(cproto::kCmdLogin, &rpc, &ThrowingRPC::Login);
+	dispatcher.Register(cproto::kCmdPing, &rpc, &ThrowingRPC::Ping);
+	dispatcher.Register(cproto::kCmdFetchResults, &rpc, &ThrowingRPC::FetchResults);
+	dispatcher.Register(cproto::kCmdSelect, &rpc, &ThrowingRPC::Select);
+	WorkerPool pool(2, 0);
+
+	LoopThread server;
+	std::unique_ptr<Listener> listener(new Listener(server.Loop(), cproto::ServerConnection::NewFactory(dispatcher, &pool)));
+	ASSERT_TRUE(listener->Bind(kRPCSocketAddr));
+	server.Run([&listener]() {
+		listener->Stop();
+		listener.reset();
+	});
+
+	LoopThread client;
+	std::unique_ptr<cproto::ClientConnection> conn(new cproto::ClientConnection(client.Loop()));
+	ASSERT_TRUE(conn->Connect(kRPCSocketAddr, "", "", "db"));
+	client.Run([&conn]() { conn.reset(); });
+
+	// Calls are answered by error of handler, and connection is still usable
+	for (int i = 0; i < 10; i++) {
+		Error err = conn->Call(cproto::kCmdFetchResults, 12345 + i).Status();
+		EXPECT_EQ(err.code(), errLogic);
+		EXPECT_EQ(err.what(), "Invalid query id " + std::to_string(12345 + i));
+		err = conn->Call(cproto::kCmdSelect).Status();
+		EXPECT_EQ(err.code(), errLogic);
+		EXPECT_EQ(err.what(), "Malformed query");
+		EXPECT_TRUE(conn->Call(cproto::kCmdPing).Status().ok());
+	}
+	EXPECT_TRUE(conn->IsValid());
+
+	client.Stop();
+	server.Stop();
+	pool.Stop();
+}
+#endif
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include "client/reindexer.h"
+#include "loop_thread.h"
+#include "net/cproto/dispatcher.h"
+#include "net/cproto/serverconnection.h"
+#include "net/listener.h"
+
+using namespace reindexer;
+using namespace reindexer::net;
+
+#ifndef _WIN32
+static const std::string kRPCSocketPath = "/tmp/reindexer_rpcclient_dsn_test.sock";
+
+// Remembers credentials and database of login, and namespace of last call
+class LoginRPC {
+public:
+	Error Login(cproto::Context &, p_string login, p_string password, p_string db) {
+		login_ = login.toString();
+		password_ = password.toString();
+		db_ = db.toString();
+		return 0;
+	}
+	Error Ping(cproto::Context &) { return 0; }
+	Error CloseNamespace(cproto::Context &, p_string ns) {
+		ns_ = ns.toString();
+		return 0;
+	}
+
+	std::string login_, password_, db_, ns_;
+};
+
+TEST(RPCClientDSN, UnixSocket) {
+	LoginRPC rpc;
+	cproto::Dispatcher dispatcher;
+	dispatcher.Register(cproto::kCmdLogin, &rpc, &LoginRPC::Login);
+	dispatcher.Register(cproto::kCmdPing, &rpc, &LoginRPC::Ping);
+	dispatcher.Register(cproto::kCmdCloseNamespace, &rpc, &LoginRPC::CloseNamespace);
+
+	LoopThread server;
+	std::unique_ptr<Listener> listener(new Listener(server.Loop(), cproto::ServerConnection::NewFactory(dispatcher, nullptr)));
+	ASSERT_TRUE(listener->Bind("unix://" + kRPCSocketPath));
+	server.Run([&listener]() {
+		listener->Stop();
+		listener.reset();
+	});
+
+	{
+		// Path of socket is separated from database by last ':/'
+		client::Reindexer db;
+		Error err = db.Connect("unix://user:pass@" + kRPCSocketPath + ":/testdb");
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = db.CloseNamespace("items");
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(rpc.login_, "user");
+		EXPECT_EQ(rpc.password_, "pass");
+		EXPECT_EQ(rpc.db_, "testdb");
+		EXPECT_EQ(rpc.ns_, "items");
+	}
+
+	// Database is required
+	client::Reindexer db;
+	Error err = db.Connect("unix://" + kRPCSocketPath);
+	EXPECT_EQ(err.code(), errParams);
+
+	server.Stop();
+}
+#endif
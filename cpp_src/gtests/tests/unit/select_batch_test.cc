@@ -0,0 +1,111 @@
+#include <algorithm>
+#include "reindexer_api.h"
+
+using reindexer::SelectCursor;
+
+class SelectBatchApi : public ReindexerApi {
+public:
+	void SetUp() override {
+		ReindexerApi::SetUp();
+		Error err = reindexer->OpenNamespace(default_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+		DefineNamespaceDataset(default_namespace, {IndexDeclaration{"id", "hash", "int", IndexOpts().PK()},
+												   IndexDeclaration{"year", "tree", "int", IndexOpts()}});
+		for (int i = 0; i < kItems; i++) upsertItem(i, rand() % 50);
+		err = Commit(default_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	void upsertItem(int id, int year) {
+		Item item = NewItem(default_namespace);
+		item["id"] = id;
+		item["year"] = year;
+		Upsert(default_namespace, item);
+	}
+
+	vector<int> select(const Query &q) {
+		QueryResults qr;
+		Error err = reindexer->Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return ids(qr);
+	}
+
+	vector<int> selectBatches(const Query &q, unsigned batchSize, SelectCursor &cursor) {
+		vector<int> res;
+		while (!cursor.Done()) {
+			QueryResults qr;
+			Error err = reindexer->SelectBatch(q, qr, cursor, batchSize);
+			EXPECT_TRUE(err.ok()) << err.what();
+			if (!err.ok()) break;
+			EXPECT_TRUE(qr.Count() <= batchSize || !cursor.Streamed());
+			for (int id : ids(qr)) res.push_back(id);
+		}
+		EXPECT_EQ(cursor.Returned(), res.size());
+		return res;
+	}
+
+	vector<int> ids(const QueryResults &qr) {
+		vector<int> res;
+		for (auto it : qr) res.push_back(it.GetItem()["id"].Get<int>());
+		return res;
+	}
+
+	const string default_namespace = "select_batch_namespace";
+	const int kItems = 1000;
+};
+
+TEST_F(SelectBatchApi, SameResultsAsSelect) {
+	vector<Query> queries = {Query(default_namespace),
+							 Query(default_namespace).Sort("year", false),
+							 Query(default_namespace).Sort("year", true),
+							 Query(default_namespace).Where("year", CondGt, 10).Sort("year", false).Offset(17).Limit(333),
+							 Query(default_namespace).Where("year", CondLt, 20),
+							 Query(default_namespace).Where("year", CondEq, 7).Sort("year", true).Limit(10)};
+
+	for (auto &q : queries) {
+		for (unsigned batchSize : {1, 7, 100, 5000}) {
+			SelectCursor cursor;
+			vector<int> batches = selectBatches(q, batchSize, cursor), expected = select(q);
+			// Order of unsorted results is not defined
+			if (q.sortingEntries_.empty()) {
+				std::sort(batches.begin(), batches.end());
+				std::sort(expected.begin(), expected.end());
+			}
+			EXPECT_EQ(batches, expected) << q.Dump() << ", batch size " << batchSize;
+			EXPECT_TRUE(cursor.Streamed());
+		}
+	}
+}
+
+TEST_F(SelectBatchApi, NotStreamedQuery) {
+	// Results of query with total count and query sorted by non-ordered index are returned by single batch
+	for (auto &q : {Query(default_namespace).ReqTotal(), Query(default_namespace).Sort("id", false)}) {
+		SelectCursor cursor;
+		EXPECT_EQ(selectBatches(q, 10, cursor), select(q));
+		EXPECT_FALSE(cursor.Streamed());
+	}
+}
+
+TEST_F(SelectBatchApi, ModificationsBetweenBatches) {
+	Query q = Query(default_namespace).Sort("year", false);
+	SelectCursor cursor;
+	vector<int> res;
+	int nextId = kItems;
+	while (!cursor.Done()) {
+		QueryResults qr;
+		Error err = reindexer->SelectBatch(q, qr, cursor, 50);
+		ASSERT_TRUE(err.ok()) << err.what();
+		for (auto it : qr) {
+			Item item = it.GetItem();
+			if (!res.empty()) {
+				ASSERT_LE(res.back(), item["year"].Get<int>());
+			}
+			res.push_back(item["year"].Get<int>());
+		}
+		// Sort orders are rebuilt by commit, cursor must continue from the same item
+		upsertItem(nextId++, rand() % 50);
+		err = Commit(default_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	EXPECT_GE(int(res.size()), kItems);
+}
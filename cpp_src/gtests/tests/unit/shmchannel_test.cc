@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include "net/shmchannel.h"
+#include "net/socket.h"
+
+using reindexer::chain_buf;
+using reindexer::net::ShmChannel;
+
+#ifdef __linux__
+static bool signalled(int fd) {
+	struct pollfd pfd = {fd, POLLIN, 0};
+	return ::poll(&pfd, 1, 0) == 1;
+}
+
+static ssize_t send(ShmChannel &ch, const std::string &data) {
+	chain_buf::span span{data.data(), data.size()};
+	return ch.Send(&span, 1);
+}
+
+// Descriptors of channel are passed by unix socket, as server does
+static ShmChannel *open(const ShmChannel &server) {
+	int sv[2];
+	if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) return nullptr;
+	reindexer::net::socket a(sv[0]), b(sv[1]);
+	int fds[ShmChannel::kFdsCount], cnt = ShmChannel::kFdsCount;
+	char c = 0;
+	bool ok = a.send_fds(&c, 1, server.Fds(), ShmChannel::kFdsCount) == 1 && b.recv_fds(&c, 1, fds, cnt) == 1;
+	a.close();
+	b.close();
+	return ok && cnt == ShmChannel::kFdsCount ? ShmChannel::Open(fds) : nullptr;
+}
+
+TEST(ShmChannel, Exchange) {
+	std::unique_ptr<ShmChannel> server(ShmChannel::Create(1000));
+	ASSERT_TRUE(server);
+	EXPECT_EQ(server->RingSize(), ShmChannel::kMinRingSize);
+	std::unique_ptr<ShmChannel> client(open(*server));
+	ASSERT_TRUE(client);
+	EXPECT_EQ(client->RingSize(), server->RingSize());
+
+	char buf[0x100];
+	EXPECT_EQ(server->Recv(buf, sizeof(buf)), -1);
+	EXPECT_EQ(errno, EAGAIN);
+	EXPECT_FALSE(server->Readable());
+
+	// Server waits for request, so it is signalled
+	ASSERT_EQ(send(*client, "request"), 7);
+	EXPECT_TRUE(signalled(server->EventFd()));
+	EXPECT_TRUE(server->Readable());
+	server->ResetEvent();
+	EXPECT_FALSE(signalled(server->EventFd()));
+	ASSERT_EQ(server->Recv(buf, sizeof(buf)), 7);
+	EXPECT_EQ(std::string(buf, 7), "request");
+
+	ASSERT_EQ(send(*server, "responce"), 8);
+	EXPECT_TRUE(signalled(client->EventFd()));
+	ASSERT_EQ(client->Recv(buf, 3), 3);
+	EXPECT_EQ(std::string(buf, 3), "res");
+	client->ResetEvent();
+	// Client has not waited for data, so it is not signalled
+	ASSERT_EQ(send(*server, "!"), 1);
+	EXPECT_FALSE(signalled(client->EventFd()));
+	ASSERT_EQ(client->Recv(buf, sizeof(buf)), 6);
+	EXPECT_EQ(std::string(buf, 6), "ponce!");
+}
+
+TEST(ShmChannel, FullRing) {
+	std::unique_ptr<ShmChannel> server(ShmChannel::Create(ShmChannel::kMinRingSize));
+	ASSERT_TRUE(server);
+	std::unique_ptr<ShmChannel> client(open(*server));
+	ASSERT_TRUE(client);
+	const size_t ringSize = server->RingSize();
+
+	std::string sent, received;
+	for (size_t i = 0; i < 3 * ringSize; i++) sent += char('a' + i % 23);
+
+	// Writer stops on full ring, and it is signalled, when reader frees space. Data wraps around end of ring
+	size_t written = 0;
+	std::unique_ptr<char[]> buf(new char[ringSize]);
+	while (received.size() < sent.size()) {
+		if (written < sent.size()) {
+			// Several spans are written by one call
+			size_t half = (sent.size() - written) / 2;
+			chain_buf::span spans[2] = {{sent.data() + written, half}, {sent.data() + written + half, sent.size() - written - half}};
+			ssize_t n = server->Send(spans, 2);
+			ASSERT_GT(n, 0);
+			written += n;
+			if (written < sent.size()) {
+				EXPECT_EQ(server->Send(spans + 1, 1), -1);
+				EXPECT_EQ(errno, EAGAIN);
+				EXPECT_FALSE(signalled(server->EventFd()));
+			}
+		}
+		ssize_t n = client->Recv(buf.get(), ringSize * 2 / 3);
+		ASSERT_GT(n, 0);
+		received.append(buf.get(), n);
+		if (written < sent.size()) {
+			EXPECT_TRUE(signalled(server->EventFd()));
+			server->ResetEvent();
+		}
+	}
+	EXPECT_EQ(received, sent);
+}
+
+TEST(ShmChannel, CorruptedByPeer) {
+	std::unique_ptr<ShmChannel> server(ShmChannel::Create(ShmChannel::kMinRingSize));
+	ASSERT_TRUE(server);
+	std::unique_ptr<ShmChannel> client(open(*server));
+	ASSERT_TRUE(client);
+
+	// Memory can't be resized by client
+	EXPECT_NE(::ftruncate(client->Fds()[0], 0), 0);
+	EXPECT_NE(::ftruncate(client->Fds()[0], 16 * ShmChannel::kMinRingSize), 0);
+
+	// Client overwrites indexes of both rings, which follow magic and size in header
+	const size_t kHeaderSize = 0x1000;
+	void *mem = ::mmap(nullptr, kHeaderSize, PROT_READ | PROT_WRITE, MAP_SHARED, client->Fds()[0], 0);
+	ASSERT_NE(mem, MAP_FAILED);
+	memset(static_cast<char *>(mem) + 8, 0x7F, kHeaderSize - 8);
+	::munmap(mem, kHeaderSize);
+
+	std::unique_ptr<char[]> buf(new char[4 * ShmChannel::kMinRingSize]);
+	EXPECT_EQ(server->Recv(buf.get(), 4 * ShmChannel::kMinRingSize), -1);
+	EXPECT_EQ(errno, EPROTO);
+	EXPECT_EQ(send(*server, "responce"), -1);
+	EXPECT_EQ(errno, EPROTO);
+}
+
+TEST(ShmChannel, InvalidDescriptors) {
+	int fds[ShmChannel::kFdsCount] = {-1, -1, -1};
+	std::unique_ptr<ShmChannel> ch(ShmChannel::Open(fds));
+	EXPECT_FALSE(ch);
+}
+#endif
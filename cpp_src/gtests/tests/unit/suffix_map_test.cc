@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include "estl/suffix_map.h"
+
+using reindexer::suffix_map;
+
+static std::vector<std::string> makeWords(size_t count) {
+	std::vector<std::string> words = {"terminator", "termin", "term", "в", "вектор", "ab", "ab", "b"};
+	srand(1);
+	// Half of words are cyrillic: all their letters have the same first byte in utf8
+	const char *cyrillic[] = {"а", "б", "в", "г"};
+	while (words.size() < count) {
+		std::string word;
+		int len = 1 + rand() % 10;
+		bool latin = words.size() % 2;
+		for (int i = 0; i < len; i++) word += latin ? std::string(1, char('a' + rand() % 4)) : cyrillic[rand() % 4];
+		words.push_back(word);
+	}
+	return words;
+}
+
+TEST(SuffixMap, MatchRangeInShards) {
+	auto words = makeWords(20000);
+	for (int threads : {1, 4}) {
+		suffix_map<std::string, int> suffixes;
+		for (int i = 0; i < int(words.size()); i++) suffixes.insert(words[i], i);
+		suffixes.build(threads);
+
+		for (std::string pattern : {"term", "termin", "terminatorx", "a", "ab", "abcd", "dd", "ddddddddddd", "в", "ектор", "x", "b", "аб", "гггг",
+									"бвгабв", "\xD0", "\xB0\xD0"}) {
+			// Expected suffixes: pairs of word id and offset of suffix, which starts with pattern
+			std::multiset<std::pair<int, long>> expected, found;
+			for (int i = 0; i < int(words.size()); i++) {
+				for (size_t offset = 0; offset < words[i].length(); offset++) {
+					if (words[i].compare(offset, pattern.length(), pattern) == 0) expected.emplace(i, offset);
+				}
+			}
+
+			auto rng = suffixes.match_range(pattern);
+			for (auto it = rng.first; it != rng.second; ++it) {
+				ASSERT_EQ(strncmp(it->first, pattern.c_str(), pattern.length()), 0) << pattern;
+				found.emplace(it->second, it->first - suffixes.word_at(it->second));
+			}
+			EXPECT_EQ(found, expected) << "Pattern '" << pattern << "', threads " << threads;
+
+			// The same suffixes are walked from lower_bound by lcp
+			if (!expected.empty()) {
+				auto it = suffixes.lower_bound(pattern);
+				size_t count = 1;
+				while (it.lcp() >= int(pattern.length())) ++it, ++count;
+				EXPECT_EQ(count, expected.size()) << pattern;
+			} else {
+				EXPECT_TRUE(suffixes.lower_bound(pattern) == suffixes.end()) << pattern;
+			}
+		}
+	}
+}
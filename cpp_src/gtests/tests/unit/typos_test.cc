@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <set>
+#include "core/ft/typos.h"
+#include "core/ft/typosmap.h"
+#include "tools/stringstools.h"
+
+using reindexer::TyposMap;
+
+TEST(Typos, TyposMapMatchesGeneratedTypos) {
+	const int maxTypos = 2, maxTypoLen = 8;
+	std::vector<std::string> words = {"a", "ab", "abc", "abcd", "abcc", "terminator", "termin", "тест", "тесты", "ab", "bca", "cab"};
+
+	// Reference: typos, generated by mktypos for each word
+	reindexer::typos_context tctx[reindexer::kMaxTyposInWord];
+	std::map<std::string, std::set<int>> expected;
+	std::vector<std::vector<TyposMap::Entry>> parts(2);
+	for (int wordId = 0; wordId < int(words.size()); wordId++) {
+		reindexer::mktypos(tctx, words[wordId].c_str(), maxTypos, maxTypoLen, [&](const std::string &typo, int) {
+			expected[typo].insert(wordId);
+			parts[wordId % 2].push_back({TyposMap::Signature(typo), wordId});
+		});
+	}
+
+	TyposMap typos;
+	typos.Build(std::move(parts));
+	EXPECT_GT(typos.heap_size(), 0u);
+
+	for (auto &typo : expected) {
+		// Candidates from map, verified by istypo, must be exactly the words, which generated typo
+		std::set<int> found;
+		auto rng = typos.Find(typo.first);
+		for (auto it = rng.first; it != rng.second; it++) {
+			if (reindexer::istypo(reindexer::utf8_to_utf16(words[it->wordId]), reindexer::utf8_to_utf16(typo.first), maxTypos, maxTypoLen))
+				found.insert(it->wordId);
+		}
+		EXPECT_EQ(found, typo.second) << "Typo '" << typo.first << "'";
+	}
+
+	// Words, which did not generate typo, must be rejected
+	for (int wordId = 0; wordId < int(words.size()); wordId++) {
+		auto word = reindexer::utf8_to_utf16(words[wordId]);
+		for (auto &typo : expected) {
+			bool generated = typo.second.count(wordId) != 0;
+			EXPECT_EQ(reindexer::istypo(word, reindexer::utf8_to_utf16(typo.first), maxTypos, maxTypoLen), generated)
+				<< "Word '" << words[wordId] << "', typo '" << typo.first << "'";
+		}
+	}
+
+	typos.clear();
+	EXPECT_TRUE(typos.empty());
+	auto rng = typos.Find("abc");
+	EXPECT_EQ(rng.first, rng.second);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include "net/socket.h"
+
+using reindexer::net::socket;
+
+#ifndef _WIN32
+static const std::string kSocketPath = "/tmp/reindexer_unix_socket_test.sock";
+static const std::string kSocketAddr = "unix://" + kSocketPath;
+
+// Call op until it does not block
+template <typename Op>
+static int retry(Op op) {
+	for (int i = 0; i < 1000; i++) {
+		int ret = op();
+		if (ret >= 0 || !socket::would_block(socket::last_error())) return ret;
+		usleep(1000);
+	}
+	return -1;
+}
+
+TEST(UnixSocket, Address) {
+	EXPECT_TRUE(socket::is_unix_addr(kSocketAddr.c_str()));
+	EXPECT_FALSE(socket::is_unix_addr("127.0.0.1:6534"));
+	EXPECT_EQ(std::string(socket::unix_path(kSocketAddr.c_str())), kSocketPath);
+}
+
+TEST(UnixSocket, BindConnectAccept) {
+	// File of closed socket is replaced by bind
+	socket stale;
+	ASSERT_EQ(stale.bind(kSocketAddr.c_str()), 0);
+	ASSERT_TRUE(stale.valid());
+	stale.close();
+
+	socket server;
+	ASSERT_EQ(server.bind(kSocketAddr.c_str()), 0);
+	ASSERT_TRUE(server.valid());
+	ASSERT_EQ(server.listen(10), 0);
+
+	socket client;
+	ASSERT_EQ(client.connect(kSocketAddr.c_str()), 0);
+	ASSERT_TRUE(client.valid());
+	socket conn;
+	retry([&]() {
+		conn = server.accept();
+		return conn.fd();
+	});
+	ASSERT_TRUE(conn.valid());
+
+	const std::string msg = "ping";
+	ASSERT_EQ(retry([&]() { return client.send(msg.data(), msg.size()); }), int(msg.size()));
+	char buf[16];
+	ASSERT_EQ(retry([&]() { return conn.recv(buf, sizeof(buf)); }), int(msg.size()));
+	EXPECT_EQ(std::string(buf, msg.size()), msg);
+
+	// Socket, which is listened, is not replaced
+	socket second;
+	second.bind(kSocketAddr.c_str());
+	EXPECT_FALSE(second.valid());
+
+	conn.close();
+	client.close();
+	server.close();
+	unlink(kSocketPath.c_str());
+}
+#endif
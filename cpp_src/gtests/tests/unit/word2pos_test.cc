@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include "tools/stringstools.h"
+
+using reindexer::Word2PosHelper;
+
+TEST(Word2PosHelper, ConvertPositions) {
+	const std::string text = "  Первое, second-word;third  четвёртое5 x";
+	const std::string extraWordSymbols = "-";
+	// Expected byte offsets of words
+	std::vector<std::pair<int, int>> words;
+	for (const char* word : {"Первое", "second-word", "third", "четвёртое5", "x"}) {
+		int pos = text.find(word);
+		words.push_back({pos, int(pos + strlen(word))});
+	}
+
+	Word2PosHelper word2pos(text, extraWordSymbols);
+	for (int i = 0; i < int(words.size()); i++) {
+		EXPECT_EQ(word2pos.convert(i, i + 1), words[i]) << i;
+	}
+	// Ranges of words and positions in random order
+	EXPECT_EQ(word2pos.convert(1, 3), std::make_pair(words[1].first, words[2].second));
+	EXPECT_EQ(word2pos.convert(0, 1), words[0]);
+	// Positions out of text
+	EXPECT_EQ(word2pos.convert(4, 6), std::make_pair(words[4].first, int(text.size())));
+	EXPECT_EQ(word2pos.convert(7, 8), std::make_pair(int(text.size()), int(text.size())));
+
+	// Helper is reused for other text
+	const std::string other = "one two";
+	word2pos.Reset(other, extraWordSymbols);
+	EXPECT_EQ(word2pos.convert(1, 2), std::make_pair(4, 7));
+	EXPECT_EQ(word2pos.convert(0, 2), std::make_pair(0, 7));
+}
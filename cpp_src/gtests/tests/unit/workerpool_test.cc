@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "net/workerpool.h"
+
+using reindexer::net::WorkerPool;
+
+TEST(WorkerPool, QueueLimit) {
+	WorkerPool pool(1, 2);
+	std::mutex mtx;
+	std::condition_variable cond;
+	bool started = false, release = false;
+
+	// Worker is blocked by first task, so next tasks are waiting in queue
+	ASSERT_TRUE(pool.Post([&]() {
+		std::unique_lock<std::mutex> lck(mtx);
+		started = true;
+		cond.notify_all();
+		cond.wait(lck, [&] { return release; });
+	}));
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		cond.wait(lck, [&] { return started; });
+	}
+	EXPECT_TRUE(pool.Post([]() {}));
+	EXPECT_TRUE(pool.Post([]() {}));
+	EXPECT_FALSE(pool.Post([]() {}));
+	EXPECT_TRUE(pool.Post([]() {}, true));
+
+	auto stats = pool.GetStats();
+	EXPECT_EQ(stats.queued, 3u);
+	EXPECT_EQ(stats.active, 1);
+	EXPECT_EQ(stats.rejected, 1u);
+
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		release = true;
+		cond.notify_all();
+	}
+	while (pool.GetStats().executed != 4) std::this_thread::yield();
+	EXPECT_EQ(pool.GetStats().queued, 0u);
+}
+
+TEST(WorkerPool, UnorderedTasksAreConcurrent) {
+	WorkerPool pool(2, 0);
+	std::mutex mtx;
+	std::condition_variable cond;
+	int started = 0;
+	std::atomic<int> done(0);
+
+	// Each task waits for the other one, so they complete only if executed concurrently
+	for (int i = 0; i < 2; i++) {
+		ASSERT_TRUE(pool.Post([&]() {
+			std::unique_lock<std::mutex> lck(mtx);
+			started++;
+			cond.notify_all();
+			if (cond.wait_for(lck, std::chrono::seconds(10), [&] { return started == 2; })) done++;
+		}));
+	}
+	while (pool.GetStats().executed != 2) std::this_thread::yield();
+	EXPECT_EQ(done, 2);
+}
@@ -18,6 +18,7 @@ Connection<Mutex>::~Connection() {
 		io_.stop();
 		sock_.close();
 	}
+	if (shm_) shmIo_.stop();
 }
 
 template <typename Mutex>
@@ -36,6 +37,9 @@ void Connection<Mutex>::attach(ev::dynamic_loop &loop) {
 	io_.set<Connection, &Connection::callback>(this);
 	io_.set(loop);
 	if (sock_.valid() && curEvents_) io_.start(sock_.fd(), curEvents_);
+	shmIo_.set<Connection, &Connection::shm_cb>(this);
+	shmIo_.set(loop);
+	if (shm_) shmIo_.start(shm_->EventFd(), ev::READ);
 	timeout_.set<Connection, &Connection::timeout_cb>(this);
 	timeout_.set(loop);
 	async_.set<Connection, &Connection::async_cb>(this);
@@ -48,6 +52,8 @@ void Connection<Mutex>::detach() {
 	assert(attached_);
 	io_.stop();
 	io_.reset();
+	shmIo_.stop();
+	shmIo_.reset();
 	timeout_.stop();
 	timeout_.reset();
 	async_.stop();
@@ -63,6 +69,10 @@ void Connection<Mutex>::closeConn() {
 		io_.stop();
 		sock_.close();
 	}
+	if (shm_) {
+		shmIo_.stop();
+		shm_.reset();
+	}
 	timeout_.stop();
 	async_.stop();
 	onClose();
@@ -70,9 +80,21 @@ void Connection<Mutex>::closeConn() {
 
 // Generic callback
 template <typename Mutex>
-void Connection<Mutex>::callback(ev::io & /*watcher*/, int revents) {
+void Connection<Mutex>::callback(ev::io &watcher, int revents) {
 	if (ev::ERROR & revents) return;
 
+	// Socket of shared memory connection transfers no data, it is watched to detect closing by peer
+	if (shm_ && &watcher == &io_ && (revents & ev::READ)) {
+		char c;
+		ssize_t nread = sock_.recv(&c, 1);
+		int err = sock_.last_error();
+		if (nread == 0 || (nread < 0 && !socket::would_block(err) && err != EINTR)) {
+			closeConn();
+			return;
+		}
+		revents &= ~ev::READ;
+	}
+
 	if (revents & ev::READ) {
 		read_cb();
 		revents |= ev::WRITE;
@@ -89,7 +111,8 @@ void Connection<Mutex>::callback(ev::io & /*watcher*/, int revents) {
 
 	wrBufLock_.unlock();
 
-	if (curEvents_ != nevents && sock_.valid()) {
+	// Shared memory channel signals by eventfd, so socket is watched for reading only
+	if (curEvents_ != nevents && sock_.valid() && !shm_) {
 		(curEvents_) ? io_.set(nevents) : io_.start(sock_.fd(), nevents);
 		curEvents_ = nevents;
 	}
@@ -98,12 +121,19 @@ void Connection<Mutex>::callback(ev::io & /*watcher*/, int revents) {
 // Socket is writable
 template <typename Mutex>
 void Connection<Mutex>::write_cb() {
-	while (wrBuf_.size()) {
+	for (;;) {
+		// Buffer can be written by other threads, so its size is checked under lock too
 		wrBufLock_.lock();
+		if (!wrBuf_.size()) {
+			wrBufLock_.unlock();
+			break;
+		}
 
-		auto it = wrBuf_.tail();
+		chain_buf::span spans[kMaxSendSpans];
+		size_t cnt = wrBuf_.tail(spans, kMaxSendSpans), len = 0;
+		for (size_t i = 0; i < cnt; i++) len += spans[i].len;
 
-		ssize_t written = sock_.send(it.data, it.len);
+		ssize_t written = shm_ ? shm_->Send(spans, cnt) : sock_.send(spans, cnt);
 		wrBufLock_.unlock();
 		int err = sock_.last_error();
 
@@ -121,7 +151,7 @@ void Connection<Mutex>::write_cb() {
 		wrBuf_.erase(written);
 		wrBufLock_.unlock();
 
-		if (written < ssize_t(it.len)) return;
+		if (written < ssize_t(len)) return;
 	}
 	if (closeConn_) {
 		closeConn();
@@ -133,7 +163,7 @@ template <typename Mutex>
 void Connection<Mutex>::read_cb() {
 	while (!closeConn_) {
 		auto it = rdBuf_.head();
-		ssize_t nread = sock_.recv(it.data, it.len);
+		ssize_t nread = shm_ ? shm_->Recv(it.data, it.len) : sock_.recv(it.data, it.len);
 		int err = sock_.last_error();
 
 		if (nread < 0 && err == EINTR) continue;
@@ -156,9 +186,30 @@ void Connection<Mutex>::timeout_cb(ev::periodic & /*watcher*/, int /*time*/) {
 
 template <typename Mutex>
 void Connection<Mutex>::async_cb(ev::async &) {
+	// Connection could be closed after async was sent
+	if (!sock_.valid()) return;
 	callback(io_, ev::WRITE);
 }
 
+// Peer has written to shared memory channel, or has freed space in it
+template <typename Mutex>
+void Connection<Mutex>::shm_cb(ev::io &watcher, int) {
+	shm_->ResetEvent();
+	callback(watcher, ev::READ | ev::WRITE);
+	// Reading stops, when read buffer is full, and peer does not signal about data, which is left in ring
+	if (shm_ && shm_->Readable()) shm_->WakeSelf();
+}
+
+template <typename Mutex>
+void Connection<Mutex>::enableShm(ShmChannel *shm) {
+	shm_.reset(shm);
+	shmIo_.start(shm_->EventFd(), ev::READ);
+	if (curEvents_ != ev::READ) {
+		(curEvents_) ? io_.set(ev::READ) : io_.start(sock_.fd(), ev::READ);
+		curEvents_ = ev::READ;
+	}
+}
+
 template class Connection<std::mutex>;
 template class Connection<reindexer::dummy_mutex>;
 
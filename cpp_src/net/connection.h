@@ -1,10 +1,13 @@
 #pragma once
 
 #include <string.h>
+#include <memory>
 #include <mutex>
 #include "estl/cbuf.h"
+#include "estl/chain_buf.h"
 #include "estl/shared_mutex.h"
 #include "net/ev/ev.h"
+#include "net/shmchannel.h"
 #include "net/socket.h"
 #include "tools/ssize_t.h"
 
@@ -12,6 +15,7 @@ namespace reindexer {
 namespace net {
 
 using reindexer::cbuf;
+using reindexer::chain_buf;
 using std::mutex;
 
 const ssize_t kConnReadbufSize = 0x8000;
@@ -33,6 +37,10 @@ protected:
 	void read_cb();
 	void async_cb(ev::async &watcher);
 	void timeout_cb(ev::periodic &watcher, int);
+	void shm_cb(ev::io &watcher, int revents);
+
+	// Switch data transfer to shared memory channel. Socket is kept to detect closing of connection by peer
+	void enableShm(ShmChannel *shm);
 
 	void closeConn();
 	void attach(ev::dynamic_loop &loop);
@@ -40,17 +48,21 @@ protected:
 	void restart(int fd);
 
 	ev::io io_;
+	ev::io shmIo_;
 	ev::timer timeout_;
 	ev::async async_;
 
 	socket sock_;
+	std::unique_ptr<ShmChannel> shm_;
 	int curEvents_ = 0;
 	bool closeConn_ = false;
 	bool attached_ = false;
 	bool canWrite_ = true;
 	Mutex wrBufLock_;
 
-	cbuf<char> wrBuf_, rdBuf_;
+	// Responces are queued by chunks, and big ones are not copied
+	chain_buf wrBuf_;
+	cbuf<char> rdBuf_;
 };
 
 using ConnectionST = Connection<reindexer::dummy_mutex>;
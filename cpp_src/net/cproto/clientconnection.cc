@@ -2,40 +2,163 @@
 
 #include "clientconnection.h"
 #include <errno.h>
+#include <algorithm>
+#include "tools/oscompat.h"
 #include "tools/serializer.h"
 
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
 namespace reindexer {
 namespace net {
 namespace cproto {
 
-ClientConnection::ClientConnection(ev::dynamic_loop &loop) : ConnectionMT(-1, loop), state_(ConnInit) {}
+ClientConnection::ClientConnection(ev::dynamic_loop &loop)
+	: ConnectionMT(-1, loop), state_(ConnInit), compression_(false), slots_(new CallSlot[kMaxConcurentQueries]) {
+	freeSlots_.reserve(kMaxConcurentQueries);
+	for (uint32_t i = 0; i < kMaxConcurentQueries; i++) {
+		slots_[i].seq = i;
+		freeSlots_.push_back(kMaxConcurentQueries - 1 - i);
+	}
+}
 
-bool ClientConnection::Connect(string_view addr, string_view username, string_view password, string_view dbName) {
+bool ClientConnection::Connect(string_view addr, string_view username, string_view password, string_view dbName, bool compression,
+							   size_t shmRingSize) {
 	assert(!sock_.valid());
 	assert(wrBuf_.size() == 0);
 
 	std::unique_lock<mutex> lck(wrBufLock_);
 	state_ = ConnConnecting;
+	compression_ = false;
 	sock_.connect(addr.data());
 	if (!sock_.valid()) {
 		state_ = ConnFailed;
 		return false;
 	}
 
+	Args args{Arg(p_string(&username)), Arg(p_string(&password)), Arg(p_string(&dbName)),
+			  Arg(compression ? kCprotoCompressionLZ4 : 0)};
+	if (shmRingSize && socket::is_unix_addr(addr.data())) {
+		if (!loginShm(args, shmRingSize)) {
+			sock_.close();
+			state_ = ConnFailed;
+			return false;
+		}
+		if (!shm_) io_.start(sock_.fd(), ev::READ | ev::WRITE);
+		async_.start();
+		return true;
+	}
+
 	io_.start(sock_.fd(), ev::READ | ev::WRITE);
 	async_.start();
-	Args args{Arg(p_string(&username)), Arg(p_string(&password)), Arg(p_string(&dbName))};
-	callRPC(kCmdLogin, seq_, args);
+	uint32_t version;
+	chunk body = packArgs(args, version);
+	// Answer of login is recognized by command, so it does not need slot
+	writeFrame(kCmdLogin, 0, version, std::move(body));
+	return true;
+}
+
+// Shared memory channel is opened for logged in client only, so login is done before it. Socket is not watched by loop yet,
+// so answers are awaited synchronously. Returns false, if socket is left in unknown state
+bool ClientConnection::loginShm(const Args &loginArgs, size_t ringSize) {
+	RPCAnswer ans;
+	int fds[ShmChannel::kFdsCount];
+	int nfds = 0;
+	bool complete = syncCall(kCmdLogin, loginArgs, ans, fds, nfds);
+	// Descriptors are not expected with answer of login
+	for (; nfds > 0; nfds--) ::close(fds[nfds - 1]);
+	if (!complete) return false;
+	// Calls of client, which has not logged in, are answered by error of login
+	if (!ans.Status().ok()) return true;
+	onLogin(ans);
+
+	complete = syncCall(kCmdOpenShm, Args{Arg(int64_t(ringSize))}, ans, fds, nfds);
+	std::unique_ptr<ShmChannel> shm;
+	if (complete && ans.Status().ok() && nfds == ShmChannel::kFdsCount) {
+		shm.reset(ShmChannel::Open(fds));
+		nfds = 0;
+	}
+	for (int i = 0; i < nfds; i++) ::close(fds[i]);
+	// Server, which does not support shared memory, answers by error, and connection continues by socket
+	if (shm) enableShm(shm.release());
+	return complete;
+}
+
+// Write frame and read its answer up to its end. Descriptors, which are attached to answer, are received to fds
+bool ClientConnection::syncCall(CmdCode cmd, const Args &args, RPCAnswer &ans, int *fds, int &nfds) {
+	uint32_t version;
+	chunk body = packArgs(args, version);
+	CProtoHeader hdr;
+	hdr.magic = kCprotoMagic;
+	hdr.version = version;
+	hdr.len = body.size();
+	hdr.cmd = cmd;
+	hdr.seq = 0;
+	std::string frame(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+	frame.append(body.data(), body.size());
+	if (!waitSocket(ev::WRITE) || sock_.send(frame.data(), frame.size()) != int(frame.size())) return false;
+
+	std::string answer;
+	for (size_t need = sizeof(hdr); answer.size() < need;) {
+		if (!waitSocket(ev::READ)) return false;
+		char buf[0x1000];
+		int cnt = ShmChannel::kFdsCount - nfds;
+		int nread = sock_.recv_fds(buf, std::min(sizeof(buf), need - answer.size()), fds + nfds, cnt);
+		nfds += cnt;
+		if (nread < 0 && sock_.last_error() == EINTR) continue;
+		if (nread <= 0) return false;
+		answer.append(buf, nread);
+		if (answer.size() == sizeof(hdr)) {
+			memcpy(&hdr, answer.data(), sizeof(hdr));
+			if (hdr.magic != kCprotoMagic || (hdr.version & ~kCprotoCompressedFlag) != kCprotoVersion || hdr.cmd != uint32_t(cmd)) {
+				return false;
+			}
+			need += hdr.len;
+		}
+	}
+	try {
+		decodeAnswer(hdr, string_view(answer).substr(sizeof(hdr)), ans);
+	} catch (const Error &err) {
+		fprintf(stderr, "Invalid answer of %s: %s\n", CmdName(cmd), err.what().c_str());
+		return false;
+	}
 	return true;
 }
 
+bool ClientConnection::waitSocket(int events) {
+#ifndef _WIN32
+	const int kShmOpenTimeoutMs = 1000;
+	struct pollfd pfd;
+	pfd.fd = sock_.fd();
+	pfd.events = ((events & ev::READ) ? POLLIN : 0) | ((events & ev::WRITE) ? POLLOUT : 0);
+	pfd.revents = 0;
+	int ret;
+	while ((ret = ::poll(&pfd, 1, kShmOpenTimeoutMs)) < 0 && errno == EINTR) {
+	}
+	return ret > 0 && !(pfd.revents & (POLLERR | POLLHUP | POLLNVAL));
+#else
+	(void)events;
+	return false;
+#endif
+}
+
 void ClientConnection::onClose() {
 	{
 		std::unique_lock<mutex> lck(wrBufLock_);
 		state_ = ConnFailed;
 		wrBuf_.clear();
+		// Calls in flight are answered by error, connection can be restarted before they wake up
+		for (uint32_t i = 0; i < kMaxConcurentQueries; i++) {
+			auto &slot = slots_[i];
+			if (slot.used && !slot.ready) {
+				slot.ans.status_ = Error(errNetwork, "Connection to server was dropped");
+				slot.ready = true;
+				slot.cond.notify_one();
+			}
+		}
 	}
-	answersCond_.notify_all();
+	freeSlotsCond_.notify_all();
 }
 
 void ClientConnection::onRead() {
@@ -45,7 +168,7 @@ void ClientConnection::onRead() {
 		auto len = rdBuf_.peek(reinterpret_cast<char *>(&hdr), sizeof(hdr));
 
 		if (len < sizeof(hdr)) return;
-		if (hdr.magic != kCprotoMagic || hdr.version != kCprotoVersion) {
+		if (hdr.magic != kCprotoMagic || (hdr.version & ~kCprotoCompressedFlag) != kCprotoVersion) {
 			// responceRPC(ctx, Error(errParams, "Invalid cproto header: magic=%08x or version=%08x", hdr.magic, hdr.version), Args());
 			closeConn_ = true;
 			return;
@@ -66,52 +189,57 @@ void ClientConnection::onRead() {
 		}
 		assert(it.len >= hdr.len);
 
-		RPCRawAnswer ans;
-		ans.cmd = CmdCode(hdr.cmd);
-		ans.seq = hdr.seq;
+		CmdCode cmd = CmdCode(hdr.cmd);
+		RPCAnswer ans;
 
-		Serializer ser(it.data, hdr.len);
-		int errCode = ser.GetVarUint();
-		string errMsg = ser.GetVString().ToString();
-		ans.ans.status_ = Error(errCode, errMsg);
-		assert(ser.Pos() <= hdr.len);
-		ans.ans.data_.assign(reinterpret_cast<uint8_t *>(it.data) + ser.Pos(), reinterpret_cast<uint8_t *>(it.data) + hdr.len);
+		try {
+			decodeAnswer(hdr, string_view(it.data, hdr.len), ans);
+		} catch (const Error &err) {
+			fprintf(stderr, "drop connect, reason: %s\n", err.what().c_str());
+			closeConn_ = true;
+			return;
+		}
 
 		wrBufLock_.lock();
-		if (ans.cmd == cproto::kCmdLogin) {
-			if (errCode == errOK) {
-				state_ = ConnConnected;
-			}
+		if (cmd == cproto::kCmdLogin) {
+			if (ans.Status().ok()) onLogin(ans);
 		} else {
-			answers_.push_back(std::move(ans));
+			auto &slot = slots_[hdr.seq % kMaxConcurentQueries];
+			// Answers of calls, which were abandoned by dropped connection, are ignored
+			if (slot.used && !slot.ready && slot.seq == hdr.seq) {
+				if (cmd != slot.cmd) {
+					slot.ans.status_ = Error(errParams, "Invalid cmdCode %d, expected %d for seq = %d", cmd, slot.cmd, hdr.seq);
+				} else {
+					slot.ans = std::move(ans);
+				}
+				slot.ready = true;
+				slot.cond.notify_one();
+			}
 		}
-		answersCond_.notify_all();
 		wrBufLock_.unlock();
 
 		rdBuf_.erase(hdr.len);
 	}
 }
-RPCAnswer ClientConnection::getAnswer(CmdCode cmd, uint32_t seq) {
-	RPCAnswer ret;
-	std::unique_lock<mutex> lck(wrBufLock_);
-	for (;;) {
-		if (state_ == ConnFailed) {
-			ret.status_ = Error(errNetwork, "Connection to server was dropped");
-			return ret;
-		}
-		auto it = find_if(answers_.begin(), answers_.end(), [seq](const RPCRawAnswer &a) { return a.seq == seq; });
-		if (it != answers_.end()) {
-			if (cmd != it->cmd) {
-				ret.status_ = Error(errParams, "Invalid cmdCode %d, expected %d for seq = %d", it->cmd, cmd, seq);
-			} else {
-				ret = std::move(it->ans);
-			}
-			std::swap(*it, *std::prev(answers_.end(), 1));
-			answers_.pop_back();
-			return ret;
-		}
-		answersCond_.wait(lck);
+void ClientConnection::decodeAnswer(const CProtoHeader &hdr, string_view body, RPCAnswer &ans) {
+	if (hdr.version & kCprotoCompressedFlag) {
+		DecompressFrame(body, unpacked_);
+		body = string_view(unpacked_);
 	}
+	Serializer ser(body);
+	int errCode = ser.GetVarUint();
+	string errMsg = ser.GetVString().ToString();
+	ans.status_ = Error(errCode, errMsg);
+	assert(ser.Pos() <= body.size());
+	ans.data_.assign(reinterpret_cast<const uint8_t *>(body.data()) + ser.Pos(),
+					 reinterpret_cast<const uint8_t *>(body.data()) + body.size());
+}
+
+void ClientConnection::onLogin(RPCAnswer &ans) {
+	state_ = ConnConnected;
+	// Old servers do not answer by compression flags
+	Args ret = ans.GetArgs();
+	compression_ = ret.size() > 2 && ret[2].Type() == KeyValueInt && (int(ret[2]) & kCprotoCompressionLZ4);
 }
 
 Args RPCAnswer::GetArgs() {
@@ -123,20 +251,28 @@ Args RPCAnswer::GetArgs() {
 
 Error RPCAnswer::Status() { return status_; }
 
-void ClientConnection::callRPC(CmdCode cmd, uint32_t seq, const Args &args) {
+chunk ClientConnection::packArgs(const Args &args, uint32_t &version) {
 	WrSerializer ser;
-
 	args.Pack(ser);
+	std::string packed;
+	if (compression_ && CompressFrame(ser.Slice(), packed)) {
+		version = kCprotoVersion | kCprotoCompressedFlag;
+		return chunk(std::move(packed));
+	}
+	version = kCprotoVersion;
+	return ser.DetachChunk();
+}
 
+void ClientConnection::writeFrame(CmdCode cmd, uint32_t seq, uint32_t version, chunk &&body) {
 	CProtoHeader hdr;
-	hdr.len = ser.Len();
+	hdr.len = body.size();
 	hdr.magic = kCprotoMagic;
-	hdr.version = kCprotoVersion;
+	hdr.version = version;
 	hdr.cmd = cmd;
 	hdr.seq = seq;
 
 	wrBuf_.write(reinterpret_cast<char *>(&hdr), sizeof(hdr));
-	wrBuf_.write(reinterpret_cast<char *>(ser.Buf()), ser.Len());
+	wrBuf_.write(std::move(body));
 }
 
 RPCAnswer ClientConnection::call(CmdCode cmd, const Args &args) {
@@ -152,12 +288,37 @@ RPCAnswer ClientConnection::call(CmdCode cmd, const Args &args) {
 	// }
 	// printf("%s\n", ser.Buf());
 
-	wrBufLock_.lock();
-	uint32_t seq = seq_++;
-	callRPC(cmd, seq, args);
-	wrBufLock_.unlock();
+	// Frame is packed and compressed out of lock
+	uint32_t version;
+	chunk body = packArgs(args, version);
+
+	std::unique_lock<mutex> lck(wrBufLock_);
+	// Number of calls in flight is limited by number of slots
+	freeSlotsCond_.wait(lck, [this]() { return !freeSlots_.empty() || state_ == ConnFailed; });
+	RPCAnswer ret;
+	if (state_ == ConnFailed) {
+		ret.status_ = Error(errNetwork, "Connection to server was dropped");
+		return ret;
+	}
+	uint32_t idx = freeSlots_.back();
+	freeSlots_.pop_back();
+	auto &slot = slots_[idx];
+	slot.seq += kMaxConcurentQueries;
+	slot.cmd = cmd;
+	slot.used = true;
+	slot.ready = false;
+	writeFrame(cmd, slot.seq, version, std::move(body));
+	lck.unlock();
 	async_.send();
-	return getAnswer(cmd, seq);
+	lck.lock();
+
+	slot.cond.wait(lck, [&slot]() { return slot.ready; });
+	ret = std::move(slot.ans);
+	slot.ans = RPCAnswer();
+	slot.used = false;
+	freeSlots_.push_back(idx);
+	freeSlotsCond_.notify_one();
+	return ret;
 }
 
 }  // namespace cproto
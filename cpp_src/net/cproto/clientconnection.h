@@ -2,6 +2,8 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <memory>
+#include <string>
 #include <vector>
 #include "args.h"
 #include "cproto.h"
@@ -38,7 +40,11 @@ public:
 		return call(cmd, args, argss...);
 	}
 
-	bool Connect(string_view addr, string_view username, string_view password, string_view dbName);
+	/// @param compression - ask server to compress frames of connection
+	/// @param shmRingSize - size of shared memory rings, which replace unix socket after login. Socket is used, if server does not
+	/// support them
+	bool Connect(string_view addr, string_view username, string_view password, string_view dbName, bool compression = false,
+				 size_t shmRingSize = 0);
 	// bool IsValid() { return sock_.valid(); }
 
 	bool IsValid() {
@@ -65,23 +71,39 @@ protected:
 
 	RPCAnswer call(CmdCode cmd, const Args &args);
 
-	void callRPC(CmdCode cmd, uint32_t seq, const Args &args);
-	RPCAnswer getAnswer(CmdCode cmd, uint32_t seq);
+	// Pack args to frame body, which is compressed if server accepted compression. Returns header version of frame
+	chunk packArgs(const Args &args, uint32_t &version);
+	void writeFrame(CmdCode cmd, uint32_t seq, uint32_t version, chunk &&body);
+	bool loginShm(const Args &loginArgs, size_t ringSize);
+	bool syncCall(CmdCode cmd, const Args &args, RPCAnswer &ans, int *fds, int &nfds);
+	bool waitSocket(int events);
+	// Decode status and args of answer. Throws Error, if body is malformed
+	void decodeAnswer(const CProtoHeader &hdr, string_view body, RPCAnswer &ans);
+	// Login is answered. Called under wrBufLock_
+	void onLogin(RPCAnswer &ans);
 	void onRead() override;
 	void onClose() override;
 
-	struct RPCRawAnswer {
+	// Call waiting for answer. Server answers calls in order of completion, answer is matched to call by seq.
+	// Slot index is seq % kMaxConcurentQueries, so seq of slot is advanced by kMaxConcurentQueries on each call
+	struct CallSlot {
+		uint32_t seq;
 		CmdCode cmd;
-		uint32_t seq = 0;
+		bool used = false;
+		bool ready = false;
 		RPCAnswer ans;
+		std::condition_variable cond;
 	};
 	enum State { ConnInit, ConnConnecting, ConnConnected, ConnFailed };
 
 	State state_;
-	vector<RPCRawAnswer> answers_;
-
-	std::atomic<uint32_t> seq_;
-	std::condition_variable answersCond_;
+	// Server accepted compression of frames in login answer
+	std::atomic<bool> compression_;
+	// Buffer for decompressed answers, used by connection's loop only
+	std::string unpacked_;
+	std::unique_ptr<CallSlot[]> slots_;
+	vector<uint32_t> freeSlots_;
+	std::condition_variable freeSlotsCond_;
 };
 }  // namespace cproto
 }  // namespace net
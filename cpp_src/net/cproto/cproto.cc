@@ -1,6 +1,13 @@
+#include <chrono>
 #include <unordered_map>
 
 #include "cproto.h"
+#include "net/stat.h"
+#include "tools/errors.h"
+#include "tools/serializer.h"
+#include "tools/varint.h"
+#include "vendor/lz4/lz4.h"
+
 namespace reindexer {
 namespace net {
 namespace cproto {
@@ -11,6 +18,7 @@ std::unordered_map<int, const char *> kRPCCodes = {
 	{kCmdOpenDatabase, "OpenDatabase"},
 	{kCmdCloseDatabase, "CloseDatabase"},
 	{kCmdDropDatabase, "DropDatabase"},
+	{kCmdOpenShm, "OpenShm"},
 	{kCmdOpenNamespace, "OpenNamespace"},
 	{kCmdCloseNamespace, "CloseNamespace"},
 	{kCmdDropNamespace, "DropNamespace"},
@@ -38,6 +46,53 @@ const char *CmdName(CmdCode cmd) {
 	return "Unknown";
 }
 
+bool IsSessionCmd(CmdCode cmd) {
+	switch (cmd) {
+		case kCmdLogin:
+		case kCmdOpenDatabase:
+		case kCmdCloseDatabase:
+		case kCmdDropDatabase:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static uint64_t usSince(std::chrono::steady_clock::time_point tm0) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tm0).count();
+}
+
+bool CompressFrame(string_view body, std::string &out) {
+	auto &stat = CompressionStat::Global();
+	if (body.size() < kCprotoMinCompressSize) {
+		stat.Skipped();
+		return false;
+	}
+	auto tm0 = std::chrono::steady_clock::now();
+	out.resize(10 + lz4::CompressBound(body.size()));
+	uint8_t *buf = reinterpret_cast<uint8_t *>(&out[0]);
+	size_t len = uint32_pack(uint32_t(body.size()), buf);
+	len += lz4::Compress(body.data(), body.size(), &out[len]);
+	if (len >= body.size()) {
+		stat.Skipped();
+		return false;
+	}
+	out.resize(len);
+	stat.Compressed(body.size(), len, usSince(tm0));
+	return true;
+}
+
+void DecompressFrame(string_view body, std::string &out) {
+	auto tm0 = std::chrono::steady_clock::now();
+	Serializer ser(body);
+	size_t rawSize = ser.GetVarUint();
+	if (rawSize > kCprotoMaxFrameSize) throw Error(errParseBin, "Compressed frame is too large: %d bytes", int(rawSize));
+	out.resize(rawSize);
+	long len = lz4::Decompress(body.data() + ser.Pos(), body.size() - ser.Pos(), &out[0], rawSize);
+	if (len != long(rawSize)) throw Error(errParseBin, "Malformed compressed frame");
+	CompressionStat::Global().Decompressed(body.size(), rawSize, usSince(tm0));
+}
+
 }  // namespace cproto
 }  // namespace net
 }  // namespace reindexer
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stdint.h>
+#include <string>
+#include "estl/string_view.h"
 
 namespace reindexer {
 namespace net {
@@ -11,6 +13,8 @@ enum CmdCode {
 	kCmdOpenDatabase = 2,
 	kCmdCloseDatabase = 3,
 	kCmdDropDatabase = 4,
+	// Switch connection to shared memory channel. Answer carries descriptors of channel, so it is supported on unix socket only
+	kCmdOpenShm = 5,
 	kCmdOpenNamespace = 16,
 	kCmdCloseNamespace = 17,
 	kCmdDropNamespace = 18,
@@ -36,12 +40,22 @@ enum CmdCode {
 };
 
 const char *CmdName(CmdCode code);
+// Check if command changes state of client session. Session commands are not executed concurrently with other calls of connection
+bool IsSessionCmd(CmdCode code);
 
 // Maximum number of active queries per cleint
 const uint32_t kMaxConcurentQueries = 256;
 
 const uint32_t kCprotoMagic = 0xEEDD1132;
 const uint32_t kCprotoVersion = 0x100;
+// Bit of header version, which marks compressed frame body
+const uint32_t kCprotoCompressedFlag = 0x10000;
+// Compression algorithms, which are negotiated by Login call
+const int kCprotoCompressionLZ4 = 1;
+// Smaller frames are not compressed
+const size_t kCprotoMinCompressSize = 1024;
+// Limit of decompressed frame size
+const size_t kCprotoMaxFrameSize = 256 * 1024 * 1024;
 
 #pragma pack(push, 1)
 struct CProtoHeader {
@@ -53,6 +67,12 @@ struct CProtoHeader {
 };
 #pragma pack(pop)
 
+// Compressed frame body is varuint of raw size followed by LZ4 block
+// Compress frame body. Returns false, if body is too small or incompressible and must be sent as is
+bool CompressFrame(string_view body, std::string &out);
+// Decompress frame body. Throws Error, if body is malformed
+void DecompressFrame(string_view body, std::string &out);
+
 }  // namespace cproto
 }  // namespace net
 }  // namespace reindexer
@@ -36,16 +36,20 @@ public:
 	virtual void WriteRPCReturn(Context &ctx, const Args &args) = 0;
 	virtual void SetClientData(ClientData::Ptr data) = 0;
 	virtual ClientData::Ptr GetClientData() = 0;
+	// Allow compression of next responces
+	virtual void EnableCompression() = 0;
 };
 
 struct Context {
 	void Return(const Args &args) { writer->WriteRPCReturn(*this, args); }
 	void SetClientData(ClientData::Ptr data) { writer->SetClientData(data); };
 	ClientData::Ptr GetClientData() { return writer->GetClientData(); }
+	void EnableCompression() { writer->EnableCompression(); }
 
 	RPCCall *call;
 	Writer *writer;
 	Stat stat;
+	bool respSent = false;
 };
 
 class ServerConnection;
@@ -10,32 +10,65 @@ namespace cproto {
 
 const auto kCProtoTimeoutSec = 300.;
 
-ServerConnection::ServerConnection(int fd, ev::dynamic_loop &loop, Dispatcher &dispatcher)
-	: net::ConnectionST(fd, loop), dispatcher_(dispatcher) {
+ServerConnection::ServerConnection(int fd, ev::dynamic_loop &loop, Dispatcher &dispatcher, WorkerPool *pool)
+	: net::ConnectionMT(fd, loop), dispatcher_(dispatcher), pool_(pool), compression_(false) {
+	async_.start();
 	timeout_.start(kCProtoTimeoutSec);
 	callback(io_, ev::READ);
 }
 
 bool ServerConnection::Restart(int fd) {
 	restart(fd);
-	respSent_ = false;
+	closed_ = false;
+	compression_ = false;
 	callback(io_, ev::READ);
 	timeout_.start(kCProtoTimeoutSec);
 	return true;
 }
 
 void ServerConnection::Attach(ev::dynamic_loop &loop) {
+	std::unique_lock<mutex> lck(wrBufLock_);
 	if (!attached_) {
 		attach(loop);
+		async_.start();
 		timeout_.start(kCProtoTimeoutSec);
+		// Responces could be written by workers, while connection was detached
+		if (wrBuf_.size()) async_.send();
 	}
 }
 
 void ServerConnection::Detach() {
+	std::unique_lock<mutex> lck(wrBufLock_);
 	if (attached_) detach();
 }
 
 void ServerConnection::onClose() {
+	if (!pool_) {
+		closeClient();
+		return;
+	}
+	{
+		std::unique_lock<mutex> lck(wrBufLock_);
+		closed_ = true;
+	}
+	{
+		std::unique_lock<std::mutex> lck(callsMtx_);
+		waiting_.clear();
+		closing_ = true;
+		if (running_) return;
+	}
+	closeClient();
+	std::unique_lock<std::mutex> lck(callsMtx_);
+	closing_ = false;
+}
+
+bool ServerConnection::idle() {
+	if (!pool_) return true;
+	std::unique_lock<std::mutex> lck(callsMtx_);
+	return !executing_ && waiting_.empty() && !closing_;
+}
+
+void ServerConnection::closeClient() {
 	if (dispatcher_.onClose_) {
 		Stat stat;
 		Context ctx;
@@ -51,11 +84,97 @@ void ServerConnection::onClose() {
 void ServerConnection::handleRPC(Context &ctx) {
 	Error err = dispatcher_.handle(ctx);
 
-	if (!respSent_) {
+	if (!ctx.respSent) {
 		responceRPC(ctx, err, Args());
 	}
 }
 
+void ServerConnection::schedule(std::shared_ptr<PendingCall> pending) {
+	{
+		std::unique_lock<std::mutex> lck(callsMtx_);
+		if (waiting_.size() + running_ < kMaxConcurentQueries) {
+			waiting_.push_back(std::move(pending));
+		}
+	}
+	if (pending) {
+		Context ctx;
+		ctx.call = &pending->call;
+		ctx.writer = this;
+		responceRPC(ctx, Error(errLogic, "Too many concurrent RPC calls on connection"), Args());
+		return;
+	}
+	dispatchCalls();
+}
+
+void ServerConnection::dispatchCalls() {
+	h_vector<std::shared_ptr<PendingCall>, 4> rejected;
+	{
+		std::unique_lock<std::mutex> lck(callsMtx_);
+		while (!waiting_.empty() && !barrier_) {
+			auto pending = waiting_.front();
+			bool barrier = IsSessionCmd(pending->call.cmd);
+			if (barrier && running_) break;
+			waiting_.pop_front();
+			if (pool_->Post([this, pending]() { execute(pending); })) {
+				running_++;
+				executing_++;
+				barrier_ = barrier;
+			} else {
+				rejected.push_back(std::move(pending));
+			}
+		}
+	}
+	for (auto &pending : rejected) {
+		Context ctx;
+		ctx.call = &pending->call;
+		ctx.writer = this;
+		responceRPC(ctx, Error(errLogic, "Too many queued RPC calls"), Args());
+	}
+}
+
+void ServerConnection::execute(const std::shared_ptr<PendingCall> &pending) {
+	bool closed;
+	{
+		std::unique_lock<mutex> lck(wrBufLock_);
+		closed = closed_;
+	}
+	// Nobody will read responce
+	if (!closed) {
+		Stat stat;
+		Context ctx;
+		ctx.call = &pending->call;
+		ctx.writer = this;
+		ctx.stat = stat;
+		// Exception of handler must not escape worker's thread. Call is answered by error, and connection is kept,
+		// because its other calls are executed concurrently
+		try {
+			handleRPC(ctx);
+		} catch (const Error &err) {
+			if (!ctx.respSent) responceRPC(ctx, err, Args());
+		} catch (const std::exception &err) {
+			if (!ctx.respSent) responceRPC(ctx, Error(errLogic, err.what()), Args());
+		}
+	}
+
+	bool close;
+	{
+		std::unique_lock<std::mutex> lck(callsMtx_);
+		running_--;
+		if (IsSessionCmd(pending->call.cmd)) barrier_ = false;
+		close = closing_ && !running_;
+	}
+	if (close) {
+		closeClient();
+		std::unique_lock<std::mutex> lck(callsMtx_);
+		closing_ = false;
+	} else {
+		dispatchCalls();
+	}
+	// Connection is not idle until here, so it is not recycled or destroyed by loop, while it is used by worker
+	std::unique_lock<std::mutex> lck(callsMtx_);
+	executing_--;
+}
+
 void ServerConnection::onRead() {
 	CProtoHeader hdr;
 
@@ -69,7 +188,7 @@ void ServerConnection::onRead() {
 		auto len = rdBuf_.peek(reinterpret_cast<char *>(&hdr), sizeof(hdr));
 
 		if (len < sizeof(hdr)) return;
-		if (hdr.magic != kCprotoMagic || hdr.version != kCprotoVersion) {
+		if (hdr.magic != kCprotoMagic || (hdr.version & ~kCprotoCompressedFlag) != kCprotoVersion) {
 			responceRPC(ctx, Error(errParams, "Invalid cproto header: magic=%08x or version=%08x", hdr.magic, hdr.version), Args());
 			closeConn_ = true;
 			return;
@@ -90,29 +209,108 @@ void ServerConnection::onRead() {
 		}
 		assert(it.len >= hdr.len);
 
+		std::shared_ptr<PendingCall> pending;
 		RPCCall call;
 		ctx.call = &call;
 		try {
 			call.cmd = CmdCode(hdr.cmd);
 			call.seq = hdr.seq;
-			Serializer ser(it.data, hdr.len);
-			call.args.Unpack(ser);
-			handleRPC(ctx);
+			string_view body(it.data, hdr.len);
+			if (hdr.version & kCprotoCompressedFlag) {
+				DecompressFrame(body, unpacked_);
+				body = string_view(unpacked_);
+			}
+			if (call.cmd == kCmdOpenShm) {
+				Serializer ser(body);
+				call.args.Unpack(ser);
+				openShm(ctx);
+			} else if (!pool_) {
+				Serializer ser(body);
+				call.args.Unpack(ser);
+				handleRPC(ctx);
+			} else {
+				// Args reference body, so it is copied out of read buffer, which is reused by next requests
+				pending = std::make_shared<PendingCall>();
+				pending->call.cmd = call.cmd;
+				pending->call.seq = call.seq;
+				pending->body.assign(body.data(), body.size());
+				Serializer ser(pending->body);
+				pending->call.args.Unpack(ser);
+			}
 		} catch (const Error &err) {
 			// Execption occurs on unrecoverble error. Send responce, and drop connection
 			fprintf(stderr, "drop connect, reason: %s\n", err.what().c_str());
-			responceRPC(ctx, err, Args());
+			if (!ctx.respSent) responceRPC(ctx, err, Args());
 			closeConn_ = true;
+			pending.reset();
 		}
 
-		respSent_ = false;
+		if (pending) schedule(std::move(pending));
+
 		rdBuf_.erase(hdr.len);
 		timeout_.start(kCProtoTimeoutSec);
 	}
 }
 
+// Answer is sent directly by socket, because descriptors of channel are attached to it. Next frames are transferred by channel
+void ServerConnection::openShm(Context &ctx) {
+	Error err;
+	std::unique_ptr<ShmChannel> shm;
+	bool busy, loggedIn;
+	{
+		std::unique_lock<mutex> lck(wrBufLock_);
+		busy = wrBuf_.size() || shm_;
+		loggedIn = bool(clientData_);
+	}
+	if (!sock_.is_unix()) {
+		err = Error(errParams, "Shared memory channel is supported on unix domain socket only");
+	} else if (!loggedIn) {
+		// Memory of channel is allocated for authenticated clients only
+		err = Error(errForbidden, "You should login");
+	} else if (busy) {
+		err = Error(errLogic, "Shared memory channel can't be opened, while connection has pending responces");
+	} else if (ctx.call->args.size() != 1) {
+		err = Error(errParams, "Invalid args of %s call expected 1, got %d", CmdName(ctx.call->cmd), int(ctx.call->args.size()));
+	} else {
+		shm.reset(ShmChannel::Create(size_t(int64_t(ctx.call->args[0]))));
+		if (!shm) err = Error(errLogic, "Can't create shared memory channel");
+	}
+	if (!shm) {
+		responceRPC(ctx, err, Args());
+		return;
+	}
+
+	Args args{Arg(int64_t(shm->RingSize()))};
+	if (dispatcher_.logger_ != nullptr) {
+		dispatcher_.logger_(ctx, errOK, args);
+	}
+	WrSerializer ser;
+	ser.PutVarUint(errOK);
+	ser.PutVString("");
+	args.Pack(ser);
+
+	CProtoHeader hdr;
+	hdr.magic = kCprotoMagic;
+	hdr.version = kCprotoVersion;
+	hdr.len = ser.Len();
+	hdr.cmd = ctx.call->cmd;
+	hdr.seq = ctx.call->seq;
+	std::string frame(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+	frame.append(ser.Slice().data(), ser.Len());
+	ctx.respSent = true;
+
+	// Write buffer is empty, so small answer is written at once
+	if (sock_.send_fds(frame.data(), frame.size(), shm->Fds(), ShmChannel::kFdsCount) != int(frame.size())) {
+		perror("send_fds error");
+		closeConn_ = true;
+		return;
+	}
+	std::unique_lock<mutex> lck(wrBufLock_);
+	enableShm(shm.release());
+}
+
 void ServerConnection::responceRPC(Context &ctx, const Error &status, const Args &args) {
-	if (respSent_) {
+	if (ctx.respSent) {
 		fprintf(stderr, "Warning - RPC responce already sent\n");
 		return;
 	}
@@ -127,9 +325,18 @@ void ServerConnection::responceRPC(Context &ctx, const Error &status, const Args
 	args.Pack(ser);
 
 	CProtoHeader hdr;
-	hdr.len = ser.Len();
 	hdr.magic = kCprotoMagic;
 	hdr.version = kCprotoVersion;
+	// Compression is done by caller's thread, out of write buffer's lock. Body is moved to write buffer without copying
+	chunk body;
+	std::string packed;
+	if (compression_ && CompressFrame(ser.Slice(), packed)) {
+		hdr.version |= kCprotoCompressedFlag;
+		body = chunk(std::move(packed));
+	} else {
+		body = ser.DetachChunk();
+	}
+	hdr.len = body.size();
 	if (ctx.call != nullptr) {
 		hdr.cmd = ctx.call->cmd;
 		hdr.seq = ctx.call->seq;
@@ -137,12 +344,13 @@ void ServerConnection::responceRPC(Context &ctx, const Error &status, const Args
 		hdr.cmd = 0;
 		hdr.seq = 0;
 	}
+	ctx.respSent = true;
+
+	std::unique_lock<mutex> lck(wrBufLock_);
 	wrBuf_.write(reinterpret_cast<char *>(&hdr), sizeof(hdr));
-	wrBuf_.write(reinterpret_cast<char *>(ser.Buf()), ser.Len());
-	respSent_ = true;
-	// if (canWrite_) {
-	// 	write_cb();
-	// }
+	wrBuf_.write(std::move(body));
+	// Responce of worker is written to socket by connection's loop
+	if (pool_ && attached_) async_.send();
 }
 
 }  // namespace cproto
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <string.h>
+#include <atomic>
+#include <deque>
+#include <string>
 #include "dispatcher.h"
 #include "net/connection.h"
 #include "net/iserverconnection.h"
+#include "net/workerpool.h"
 
 namespace reindexer {
 namespace net {
@@ -11,35 +15,70 @@ namespace cproto {
 
 using reindexer::h_vector;
 
-class ServerConnection : public ConnectionST, public IServerConnection, public Writer {
+class ServerConnection : public ConnectionMT, public IServerConnection, public Writer {
 public:
-	ServerConnection(int fd, ev::dynamic_loop &loop, Dispatcher &dispatcher);
+	/// @param pool - pool of workers, which execute calls. Calls are executed in thread of connection's loop, if nullptr
+	ServerConnection(int fd, ev::dynamic_loop &loop, Dispatcher &dispatcher, WorkerPool *pool);
 
 	// IServerConnection interface implementation
-	static ConnectionFactory NewFactory(Dispatcher &dispatcher) {
-		return [&dispatcher](ev::dynamic_loop &loop, int fd) { return new ServerConnection(fd, loop, dispatcher); };
+	static ConnectionFactory NewFactory(Dispatcher &dispatcher, WorkerPool *pool = nullptr) {
+		return [&dispatcher, pool](ev::dynamic_loop &loop, int fd) { return new ServerConnection(fd, loop, dispatcher, pool); };
 	};
 
-	bool IsFinished() override final { return !sock_.valid(); }
+	bool IsFinished() override final { return !sock_.valid() && idle(); }
 	bool Restart(int fd) override final;
 	void Detach() override final;
 	void Attach(ev::dynamic_loop &loop) override final;
 
 	// Writer iterface implementation
 	void WriteRPCReturn(Context &ctx, const Args &args) override final { responceRPC(ctx, errOK, args); }
-	void SetClientData(ClientData::Ptr data) override final { clientData_ = data; }
+	void SetClientData(ClientData::Ptr data) override final {
+		// Login is checked by connection's loop, when shared memory channel is opened
+		std::unique_lock<mutex> lck(wrBufLock_);
+		clientData_ = data;
+	}
 	ClientData::Ptr GetClientData() override final { return clientData_; }
+	void EnableCompression() override final { compression_ = true; }
 
 protected:
+	// Call with its own copy of request body, which is referenced by args
+	struct PendingCall {
+		RPCCall call;
+		std::string body;
+	};
+
 	void onRead() override;
 	void onClose() override;
 	void handleRPC(Context &ctx);
+	void schedule(std::shared_ptr<PendingCall> pending);
+	void dispatchCalls();
+	void execute(const std::shared_ptr<PendingCall> &pending);
+	void closeClient();
+	bool idle();
 	void responceRPC(Context &ctx, const Error &error, const Args &args);
-
-	bool respSent_ = false;
+	void openShm(Context &ctx);
 
 	Dispatcher &dispatcher_;
+	// Set by login. Written under wrBufLock_
 	ClientData::Ptr clientData_;
+	WorkerPool *pool_;
+	// Buffer for decompressed requests, used by connection's loop only
+	std::string unpacked_;
+	// Responces are compressed, client has negotiated it by login
+	std::atomic<bool> compression_;
+	// Connection is closed, calls, which are still posted to pool, are not executed. Guarded by wrBufLock_
+	bool closed_ = false;
+
+	// Calls of connection are executed concurrently and are answered in order of completion. Session commands are barriers:
+	// they wait for previous calls and next calls wait for them. Guarded by callsMtx_
+	std::mutex callsMtx_;
+	std::deque<std::shared_ptr<PendingCall>> waiting_;
+	int running_ = 0;
+	// Posted calls, whose workers have not finished using connection yet. Call is still executing after it stops running
+	int executing_ = 0;
+	bool barrier_ = false;
+	// Client data is released by the last running call
+	bool closing_ = false;
 };
 }  // namespace cproto
 }  // namespace net
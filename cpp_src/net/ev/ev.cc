@@ -297,7 +297,10 @@ extern "C" void net_ev_sighandler(int signum) {
 #endif
 }
 
-dynamic_loop::dynamic_loop() {
+// Period of loop load measurement
+static const std::chrono::seconds kLoadPeriod(5);
+
+dynamic_loop::dynamic_loop() : load_period_start_(std::chrono::steady_clock::now()) {
 	fds_.reserve(2048);
 	backend_.init(this);
 }
@@ -337,12 +340,37 @@ void dynamic_loop::run() {
 			while (timers_.size() && now >= timers_.front()->deadline_) {
 				auto tim = timers_.front();
 				timers_.erase(timers_.begin());
+				auto start = std::chrono::steady_clock::now();
 				tim->callback(1);
+				account_callback(start);
 			}
 		}
+		update_load(std::chrono::steady_clock::now());
 	}
 }
 
+void dynamic_loop::account_callback(std::chrono::steady_clock::time_point start) {
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	busy_ += elapsed;
+	max_callback_ = std::max(max_callback_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+	callbacks_++;
+}
+
+void dynamic_loop::update_load(std::chrono::steady_clock::time_point now) {
+	auto period = now - load_period_start_;
+	if (period < kLoadPeriod) return;
+
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+	load_.load = double(busy_.count()) / duration_cast<std::chrono::nanoseconds>(period).count();
+	load_.callbacks = callbacks_;
+	load_.avg_latency_us = callbacks_ ? duration_cast<microseconds>(busy_).count() / callbacks_ : 0;
+	load_.max_latency_us = duration_cast<microseconds>(max_callback_).count();
+	busy_ = max_callback_ = std::chrono::nanoseconds(0);
+	callbacks_ = 0;
+	load_period_start_ = now;
+}
+
 void dynamic_loop::break_loop() {
 	//
 	break_ = true;
@@ -462,15 +490,20 @@ void dynamic_loop::io_callback(int fd, int events) {
 	}
 
 	if (fds_[fd].watcher_) {
+		auto start = std::chrono::steady_clock::now();
 		fds_[fd].watcher_->callback(events);
+		account_callback(start);
 	}
 }
 
 void dynamic_loop::async_callback() {
-	for (auto async : asyncs_) {
-		if (async->sent_) {
+	// Callback can stop its watcher, so watchers are iterated by index.
+	// Flag is reset before callback, so sends made during callback are not lost
+	for (size_t i = 0; i < asyncs_.size(); i++) {
+		auto async = asyncs_[i];
+		if (async->sent_.exchange(false)) {
 			async->callback();
-			async->sent_ = false;
+			if (i < asyncs_.size() && asyncs_[i] != async) i--;
 		}
 	}
 }
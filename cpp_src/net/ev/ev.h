@@ -113,6 +113,17 @@ public:
 	void run();
 	void break_loop();
 
+	/// Time, spent by loop in callbacks during the last complete measurement period
+	struct load_stats {
+		// Part of period, when loop was busy: 0..1
+		double load = 0;
+		int64_t callbacks = 0;
+		// Average and maximum time of single callback. It is the delay of events, which are ready during callback execution
+		int64_t avg_latency_us = 0;
+		int64_t max_latency_us = 0;
+	};
+	const load_stats &get_load() const { return load_; }
+
 protected:
 	void set(int fd, io *watcher, int events);
 	void set(timer *watcher, double t);
@@ -126,6 +137,8 @@ protected:
 
 	void io_callback(int fd, int events);
 	void async_callback();
+	void account_callback(std::chrono::steady_clock::time_point start);
+	void update_load(std::chrono::steady_clock::time_point now);
 
 	struct fd_handler {
 		int emask_ = 0;
@@ -138,6 +151,11 @@ protected:
 	std::vector<sig *> sigs_;
 	bool break_ = false;
 	loop_backend backend_;
+
+	std::chrono::steady_clock::time_point load_period_start_;
+	std::chrono::nanoseconds busy_{0}, max_callback_{0};
+	int64_t callbacks_ = 0;
+	load_stats load_;
 };
 
 class loop_ref {
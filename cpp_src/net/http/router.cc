@@ -1,9 +1,12 @@
 #include "router.h"
+#include <chrono>
 #include <cstdarg>
 #include <unordered_map>
 #include "debug/allocdebug.h"
+#include "net/stat.h"
 #include "tools/fsops.h"
 #include "tools/stringstools.h"
+#include "vendor/gzip/gzip.h"
 
 namespace reindexer {
 namespace net {
@@ -49,20 +52,102 @@ HttpStatusCode HttpStatus::errCodeToHttpStatus(int errCode) {
 	}
 }
 
-int Context::JSON(int code, const string_view &slice) {
+// Smaller responces are not compressed
+const size_t kHttpMinCompressSize = 1024;
+
+static string_view trimSpaces(string_view str) {
+	while (str.size() && (str[0] == ' ' || str[0] == '\t')) str = str.substr(1);
+	while (str.size() && (str[str.size() - 1] == ' ' || str[str.size() - 1] == '\t')) str = str.substr(0, str.size() - 1);
+	return str;
+}
+
+// Check if Accept-Encoding lists gzip (or *) with non zero quality
+static bool acceptsGzip(string_view accept) {
+	while (accept.size()) {
+		size_t pos = accept.find(',');
+		string_view item = accept.substr(0, pos);
+		accept = (pos == string_view::npos) ? string_view() : accept.substr(pos + 1);
+
+		pos = item.find(';');
+		string_view coding = trimSpaces(item.substr(0, pos));
+		if (!iequals(coding, "gzip"_sv) && coding != "*"_sv) continue;
+		if (pos == string_view::npos) return true;
+
+		string_view q = trimSpaces(item.substr(pos + 1));
+		if (q.size() < 2 || (q[0] != 'q' && q[0] != 'Q') || q[1] != '=') return true;
+		for (size_t i = 2; i < q.size(); i++) {
+			if (q[i] != '0' && q[i] != '.') return true;
+		}
+	}
+	return false;
+}
+
+// Returns true, if body is compressed to packed
+bool Context::compressBody(const string_view &slice, std::string &packed) {
+	string_view accept = request ? request->headers.Get("Accept-Encoding"_sv) : string_view();
+	if (slice.size() >= kHttpMinCompressSize) writer->SetHeader(http::Header{"Vary", "Accept-Encoding"});
+	if (!accept.size() || !acceptsGzip(accept)) return false;
+
+	auto &stat = CompressionStat::Global();
+	if (slice.size() >= kHttpMinCompressSize) {
+		auto tm0 = std::chrono::steady_clock::now();
+		gzip::Compress(slice.data(), slice.size(), packed);
+		if (packed.size() < slice.size()) {
+			stat.Compressed(slice.size(), packed.size(),
+							std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tm0).count());
+			writer->SetHeader(http::Header{"Content-Encoding", "gzip"});
+			writer->SetContentLength(packed.size());
+			return true;
+		}
+	}
+	stat.Skipped();
+	return false;
+}
+
+int Context::WriteBody(const string_view &slice) {
+	std::string packed;
+	if (compressBody(slice, packed)) {
+		writer->Write(chunk(std::move(packed)));
+		return 0;
+	}
 	writer->SetContentLength(slice.size());
-	writer->SetRespCode(code);
-	writer->SetHeader(http::Header{"Content-Type", "application/json; charset=utf-8"});
 	writer->Write(slice);
 	return 0;
 }
 
+int Context::WriteBody(chunk &&body) {
+	std::string packed;
+	if (compressBody(string_view(body.data(), body.size()), packed)) {
+		writer->Write(chunk(std::move(packed)));
+		return 0;
+	}
+	writer->SetContentLength(body.size());
+	writer->Write(std::move(body));
+	return 0;
+}
+
+int Context::JSON(int code, const string_view &slice) {
+	writer->SetRespCode(code);
+	writer->SetHeader(http::Header{"Content-Type", "application/json; charset=utf-8"});
+	return WriteBody(slice);
+}
+
+int Context::JSON(int code, chunk &&body) {
+	writer->SetRespCode(code);
+	writer->SetHeader(http::Header{"Content-Type", "application/json; charset=utf-8"});
+	return WriteBody(std::move(body));
+}
+
+int Context::Data(int code, const char *contentType, chunk &&body) {
+	writer->SetRespCode(code);
+	writer->SetHeader(http::Header{"Content-Type", contentType});
+	return WriteBody(std::move(body));
+}
+
 int Context::String(int code, const string_view &slice) {
-	writer->SetContentLength(slice.size());
 	writer->SetRespCode(code);
 	writer->SetHeader(http::Header{"Content-Type", "text/plain; charset=utf-8"});
-	writer->Write(slice);
-	return 0;
+	return WriteBody(slice);
 }
 
 int Context::Redirect(const char *url) {
@@ -127,32 +212,21 @@ HttpMethod lookupMethod(const string_view &method) {
 	return HttpMethod(-1);
 }
 
-int Router::handle(Context &ctx) {
-	auto method = lookupMethod(ctx.request->method);
-	if (method < 0) {
-		return ctx.String(StatusBadRequest, "Invalid method");
-	}
-	int res = 0;
+Router::Route *Router::findRoute(Request &req) {
+	auto method = lookupMethod(req.method);
+	if (method < 0) return nullptr;
 
 	for (auto &r : routes_[method]) {
-		string_view url = ctx.request->path;
+		string_view url = req.path;
 		string_view route = r.path_;
-		ctx.request->urlParams.clear();
+		req.urlParams.clear();
 
 		for (;;) {
 			auto patternPos = route.find(':');
 			auto asteriskPos = route.find('*');
 			if (patternPos == string_view::npos || asteriskPos != string_view::npos) {
 				if (url.substr(0, asteriskPos) != route.substr(0, asteriskPos)) break;
-
-				for (auto &mw : middlewares_) {
-					res = mw.func_(mw.object_, ctx);
-					if (res != 0) {
-						return res;
-					}
-				}
-				res = r.h_.func_(r.h_.object_, ctx);
-				return res;
+				return &r;
 			}
 
 			if (url.substr(0, patternPos) != route.substr(0, patternPos)) break;
@@ -163,15 +237,38 @@ int Router::handle(Context &ctx) {
 			auto nextUrlPos = url.find('/');
 			auto nextRoutePos = route.find('/');
 
-			ctx.request->urlParams.push_back(url.substr(0, nextUrlPos));
+			req.urlParams.push_back(url.substr(0, nextUrlPos));
 
 			url = url.substr(nextUrlPos == string_view::npos ? nextUrlPos : nextUrlPos + 1);
 			route = route.substr(nextRoutePos == string_view::npos ? nextRoutePos : nextRoutePos + 1);
 		}
 	}
-	res = notFoundHandler_.object_ != nullptr ? notFoundHandler_.func_(notFoundHandler_.object_, ctx)
-											  : ctx.String(StatusNotFound, "Not found");
-	return res;
+	return nullptr;
+}
+
+bool Router::isStreamed(Request &req) {
+	Route *r = findRoute(req);
+	return r && r->streamBody_;
+}
+
+int Router::handle(Context &ctx) {
+	if (lookupMethod(ctx.request->method) < 0) {
+		return ctx.String(StatusBadRequest, "Invalid method");
+	}
+
+	Route *r = findRoute(*ctx.request);
+	if (!r) {
+		return notFoundHandler_.object_ != nullptr ? notFoundHandler_.func_(notFoundHandler_.object_, ctx)
+												   : ctx.String(StatusNotFound, "Not found");
+	}
+
+	for (auto &mw : middlewares_) {
+		int res = mw.func_(mw.object_, ctx);
+		if (res != 0) {
+			return res;
+		}
+	}
+	return r->h_.func_(r->h_.object_, ctx);
 }
 }  // namespace http
 }  // namespace net
@@ -6,6 +6,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include "estl/chain_buf.h"
 #include "estl/h_vector.h"
 #include "estl/string_view.h"
 #include "net/stat.h"
@@ -115,6 +116,8 @@ struct Request {
 class Writer {
 public:
 	virtual ssize_t Write(const void *buf, size_t size) = 0;
+	// Write data of chunk, which is moved to output buffer without copying
+	virtual ssize_t Write(chunk &&ch) = 0;
 
 	size_t Write(char ch) { return Write(&ch, 1); }
 	ssize_t Write(const string_view &buf) { return Write(buf.data(), buf.size()); }
@@ -143,19 +146,41 @@ public:
 	virtual ~ClientData() = default;
 };
 
+struct Context;
+
+/// Receiver of request body, which is delivered by pieces, as they are read from connection.
+/// Handler of route with streamed body is called before body is read, and sets Context::bodyConsumer
+class BodyConsumer {
+public:
+	virtual ~BodyConsumer() = default;
+	/// Process next piece of body. Data is valid only during call
+	virtual void Write(const string_view &data) = 0;
+	/// Body is completely read: write responce
+	virtual int Finish(Context &ctx) = 0;
+};
+
 struct Context {
 	int JSON(int code, const string_view &slice);
+	int JSON(int code, chunk &&body);
+	int Data(int code, const char *contentType, chunk &&body);
 	int String(int code, const string_view &slice);
 	int File(int code, const char *path, const string_view &data = string_view());
 	int Printf(int code, const char *contentType, const char *fmt, ...);
 	int Redirect(const char *url);
+	// Write responce body. It is compressed, if client accepts gzip coding and body is large enough
+	int WriteBody(const string_view &slice);
+	int WriteBody(chunk &&body);
 
 	Request *request;
 	Writer *writer;
 	Reader *body;
 	ClientData::Ptr clientData;
+	std::unique_ptr<BodyConsumer> bodyConsumer;
 
 	Stat stat;
+
+protected:
+	bool compressBody(const string_view &slice, std::string &packed);
 };
 
 class ServerConnection;
@@ -168,10 +193,11 @@ public:
 	/// Add handler for http POST method.
 	/// @param path - URI pattern
 	/// @param object - handler class object
+	/// @param streamBody - handler is called before body is read, body is delivered to Context::bodyConsumer
 	/// @tparam func - handler
 	template <class K, int (K::*func)(Context &)>
-	void POST(const char *path, K *object) {
-		addRoute<K, func>(kMethodPOST, path, object);
+	void POST(const char *path, K *object, bool streamBody = false) {
+		addRoute<K, func>(kMethodPOST, path, object, streamBody);
 	}
 	/// Add handler for http GET method.
 	/// @param path - URI pattern
@@ -200,10 +226,11 @@ public:
 	/// Add handler for http PUT method.
 	/// @param path - URI pattern
 	/// @param object - handler class object
+	/// @param streamBody - handler is called before body is read, body is delivered to Context::bodyConsumer
 	/// @tparam func - handler
 	template <class K, int (K::*func)(Context &)>
-	void PUT(const char *path, K *object) {
-		addRoute<K, func>(kMethodPUT, path, object);
+	void PUT(const char *path, K *object, bool streamBody = false) {
+		addRoute<K, func>(kMethodPUT, path, object, streamBody);
 	}
 	/// Add handler for http HEAD method.
 	/// @param path - URI pattern
@@ -237,15 +264,20 @@ public:
 	}
 
 protected:
+	struct Route;
+
 	int handle(Context &ctx);
+	// Check if body of request is streamed to handler
+	bool isStreamed(Request &req);
+	Route *findRoute(Request &req);
 	void log(Context &ctx) {
 		if (logger_) logger_(ctx);
 	}
 
 	template <class K, int (K::*func)(Context &)>
-	void addRoute(HttpMethod method, const char *path, K *object) {
+	void addRoute(HttpMethod method, const char *path, K *object, bool streamBody = false) {
 		Handler h{func_wrapper<K, func>, object};
-		Route r(path, h);
+		Route r(path, h, streamBody);
 		routes_[method].push_back(r);
 	}
 
@@ -260,10 +292,11 @@ protected:
 	};
 
 	struct Route {
-		Route(string path, Handler h) : path_(path), h_(h) {}
+		Route(string path, Handler h, bool streamBody) : path_(path), h_(h), streamBody_(streamBody) {}
 
 		string path_;
 		Handler h_;
+		bool streamBody_;
 	};
 
 	std::vector<Route> routes_[kMaxMethod];
@@ -23,6 +23,9 @@ bool ServerConnection::Restart(int fd) {
 	formData_ = false;
 	enableHttp11_ = false;
 	expectContinue_ = false;
+	streamBody_ = false;
+	bodyConsumer_.reset();
+	streamErr_ = HttpStatus();
 	callback(io_, ev::READ);
 	return true;
 }
@@ -47,7 +50,22 @@ void ServerConnection::handleRequest(Request &req) {
 	ctx.stat = stat;
 
 	try {
-		router_.handle(ctx);
+		if (!streamBody_) {
+			router_.handle(ctx);
+		} else if (!bodyConsumer_) {
+			// Handler of streamed body is called before body is read. If it responds without consumer of body,
+			// the rest of body is not read, and connection is closed
+			closeConn_ = true;
+			router_.handle(ctx);
+			if (ctx.bodyConsumer) {
+				closeConn_ = false;
+				bodyConsumer_ = std::move(ctx.bodyConsumer);
+				return;
+			}
+		} else {
+			if (streamErr_.code != StatusOK) throw streamErr_;
+			bodyConsumer_->Finish(ctx);
+		}
 	} catch (const HttpStatus &status) {
 		if (!writer.IsRespSent()) {
 			ctx.String(status.code, status.what);
@@ -60,6 +78,93 @@ void ServerConnection::handleRequest(Request &req) {
 	router_.log(ctx);
 
 	ctx.writer->Write(0, 0);
+	if (streamBody_) {
+		streamBody_ = false;
+		bodyConsumer_.reset();
+		streamErr_ = HttpStatus();
+	}
+}
+
+// Copy request line and headers from rdBuf_ to reqData_. Path and params are parts of uri
+void ServerConnection::saveRequest() {
+	size_t len = request_.uri.size() + request_.method.size();
+	for (auto &hdr : request_.headers) len += hdr.name.size() + hdr.val.size();
+	reqData_.clear();
+	reqData_.reserve(len);
+
+	auto copy = [this](const string_view &str) {
+		size_t pos = reqData_.size();
+		reqData_.append(str.data(), str.size());
+		return string_view(reqData_.data() + pos, str.size());
+	};
+	const char *uri = request_.uri.data();
+	request_.uri = copy(request_.uri);
+	auto move = [&](const string_view &str) {
+		return str.data() ? string_view(request_.uri.data() + (str.data() - uri), str.size()) : str;
+	};
+
+	request_.path = move(request_.path);
+	for (auto &param : request_.params) param = Param{move(param.name), move(param.val)};
+	request_.method = copy(request_.method);
+	for (auto &hdr : request_.headers) hdr = Header{copy(hdr.name), copy(hdr.val)};
+}
+
+// Returns -1, if value is not a non-negative decimal number
+ssize_t ServerConnection::parseContentLength(const string_view &val) {
+	if (!val.size() || val.size() > 18) return -1;
+	ssize_t len = 0;
+	for (size_t i = 0; i < val.size(); i++) {
+		if (val[i] < '0' || val[i] > '9') return -1;
+		len = len * 10 + (val[i] - '0');
+	}
+	return len;
+}
+
+void ServerConnection::consumeBody(const string_view &data) {
+	if (!data.size() || streamErr_.code != StatusOK) return;
+	try {
+		bodyConsumer_->Write(data);
+	} catch (const HttpStatus &status) {
+		streamErr_ = status;
+	} catch (const Error &err) {
+		streamErr_ = HttpStatus(StatusInternalServerError, err.what());
+	}
+}
+
+// Deliver contiguous piece of streamed body from rdBuf_ to consumer. Returns false on invalid chunked encoding
+bool ServerConnection::readStreamedBody() {
+	auto it = rdBuf_.tail();
+	if (bodyLeft_ > 0) {
+		size_t len = std::min(it.len, size_t(bodyLeft_));
+		consumeBody(string_view(it.data, len));
+		rdBuf_.erase(len);
+		bodyLeft_ -= len;
+	} else {
+		// Chunked body is decoded in place, decoder keeps its state between pieces
+		size_t len = it.len;
+		ssize_t res = phr_decode_chunked(&chunked_decoder_, it.data, &len);
+		if (res == -1) {
+			badRequest(StatusBadRequest, "Invalid chunked body");
+			return false;
+		}
+		consumeBody(string_view(it.data, len));
+		if (res >= 0) {
+			// Decoder moves data after the end of body to the end of decoded data. It is the beginning of next request,
+			// and must be returned to the beginning of buffer
+			std::string next(it.data + len, res);
+			rdBuf_.erase(it.len);
+			size_t rest = rdBuf_.size();
+			next.resize(res + rest);
+			rdBuf_.read(&next[res], rest);
+			rdBuf_.clear();
+			rdBuf_.write(next.data(), next.size());
+			bodyLeft_ = 0;
+		} else {
+			rdBuf_.erase(it.len);
+		}
+	}
+	if (!bodyLeft_) handleRequest(request_);
+	return true;
 }
 
 void ServerConnection::badRequest(int code, const char *msg) {
@@ -127,7 +232,9 @@ void ServerConnection::onRead() {
 	struct phr_header headers[kHttpMaxHeaders];
 
 	while (rdBuf_.size()) {
-		if (!bodyLeft_) {
+		if (streamBody_) {
+			if (!readStreamedBody()) return;
+		} else if (!bodyLeft_) {
 			auto it = rdBuf_.tail();
 
 			num_headers = kHttpMaxHeaders;
@@ -147,6 +254,7 @@ void ServerConnection::onRead() {
 			}
 
 			enableHttp11_ = (minor_version >= 1);
+			expectContinue_ = false;
 			request_.method = string_view(method, method_len);
 			request_.uri = string_view(uri, path_len);
 			request_.headers.clear();
@@ -163,12 +271,15 @@ void ServerConnection::onRead() {
 				Header hdr{string_view(headers[i].name, headers[i].name_len), string_view(headers[i].value, headers[i].value_len)};
 
 				if (iequals(hdr.name, "content-length"_sv)) {
-					bodyLeft_ = atoi(hdr.val.data());
+					bodyLeft_ = parseContentLength(hdr.val);
+					if (bodyLeft_ < 0) {
+						bodyLeft_ = 0;
+						badRequest(StatusBadRequest, "Invalid Content-Length");
+						return;
+					}
 				} else if (iequals(hdr.name, "transfer-encoding"_sv) && iequals(hdr.val, "chunked"_sv)) {
 					bodyLeft_ = -1;
 					memset(&chunked_decoder_, 0, sizeof(chunked_decoder_));
-					badRequest(http::StatusInternalServerError, "Sorry, chunked encoded body not implemented");
-					return;
 				} else if (iequals(hdr.name, "content-type"_sv) && iequals(hdr.val, "application/x-www-form-urlencoded"_sv)) {
 					formData_ = true;
 				} else if (iequals(hdr.name, "connection"_sv) && iequals(hdr.val, "close"_sv)) {
@@ -178,6 +289,29 @@ void ServerConnection::onRead() {
 				}
 				request_.headers.push_back(hdr);
 			}
+
+			if (router_.isStreamed(request_)) {
+				// Body of any size is delivered to handler by pieces, without buffering
+				saveRequest();
+				rdBuf_.erase(res);
+				streamBody_ = true;
+				handleRequest(request_);
+				if (closeConn_) return;
+				// Empty body is finished at once
+				if (!bodyLeft_) {
+					if (streamBody_) handleRequest(request_);
+					continue;
+				}
+				if (expectContinue_) {
+					writeHttpResponse(StatusContinue);
+					wrBuf_.write(kStrEOL, sizeof(kStrEOL) - 1);
+				}
+				continue;
+			}
+			if (bodyLeft_ < 0) {
+				badRequest(http::StatusInternalServerError, "Sorry, chunked encoded body not implemented");
+				return;
+			}
 			if (bodyLeft_ > 0 && unsigned(bodyLeft_ + res) > rdBuf_.capacity() && bodyLeft_ < kHttpMaxBodySize) {
 				// slow path: body is to big - need realloc
 				// save current buffer.
@@ -200,8 +334,6 @@ void ServerConnection::onRead() {
 				handleRequest(request_);
 			}
 		} else if (int(rdBuf_.size()) >= bodyLeft_) {
-			// TODO: support chunked request body
-
 			if (formData_) {
 				auto it = rdBuf_.tail();
 				if (it.len < size_t(bodyLeft_)) {
@@ -248,7 +380,8 @@ bool ServerConnection::ResponseWriter::SetContentLength(size_t length) {
 	return true;
 }
 
-ssize_t ServerConnection::ResponseWriter::Write(const void *buf, size_t size) {
+// Write status line and headers before the first piece of body, and size of piece of chunked body
+void ServerConnection::ResponseWriter::beginWrite(size_t size) {
 	char tmpBuf[256];
 	if (!respSend_) {
 		conn_->writeHttpResponse(code_);
@@ -280,8 +413,9 @@ ssize_t ServerConnection::ResponseWriter::Write(const void *buf, size_t size) {
 		conn_->wrBuf_.write(tmpBuf, n);
 		conn_->wrBuf_.write(kStrEOL, sizeof(kStrEOL) - 1);
 	}
+}
 
-	conn_->wrBuf_.write(reinterpret_cast<const char *>(buf), size);
+ssize_t ServerConnection::ResponseWriter::endWrite(size_t size) {
 	written_ += size;
 	if (isChunkedResponse()) {
 		conn_->wrBuf_.write(kStrEOL, sizeof(kStrEOL) - 1);
@@ -291,6 +425,20 @@ ssize_t ServerConnection::ResponseWriter::Write(const void *buf, size_t size) {
 	}
 	return size;
 }
+
+ssize_t ServerConnection::ResponseWriter::Write(const void *buf, size_t size) {
+	beginWrite(size);
+	conn_->wrBuf_.write(reinterpret_cast<const char *>(buf), size);
+	return endWrite(size);
+}
+
+ssize_t ServerConnection::ResponseWriter::Write(chunk &&ch) {
+	size_t size = ch.size();
+	beginWrite(size);
+	conn_->wrBuf_.write(std::move(ch));
+	return endWrite(size);
+}
+
 bool ServerConnection::ResponseWriter::SetConnectionClose() {
 	conn_->closeConn_ = true;
 	return true;
@@ -48,6 +48,7 @@ protected:
 		virtual bool SetContentLength(size_t len) override final;
 		virtual bool SetConnectionClose() override final;
 		ssize_t Write(const void *buf, size_t size) override final;
+		ssize_t Write(chunk &&ch) override final;
 		template <int N>
 		ssize_t Write(const char (&str)[N]) {
 			return Write(str, N - 1);
@@ -58,6 +59,8 @@ protected:
 
 	protected:
 		bool isChunkedResponse() { return contentLength_ == -1; }
+		void beginWrite(size_t size);
+		ssize_t endWrite(size_t size);
 
 		int code_ = StatusOK;
 		h_vector<char, 0x200> headers_;
@@ -68,6 +71,10 @@ protected:
 
 	void handleRequest(Request &req);
 	void badRequest(int code, const char *msg);
+	void saveRequest();
+	bool readStreamedBody();
+	void consumeBody(const string_view &data);
+	static ssize_t parseContentLength(const string_view &val);
 	void onRead() override;
 	void onClose() override;
 
@@ -81,7 +88,13 @@ protected:
 	bool enableHttp11_ = false;
 	bool expectContinue_ = false;
 	phr_chunked_decoder chunked_decoder_;
-	// cbuf<char> tmpBuf_;
+	// Body of current request is delivered to bodyConsumer_ by pieces, instead of reading it into rdBuf_ as a whole
+	bool streamBody_ = false;
+	std::unique_ptr<BodyConsumer> bodyConsumer_;
+	// Error of bodyConsumer_. Rest of body is skipped, and error is responded after it
+	HttpStatus streamErr_;
+	// Copy of request line and headers of streamed request: they are overwritten in rdBuf_ by body
+	std::string reqData_;
 };
 }  // namespace http
 }  // namespace net
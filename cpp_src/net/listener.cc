@@ -6,6 +6,7 @@
 #include "core/type_consts.h"
 #include "net/http/serverconnection.h"
 #include "tools/logger.h"
+#include "tools/oscompat.h"
 
 #if REINDEX_WITH_GPERFTOOLS
 #include <gperftools/heap-profiler.h>
@@ -21,7 +22,18 @@ namespace net {
 
 static atomic<int> counter_;
 
-Listener::Listener(ev::dynamic_loop &loop, std::shared_ptr<Shared> shared) : loop_(loop), shared_(shared), id_(counter_++) {
+// Load mode: thread gives connections only when it is busy for this part of time, to thread which is less busy at least by gap
+static const double kRebalanceMinLoad = 0.5;
+static const double kRebalanceLoadGap = 0.2;
+
+static ListenerOpts maxListenersOpts(int maxListeners) {
+	ListenerOpts opts;
+	opts.maxListeners = maxListeners;
+	return opts;
+}
+
+Listener::Listener(ev::dynamic_loop &loop, std::shared_ptr<Shared> shared)
+	: loop_(loop), shared_(shared), id_(counter_++), stats_{id_, 0, 0, 0, 0, {}} {
 	io_.set<Listener, &Listener::io_accept>(this);
 	io_.set(loop);
 	timer_.set<Listener, &Listener::timeout_cb>(this);
@@ -35,10 +47,14 @@ Listener::Listener(ev::dynamic_loop &loop, std::shared_ptr<Shared> shared) : loo
 }
 
 Listener::Listener(ev::dynamic_loop &loop, ConnectionFactory connFactory, int maxListeners)
-	: Listener(loop, std::make_shared<Shared>(connFactory, maxListeners ? maxListeners : std::thread::hardware_concurrency())) {}
+	: Listener(loop, connFactory, maxListenersOpts(maxListeners)) {}
+
+Listener::Listener(ev::dynamic_loop &loop, ConnectionFactory connFactory, const ListenerOpts &opts)
+	: Listener(loop, std::make_shared<Shared>(connFactory, opts)) {}
 
 Listener::~Listener() {
 	io_.stop();
+	if (sock_.valid() && sock_.fd() != shared_->sock_.fd()) sock_.close();
 	std::lock_guard<std::mutex> lck(shared_->lck_);
 	auto it = std::find(shared_->listeners_.begin(), shared_->listeners_.end(), this);
 	assert(it != shared_->listeners_.end());
@@ -52,18 +68,33 @@ bool Listener::Bind(string addr) {
 	}
 
 	shared_->addr_ = addr;
+	// Only one unix domain socket can be bound to the path
+	if (socket::is_unix_addr(addr.c_str())) shared_->reusePort_ = false;
 
-	if (shared_->sock_.bind(addr.c_str()) < 0) {
+	if (!listen(shared_->sock_, shared_->reusePort_)) {
 		return false;
 	}
+	sock_ = shared_->sock_;
 
-	if (shared_->sock_.listen(500) < 0) {
-		perror("listen error");
+	io_.start(sock_.fd(), ev::READ);
+	reserveStack();
+	// Kernel distributes connections only between already bound sockets, so all threads are started at once
+	if (shared_->reusePort_) Fork(shared_->maxListeners_ - 1);
+	return true;
+}
+
+bool Listener::listen(socket &sock, bool reusePort) {
+	// Address is modified by bind
+	string addr = shared_->addr_;
+	if (sock.bind(addr.c_str(), reusePort) < 0 || !sock.valid()) {
 		return false;
 	}
 
-	io_.start(shared_->sock_.fd(), ev::READ);
-	reserveStack();
+	if (sock.listen(500) < 0) {
+		perror("listen error");
+		sock.close();
+		return false;
+	}
 	return true;
 }
 
@@ -73,22 +104,29 @@ void Listener::io_accept(ev::io & /*watcher*/, int revents) {
 		return;
 	}
 
-	auto client = shared_->sock_.accept();
+	auto client = sock_.accept();
 
 	if (!client.valid()) {
 		return;
 	}
 
+	std::unique_ptr<IServerConnection> conn;
 	std::unique_lock<mutex> lck(shared_->lck_);
 	if (shared_->idle_.size()) {
-		auto conn = std::move(shared_->idle_.back());
+		conn = std::move(shared_->idle_.back());
 		shared_->idle_.pop_back();
+	}
+	// Connection may handle already received request right now, and the handler may need the lock (e.g. for GetStats)
+	lck.unlock();
+	if (conn) {
 		conn->Attach(loop_);
 		conn->Restart(client.fd());
-		connections_.push_back(std::move(conn));
 	} else {
-		connections_.push_back(std::unique_ptr<IServerConnection>(shared_->connFactory_(loop_, client.fd())));
+		conn.reset(shared_->connFactory_(loop_, client.fd()));
 	}
+	lck.lock();
+	connections_.push_back(std::move(conn));
+	stats_.accepted++;
 	if (shared_->count_ < shared_->maxListeners_) {
 		shared_->count_++;
 		std::thread th(&Listener::clone, shared_);
@@ -119,32 +157,66 @@ void Listener::timeout_cb(ev::periodic &, int) {
 	}
 
 	int curConnCount = connections_.size();
+	stats_.load = loop_.get_load();
+	movedLoad_ = 0;
 
-	if (!std::getenv("REINDEXER_NOREBALANCE")) {
-		// Try to rebalance
-		int minConnCount = INT_MAX;
-		auto minIt = shared_->listeners_.begin();
+	Listener *target = rebalanceTarget();
+	if (target) {
+		logPrintf(LogInfo, "Rebalance connection from listener %d to %d", id_, target->id_);
+		auto conn = std::move(connections_.back());
+		conn->Detach();
+		target->connections_.push_back(std::move(conn));
+		target->async_.send();
+		connections_.pop_back();
+		stats_.movedOut++;
+		target->stats_.movedIn++;
+		// Several threads should not choose the same target, until it measures its new load
+		double connLoad = stats_.load.load / curConnCount;
+		movedLoad_ -= connLoad;
+		target->movedLoad_ += connLoad;
+	}
+	if (curConnCount != 0) {
+		logPrintf(LogTrace, "Listener(%s) %d stats: %d connections, load %d%%, callback avg %dus, max %dus", shared_->addr_.c_str(), id_,
+				  curConnCount, int(stats_.load.load * 100), int(stats_.load.avg_latency_us), int(stats_.load.max_latency_us));
+	}
+}
+
+Listener *Listener::rebalanceTarget() {
+	int curConnCount = connections_.size();
+	Listener *target = nullptr;
 
-		for (auto it = minIt; it != shared_->listeners_.end(); it++) {
-			int connCount = (*it)->connections_.size();
-			if (connCount < minConnCount) {
-				minIt = it;
-				minConnCount = connCount;
+	switch (shared_->rebalance_) {
+		case RebalanceMode::None:
+			break;
+		case RebalanceMode::Connections: {
+			int minConnCount = INT_MAX;
+			for (auto listener : shared_->listeners_) {
+				int connCount = listener->connections_.size();
+				if (connCount < minConnCount) {
+					target = listener;
+					minConnCount = connCount;
+				}
 			}
+			if (minConnCount + 1 >= curConnCount) target = nullptr;
+			break;
 		}
-
-		if (minConnCount + 1 < curConnCount) {
-			logPrintf(LogInfo, "Rebalance connection from listener %d to %d", id_, (*minIt)->id_);
-			auto conn = std::move(connections_.back());
-			conn->Detach();
-			(*minIt)->connections_.push_back(std::move(conn));
-			(*minIt)->async_.send();
-			connections_.pop_back();
+		case RebalanceMode::Load: {
+			double load = stats_.load.load + movedLoad_;
+			if (curConnCount < 2 || load < kRebalanceMinLoad) break;
+			// Target should remain less loaded after move, otherwise connection would be moved back
+			double connLoad = stats_.load.load / curConnCount;
+			double minLoad = load - std::max(kRebalanceLoadGap, 2 * connLoad);
+			for (auto listener : shared_->listeners_) {
+				double targetLoad = listener->stats_.load.load + listener->movedLoad_;
+				if (targetLoad < minLoad) {
+					target = listener;
+					minLoad = targetLoad;
+				}
+			}
+			break;
 		}
 	}
-	if (curConnCount != 0) {
-		logPrintf(LogTrace, "Listener(%s) %d stats: %d connections", shared_->addr_.c_str(), id_, curConnCount);
-	}
+	return target;
 }
 
 void Listener::async_cb(ev::async &watcher) {
@@ -158,6 +230,9 @@ void Listener::async_cb(ev::async &watcher) {
 
 void Listener::Stop() {
 	std::lock_guard<std::mutex> lck(shared_->lck_);
+	if (!shared_->terminating_ && shared_->sock_.valid() && socket::is_unix_addr(shared_->addr_.c_str())) {
+		::unlink(socket::unix_path(shared_->addr_.c_str()));
+	}
 	shared_->terminating_ = true;
 	for (auto listener : shared_->listeners_) {
 		listener->async_.send();
@@ -171,6 +246,16 @@ void Listener::Stop() {
 	}
 }
 
+vector<Listener::LoopStats> Listener::GetStats() {
+	std::lock_guard<std::mutex> lck(shared_->lck_);
+	vector<LoopStats> stats;
+	for (auto listener : shared_->listeners_) {
+		stats.push_back(listener->stats_);
+		stats.back().connections = listener->connections_.size();
+	}
+	return stats;
+}
+
 void Listener::Fork(int clones) {
 	for (int i = 0; i < clones; i++) {
 		std::thread th(&Listener::clone, shared_);
@@ -183,7 +268,13 @@ void Listener::clone(std::shared_ptr<Shared> shared) {
 	ev::dynamic_loop loop;
 	Listener listener(loop, shared);
 	ProfilerRegisterThread();
-	listener.io_.start(listener.shared_->sock_.fd(), ev::READ);
+	if (!shared->reusePort_) {
+		listener.sock_ = shared->sock_;
+	} else if (!listener.listen(listener.sock_, true)) {
+		logPrintf(LogError, "Listener(%s) %d can't bind own socket", shared->addr_.c_str(), listener.id_);
+		return;
+	}
+	listener.io_.start(listener.sock_.fd(), ev::READ);
 	while (!listener.shared_->terminating_) {
 		loop.run();
 	}
@@ -194,8 +285,13 @@ void Listener::reserveStack() {
 	for (size_t i = 0; i < sizeof(placeholder); i += 4096) placeholder[i] = i & 0xFF;
 }
 
-Listener::Shared::Shared(ConnectionFactory connFactory, int maxListeners)
-	: maxListeners_(maxListeners), count_(1), connFactory_(connFactory), terminating_(false) {}
+Listener::Shared::Shared(ConnectionFactory connFactory, const ListenerOpts &opts)
+	: maxListeners_(opts.maxListeners ? opts.maxListeners : std::thread::hardware_concurrency()),
+	  reusePort_(opts.reusePort),
+	  rebalance_(std::getenv("REINDEXER_NOREBALANCE") ? RebalanceMode::None : opts.rebalance),
+	  count_(1),
+	  connFactory_(connFactory),
+	  terminating_(false) {}
 
 Listener::Shared::~Shared() { sock_.close(); }
 
@@ -15,14 +15,41 @@ namespace net {
 using std::atomic;
 using std::vector;
 
+/// Policy of moving connections between listener threads
+enum class RebalanceMode {
+	None,
+	// Move connection from thread, which has 2+ connections more than the least loaded one
+	Connections,
+	// Move connection from busy thread to the thread with the lowest time, spent in callbacks
+	Load,
+};
+
+struct ListenerOpts {
+	// Maximum number of threads, which listener will utilize. std::thread::hardware_concurrency() by default
+	int maxListeners = 0;
+	// Each thread accepts connections on its own SO_REUSEPORT socket. Threads are started on Bind
+	bool reusePort = false;
+	RebalanceMode rebalance = RebalanceMode::Connections;
+};
+
 /// Network listener implementation
 class Listener {
 public:
+	/// Statistics of listener thread
+	struct LoopStats {
+		int id;
+		int connections;
+		// Connections, accepted by thread, and moved to/from it by rebalancing
+		int64_t accepted, movedIn, movedOut;
+		ev::dynamic_loop::load_stats load;
+	};
+
 	/// Constructs new listner object.
 	/// @param loop - ev::loop of caller's thread, listener's socket will be binded to that loop.
 	/// @param connFactory - Connection factory, will create objects with IServerConnection interface implementation.
 	/// @param maxListeners - Maximum number of threads, which listener will utilize. std::thread::hardware_concurrency() by default
 	Listener(ev::dynamic_loop &loop, ConnectionFactory connFactory, int maxListeners = 0);
+	Listener(ev::dynamic_loop &loop, ConnectionFactory connFactory, const ListenerOpts &opts);
 	~Listener();
 	/// Bind listener to specified host:port
 	/// @param addr - tcp host:port for bind
@@ -33,18 +60,24 @@ public:
 	void Fork(int clones);
 	/// Stop synchroniusly stops listener
 	void Stop();
+	/// Get statistics of all listener threads. Statistics is updated by each thread every 5 seconds
+	vector<LoopStats> GetStats();
 
 protected:
 	void reserveStack();
 	void io_accept(ev::io &watcher, int revents);
 	void timeout_cb(ev::periodic &watcher, int);
 	void async_cb(ev::async &watcher);
+	Listener *rebalanceTarget();
+	bool listen(socket &sock, bool reusePort);
 
 	struct Shared {
-		Shared(ConnectionFactory connFactory, int maxListeners);
+		Shared(ConnectionFactory connFactory, const ListenerOpts &opts);
 		~Shared();
 		socket sock_;
 		int maxListeners_;
+		bool reusePort_;
+		RebalanceMode rebalance_;
 		std::atomic<int> count_;
 		vector<Listener *> listeners_;
 		std::mutex lck_;
@@ -64,6 +97,11 @@ protected:
 	std::shared_ptr<Shared> shared_;
 	vector<std::unique_ptr<IServerConnection>> connections_;
 	int id_;
+	// Listening socket: shared one, or own socket in reusePort mode
+	socket sock_;
+	LoopStats stats_;
+	// Estimate of load, moved to/from thread with connections since the last measurement
+	double movedLoad_ = 0;
 };
 }  // namespace net
 }  // namespace reindexer
@@ -0,0 +1,254 @@
+#include "shmchannel.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include "tools/oscompat.h"
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+#endif
+
+namespace reindexer {
+namespace net {
+
+const int ShmChannel::kFdsCount;
+const size_t ShmChannel::kMinRingSize;
+const size_t ShmChannel::kMaxRingSize;
+
+static const uint32_t kShmMagic = 0x4D485352;
+// Header is followed by request ring and responce ring
+static const size_t kShmHeaderSize = 0x1000;
+
+struct ShmChannel::Ring {
+	// Total number of bytes, written by producer and read by consumer
+	alignas(64) std::atomic<uint64_t> head;
+	alignas(64) std::atomic<uint64_t> tail;
+	// Consumer waits for data, producer waits for free space. Peer signals eventfd, only if flag is set
+	alignas(64) std::atomic<uint32_t> readerWaiting;
+	std::atomic<uint32_t> writerWaiting;
+};
+
+struct ShmChannel::Header {
+	uint32_t magic;
+	uint32_t ringSize;
+	Ring rings[2];
+};
+
+ShmChannel *ShmChannel::Create(size_t ringSize) {
+#if defined(__linux__) && defined(__NR_memfd_create)
+	static_assert(sizeof(Header) <= kShmHeaderSize, "Header of shared memory is too big");
+	size_t size = kMinRingSize;
+	while (size < ringSize && size < kMaxRingSize) size <<= 1;
+
+	std::unique_ptr<ShmChannel> ch(new ShmChannel(true));
+	ch->fds_[0] = syscall(__NR_memfd_create, "reindexer_shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (ch->fds_[0] < 0) {
+		perror("memfd_create error");
+		return nullptr;
+	}
+	if (ftruncate(ch->fds_[0], kShmHeaderSize + 2 * size) < 0) {
+		perror("ftruncate error");
+		return nullptr;
+	}
+	// Memory is writable by client, and its truncation would crash server on next access to mapping
+	if (fcntl(ch->fds_[0], F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+		perror("fcntl(F_ADD_SEALS) error");
+		return nullptr;
+	}
+	for (int i = 1; i < kFdsCount; i++) {
+		ch->fds_[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (ch->fds_[i] < 0) {
+			perror("eventfd error");
+			return nullptr;
+		}
+	}
+	if (!ch->map(kShmHeaderSize + 2 * size)) return nullptr;
+
+	ch->ringSize_ = size;
+	ch->hdr_->magic = kShmMagic;
+	ch->hdr_->ringSize = size;
+	for (auto &ring : ch->hdr_->rings) {
+		ring.head = 0;
+		ring.tail = 0;
+		// Consumer has not read yet, so first data is signalled
+		ring.readerWaiting = 1;
+		ring.writerWaiting = 0;
+	}
+	return ch.release();
+#else
+	(void)ringSize;
+	return nullptr;
+#endif
+}
+
+ShmChannel *ShmChannel::Open(const int *fds) {
+	std::unique_ptr<ShmChannel> ch(new ShmChannel(false));
+	std::copy(fds, fds + kFdsCount, ch->fds_);
+#ifdef __linux__
+	struct stat st;
+	if (fstat(ch->fds_[0], &st) < 0 || size_t(st.st_size) < kShmHeaderSize || !ch->map(st.st_size)) return nullptr;
+
+	size_t size = ch->hdr_->ringSize;
+	if (ch->hdr_->magic != kShmMagic || size < kMinRingSize || (size & (size - 1)) || kShmHeaderSize + 2 * size > ch->mapSize_) {
+		fprintf(stderr, "Invalid header of shared memory\n");
+		return nullptr;
+	}
+	ch->ringSize_ = size;
+	return ch.release();
+#else
+	return nullptr;
+#endif
+}
+
+ShmChannel::~ShmChannel() {
+#ifdef __linux__
+	if (hdr_) munmap(hdr_, mapSize_);
+	for (int fd : fds_) {
+		if (fd >= 0) close(fd);
+	}
+#endif
+}
+
+bool ShmChannel::map(size_t size) {
+#ifdef __linux__
+	void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fds_[0], 0);
+	if (ptr == MAP_FAILED) {
+		perror("mmap error");
+		return false;
+	}
+	hdr_ = reinterpret_cast<Header *>(ptr);
+	mapSize_ = size;
+	return true;
+#else
+	(void)size;
+	return false;
+#endif
+}
+
+ShmChannel::Ring &ShmChannel::in() const { return hdr_->rings[server_ ? 0 : 1]; }
+ShmChannel::Ring &ShmChannel::out() const { return hdr_->rings[server_ ? 1 : 0]; }
+char *ShmChannel::data(const Ring &ring) const {
+	return reinterpret_cast<char *>(hdr_) + kShmHeaderSize + (&ring == &hdr_->rings[0] ? 0 : ringSize_);
+}
+
+// Indexes in shared memory are writable by peer, so they are checked on each load: invalid ones would lead out of ring
+bool ShmChannel::checkIndexes(uint64_t head, uint64_t tail) const {
+	if (head - tail <= ringSize_) return true;
+	fprintf(stderr, "Invalid indexes of shared memory ring: head=%llu, tail=%llu\n", static_cast<unsigned long long>(head),
+			static_cast<unsigned long long>(tail));
+	errno = EPROTO;
+	return false;
+}
+
+ssize_t ShmChannel::Recv(char *buf, size_t len) {
+	Ring &ring = in();
+	const char *rdata = data(ring);
+	uint64_t tail = inTail_;
+	size_t n = 0;
+
+	for (;;) {
+		uint64_t head = ring.head.load(std::memory_order_acquire);
+		if (!checkIndexes(head, tail)) return -1;
+		size_t avail = std::min(size_t(head - tail), len - n);
+		size_t pos = tail & (ringSize_ - 1), first = std::min(avail, ringSize_ - pos);
+		memcpy(buf + n, rdata + pos, first);
+		memcpy(buf + n + first, rdata, avail - first);
+		n += avail;
+		tail += avail;
+		if (n == len) break;
+		// Ring is empty. Producer could write before waiting was announced, so ring is checked again
+		ring.readerWaiting = 1;
+		if (ring.head == tail) break;
+		ring.readerWaiting = 0;
+	}
+
+	if (!n) {
+		errno = EAGAIN;
+		return -1;
+	}
+	inTail_ = tail;
+	ring.tail = tail;
+	if (ring.writerWaiting.exchange(0)) notify(fds_[server_ ? 2 : 1]);
+	return n;
+}
+
+ssize_t ShmChannel::Send(const chain_buf::span *spans, size_t cnt) {
+	Ring &ring = out();
+	char *wdata = data(ring);
+	uint64_t head = outHead_;
+	size_t n = 0, i = 0, offset = 0;
+
+	for (;;) {
+		uint64_t tail = ring.tail.load(std::memory_order_acquire);
+		if (!checkIndexes(head, tail)) return -1;
+		size_t space = ringSize_ - size_t(head - tail);
+		while (space && i < cnt) {
+			size_t len = std::min(space, spans[i].len - offset);
+			size_t pos = head & (ringSize_ - 1), first = std::min(len, ringSize_ - pos);
+			memcpy(wdata + pos, spans[i].data + offset, first);
+			memcpy(wdata, spans[i].data + offset + first, len - first);
+			head += len;
+			n += len;
+			space -= len;
+			offset += len;
+			if (offset == spans[i].len) {
+				i++;
+				offset = 0;
+			}
+		}
+		if (i == cnt) break;
+		// Ring is full. Consumer could free space before waiting was announced, so ring is checked again
+		ring.writerWaiting = 1;
+		if (head - ring.tail == ringSize_) break;
+		ring.writerWaiting = 0;
+	}
+
+	if (!n) {
+		errno = EAGAIN;
+		return -1;
+	}
+	outHead_ = head;
+	ring.head = head;
+	if (ring.readerWaiting.exchange(0)) notify(fds_[server_ ? 2 : 1]);
+	return n;
+}
+
+bool ShmChannel::Readable() const {
+	Ring &ring = in();
+	return ring.head.load(std::memory_order_acquire) != inTail_;
+}
+
+void ShmChannel::ResetEvent() {
+#ifdef __linux__
+	uint64_t cnt;
+	if (read(EventFd(), &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) perror("eventfd read error");
+#endif
+}
+
+void ShmChannel::notify(int fd) {
+#ifdef __linux__
+	uint64_t one = 1;
+	if (write(fd, &one, sizeof(one)) < 0 && errno != EAGAIN) perror("eventfd write error");
+#else
+	(void)fd;
+#endif
+}
+
+}  // namespace net
+}  // namespace reindexer
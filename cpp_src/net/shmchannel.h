@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include "estl/chain_buf.h"
+#include "tools/ssize_t.h"
+
+namespace reindexer {
+namespace net {
+
+/// Transport between processes of the same host: pair of single producer/single consumer byte rings in shared memory (memfd),
+/// request ring is written by client, responce ring is written by server. Each side waits for peer on its own eventfd,
+/// which is signalled only when side has announced, that it waits for data or for free space.
+/// Server creates channel and passes its descriptors to client by unix socket. Memory can't be resized by client. Supported on linux only
+class ShmChannel {
+public:
+	// Descriptors of channel: memory, server's eventfd, client's eventfd
+	static const int kFdsCount = 3;
+	static const size_t kMinRingSize = 0x10000;
+	static const size_t kMaxRingSize = 0x10000000;
+
+	/// Create channel on server side. Ring size is rounded up to power of 2. Returns nullptr, if shared memory is not supported
+	static ShmChannel *Create(size_t ringSize);
+	/// Open channel on client side by descriptors, received from server. Descriptors are owned by channel
+	static ShmChannel *Open(const int *fds);
+	~ShmChannel();
+	ShmChannel(const ShmChannel &) = delete;
+	ShmChannel &operator=(const ShmChannel &) = delete;
+
+	/// Read from incoming ring. Returns -1 with errno EAGAIN, if ring is empty, or with errno EPROTO, if peer has corrupted ring
+	ssize_t Recv(char *buf, size_t len);
+	/// Write to outgoing ring. Returns -1 with errno EAGAIN, if ring is full, or with errno EPROTO, if peer has corrupted ring
+	ssize_t Send(const chain_buf::span *spans, size_t cnt);
+	/// Incoming ring has data
+	bool Readable() const;
+
+	/// Descriptor, which is readable, when peer has written data or has freed space in ring
+	int EventFd() const { return fds_[server_ ? 1 : 2]; }
+	/// Reset notification of EventFd
+	void ResetEvent();
+	/// Signal own EventFd, e.g. when data is left in incoming ring
+	void WakeSelf() { notify(EventFd()); }
+	const int *Fds() const { return fds_; }
+	size_t RingSize() const { return ringSize_; }
+
+protected:
+	struct Ring;
+	struct Header;
+
+	ShmChannel(bool server) : server_(server) {}
+	bool map(size_t size);
+	static void notify(int fd);
+	Ring &in() const;
+	Ring &out() const;
+	char *data(const Ring &ring) const;
+	bool checkIndexes(uint64_t head, uint64_t tail) const;
+
+	bool server_;
+	int fds_[kFdsCount] = {-1, -1, -1};
+	Header *hdr_ = nullptr;
+	size_t mapSize_ = 0;
+	size_t ringSize_ = 0;
+	// Own indexes of rings are kept out of shared memory, which can be overwritten by peer
+	uint64_t inTail_ = 0;
+	uint64_t outHead_ = 0;
+};
+
+}  // namespace net
+}  // namespace reindexer
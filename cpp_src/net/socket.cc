@@ -4,14 +4,72 @@
 #include <errno.h>
 #include <memory.h>
 #include <stdio.h>
+#include <algorithm>
+#include <memory>
 #include "tools/oscompat.h"
 
+#ifndef _WIN32
+#include <sys/un.h>
+#endif
+
+#ifdef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC_FLAG MSG_CMSG_CLOEXEC
+#else
+#define MSG_CMSG_CLOEXEC_FLAG 0
+#endif
+
 namespace reindexer {
 namespace net {
 
-int socket::bind(const char *addr) {
+static const char kUnixPrefix[] = "unix://";
+
+bool socket::is_unix_addr(const char *addr) { return strncmp(addr, kUnixPrefix, sizeof(kUnixPrefix) - 1) == 0; }
+const char *socket::unix_path(const char *addr) { return addr + sizeof(kUnixPrefix) - 1; }
+
+#ifndef _WIN32
+// Socket file is not removed, if server was killed. It is removed only if nobody listens on it
+static void unlink_stale(const struct sockaddr_un &sun) {
+	struct stat st;
+	if (::stat(sun.sun_path, &st) != 0 || !S_ISSOCK(st.st_mode)) return;
+	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) return;
+	if (::connect(fd, reinterpret_cast<const struct sockaddr *>(&sun), sizeof(sun)) != 0 && errno == ECONNREFUSED) {
+		::unlink(sun.sun_path);
+	}
+	::close(fd);
+}
+#endif
+
+int socket::bind(const char *addr, bool reusePort) {
+#ifndef _WIN32
+	if (is_unix_addr(addr)) {
+		struct sockaddr_un sun;
+		int ret = create_unix(addr, sun);
+		if (!ret) {
+			unlink_stale(sun);
+			if (::bind(fd_, reinterpret_cast<struct sockaddr *>(&sun), sizeof(sun)) != 0) {
+				perror("bind error");
+				close();
+			}
+		}
+		return ret;
+	}
+#endif
 	struct addrinfo *results = nullptr;
 	int ret = create(addr, &results);
+	if (!ret && reusePort) {
+#ifdef SO_REUSEPORT
+		int enable = 1;
+		if (::setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<char *>(&enable), sizeof(enable)) < 0) {
+			perror("setsockopt(SO_REUSEPORT) failed");
+			ret = -1;
+		}
+#else
+		fprintf(stderr, "SO_REUSEPORT is not supported\n");
+		ret = -1;
+#endif
+		if (ret) close();
+	}
 	if (!ret) {
 		if (::bind(fd_, results->ai_addr, results->ai_addrlen) != 0) {
 			perror("bind error");
@@ -25,6 +83,19 @@ int socket::bind(const char *addr) {
 }
 
 int socket::connect(const char *addr) {
+#ifndef _WIN32
+	if (is_unix_addr(addr)) {
+		struct sockaddr_un sun;
+		int ret = create_unix(addr, sun);
+		if (!ret) {
+			if (::connect(fd_, reinterpret_cast<struct sockaddr *>(&sun), sizeof(sun)) != 0 && !would_block(last_error())) {
+				perror("connect error");
+				close();
+			}
+		}
+		return ret;
+	}
+#endif
 	struct addrinfo *results = nullptr;
 	int ret = create(addr, &results);
 	if (!ret) {
@@ -45,6 +116,8 @@ int socket::listen(int backlog) {
 #ifdef __linux__
 	int enable = 1;
 
+	if (unix_) return ::listen(fd_, backlog);
+
 	if (setsockopt(fd_, SOL_TCP, TCP_DEFER_ACCEPT, &enable, sizeof(enable)) < 0) {
 		perror("setsockopt(TCP_DEFER_ACCEPT) failed");
 	}
@@ -63,6 +136,89 @@ int socket::send(const char *buf, size_t len) {
 	//
 	return ::send(fd_, buf, len, 0);
 }
+int socket::send(const chain_buf::span *spans, size_t cnt) {
+#ifndef _WIN32
+	struct iovec iov[kMaxSendSpans];
+	cnt = std::min(cnt, kMaxSendSpans);
+	for (size_t i = 0; i < cnt; i++) {
+		iov[i].iov_base = const_cast<char *>(spans[i].data);
+		iov[i].iov_len = spans[i].len;
+	}
+	return ::writev(fd_, iov, cnt);
+#else
+	return cnt ? send(spans[0].data, spans[0].len) : 0;
+#endif
+}
+
+int socket::send_fds(const char *buf, size_t len, const int *fds, int cnt) {
+#ifndef _WIN32
+	struct iovec iov;
+	iov.iov_base = const_cast<char *>(buf);
+	iov.iov_len = len;
+	std::unique_ptr<char[]> ctl(new char[CMSG_SPACE(cnt * sizeof(int))]());
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctl.get();
+	msg.msg_controllen = CMSG_SPACE(cnt * sizeof(int));
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(cnt * sizeof(int));
+	memcpy(CMSG_DATA(cmsg), fds, cnt * sizeof(int));
+	return ::sendmsg(fd_, &msg, 0);
+#else
+	(void)buf;
+	(void)len;
+	(void)fds;
+	(void)cnt;
+	errno = ENOTSUP;
+	return -1;
+#endif
+}
+
+int socket::recv_fds(char *buf, size_t len, int *fds, int &cnt) {
+#ifndef _WIN32
+	struct iovec iov;
+	iov.iov_base = buf;
+	iov.iov_len = len;
+	std::unique_ptr<char[]> ctl(new char[CMSG_SPACE(cnt * sizeof(int))]());
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctl.get();
+	msg.msg_controllen = CMSG_SPACE(cnt * sizeof(int));
+	int ret = ::recvmsg(fd_, &msg, MSG_CMSG_CLOEXEC_FLAG);
+	int received = 0;
+	if (ret >= 0) {
+		for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+			int n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+			for (int i = 0; i < n; i++) {
+				int fd;
+				memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+				// Extra descriptors are not expected, but they must not leak
+				if (received < cnt) {
+					fds[received++] = fd;
+				} else {
+					::close(fd);
+				}
+			}
+		}
+	}
+	cnt = received;
+	return ret;
+#else
+	(void)buf;
+	(void)len;
+	(void)fds;
+	cnt = 0;
+	errno = ENOTSUP;
+	return -1;
+#endif
+}
 
 int socket::close() {
 	int fd = fd_;
@@ -107,6 +263,7 @@ int socket::create(const char *addr, struct addrinfo **presults) {
 		perror("socket error");
 		return -1;
 	}
+	unix_ = false;
 	set_nonblock();
 
 	int enable = 1;
@@ -119,6 +276,34 @@ int socket::create(const char *addr, struct addrinfo **presults) {
 	return 0;
 }
 
+int socket::create_unix(const char *addr, struct sockaddr_un &sun) {
+#ifndef _WIN32
+	assert(!valid());
+
+	const char *path = unix_path(addr);
+	memset(&sun, 0, sizeof(sun));
+	sun.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(sun.sun_path)) {
+		fprintf(stderr, "unix socket path '%s' is too long\n", path);
+		return -1;
+	}
+	strcpy(sun.sun_path, path);
+
+	if ((fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		perror("socket error");
+		return -1;
+	}
+	unix_ = true;
+	set_nonblock();
+	return 0;
+#else
+	(void)addr;
+	(void)sun;
+	fprintf(stderr, "unix sockets are not supported\n");
+	return -1;
+#endif
+}
+
 socket socket::accept() {
 	struct sockaddr client_addr;
 	memset(&client_addr, 0, sizeof(client_addr));
@@ -133,7 +318,8 @@ socket socket::accept() {
 		client.set_nonblock();
 	}
 #endif
-	if (client.valid()) {
+	client.unix_ = unix_;
+	if (client.valid() && !unix_) {
 		client.set_nodelay();
 	}
 	return client;
@@ -153,6 +339,17 @@ int socket::set_nodelay() {
 	return setsockopt(fd_, SOL_TCP, TCP_NODELAY, reinterpret_cast<char *>(&flag), sizeof(flag));
 }
 
+bool socket::is_unix() {
+#ifndef _WIN32
+	if (unix_) return true;
+	struct sockaddr_storage addr;
+	socklen_t len = sizeof(addr);
+	return ::getsockname(fd_, reinterpret_cast<struct sockaddr *>(&addr), &len) == 0 && addr.ss_family == AF_UNIX;
+#else
+	return false;
+#endif
+}
+
 int socket::last_error() {
 #ifndef _WIN32
 	return errno;
@@ -1,36 +1,56 @@
 #pragma once
 
 #include <stdlib.h>
+#include "estl/chain_buf.h"
 
 struct addrinfo;
+struct sockaddr_un;
 namespace reindexer {
 namespace net {
 
+// Maximum number of spans, which are written by one call
+const size_t kMaxSendSpans = 64;
+
+/// Wrapper of socket descriptor. Address is tcp 'host:port', or 'unix:///path' of unix domain socket
 class socket {
 public:
-	socket(const socket &other) : fd_(other.fd_) {}
+	socket(const socket &other) : fd_(other.fd_), unix_(other.unix_) {}
 	socket(int fd = -1) : fd_(fd) {}
 
-	int bind(const char *addr);
+	// reusePort - allow several sockets to be bound to the same addr. Incoming connections are distributed between them by kernel
+	int bind(const char *addr, bool reusePort = false);
 	int connect(const char *addr);
 	socket accept();
 	int listen(int backlog);
 	int recv(char *buf, size_t len);
 	int send(const char *buf, size_t len);
+	// Write several spans by one call
+	int send(const chain_buf::span *spans, size_t cnt);
+	// Pass descriptors with data over unix domain socket
+	int send_fds(const char *buf, size_t len, const int *fds, int cnt);
+	// Receive data and up to cnt descriptors, cnt is set to number of received ones
+	int recv_fds(char *buf, size_t len, int *fds, int &cnt);
 	int close();
 
 	int set_nonblock();
 	int set_nodelay();
 	int fd() { return fd_; }
 	bool valid() { return fd_ >= 0; }
+	// Socket is unix domain socket. Descriptor of accepted connection does not keep flag, so it is asked from system
+	bool is_unix();
 
 	static int last_error();
 	static bool would_block(int error);
+	static bool is_unix_addr(const char *addr);
+	// Path of unix domain socket in addr
+	static const char *unix_path(const char *addr);
 
 protected:
 	int create(const char *addr, struct addrinfo **pres);
+	int create_unix(const char *addr, struct sockaddr_un &sun);
 
 	int fd_;
+	bool unix_ = false;
 };
 }  // namespace net
 }  // namespace reindexer
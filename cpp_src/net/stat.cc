@@ -23,4 +23,9 @@ Stat Stat::operator-(const Stat &other) const {
 	return res;
 }
 
+CompressionStat &CompressionStat::Global() {
+	static CompressionStat stat;
+	return stat;
+}
+
 }  // namespace reindexer
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <atomic>
 #include <chrono>
 
 namespace reindexer {
@@ -24,4 +25,27 @@ private:
 	size_t allocs_cnt_;
 	size_t allocs_bytes_;
 };
+
+// Counters of network compression, summed over all connections
+struct CompressionStat {
+	// Frame was compressed: sizes of frame before and after compression, time of compression
+	void Compressed(size_t rawSize, size_t compressedSize, uint64_t timeUs) {
+		compressedFrames++;
+		rawBytes += rawSize;
+		compressedBytes += compressedSize;
+		compressTimeUs += timeUs;
+	}
+	// Frame was sent uncompressed: it is too small or incompressible
+	void Skipped() { skippedFrames++; }
+	void Decompressed(size_t compressedSize, size_t rawSize, uint64_t timeUs) {
+		decompressedFrames++;
+		decompressedRawBytes += rawSize;
+		decompressedBytes += compressedSize;
+		decompressTimeUs += timeUs;
+	}
+	static CompressionStat &Global();
+
+	std::atomic<uint64_t> compressedFrames{0}, skippedFrames{0}, rawBytes{0}, compressedBytes{0}, compressTimeUs{0};
+	std::atomic<uint64_t> decompressedFrames{0}, decompressedRawBytes{0}, decompressedBytes{0}, decompressTimeUs{0};
+};
 }  // namespace reindexer
@@ -0,0 +1,75 @@
+#include "workerpool.h"
+#include <algorithm>
+
+namespace reindexer {
+namespace net {
+
+WorkerPool::WorkerPool(int workers, size_t queueLimit) : queueLimit_(queueLimit) {
+	if (workers <= 0) workers = std::max(int(std::thread::hardware_concurrency()), 1);
+	threads_.reserve(workers);
+	for (int i = 0; i < workers; i++) threads_.emplace_back(&WorkerPool::run, this);
+}
+
+WorkerPool::~WorkerPool() { Stop(); }
+
+bool WorkerPool::admit(bool force) {
+	if (terminating_ || (!force && queueLimit_ && queued_ >= queueLimit_)) {
+		rejected_++;
+		return false;
+	}
+	return true;
+}
+
+bool WorkerPool::Post(std::function<void()> func, bool force) {
+	std::unique_lock<std::mutex> lck(mtx_);
+	if (!admit(force)) return false;
+	tasks_.push_back({std::move(func), std::chrono::steady_clock::now()});
+	queued_++;
+	lck.unlock();
+	cond_.notify_one();
+	return true;
+}
+
+void WorkerPool::Stop() {
+	std::unique_lock<std::mutex> lck(mtx_);
+	if (terminating_) return;
+	terminating_ = true;
+	queued_ -= tasks_.size();
+	tasks_.clear();
+	lck.unlock();
+	cond_.notify_all();
+	for (auto &th : threads_) th.join();
+}
+
+WorkerPool::Stats WorkerPool::GetStats() {
+	std::lock_guard<std::mutex> lck(mtx_);
+	return {int(threads_.size()), queued_, active_, executed_, rejected_, waitTimeUs_, maxWaitTimeUs_};
+}
+
+void WorkerPool::run() {
+	std::unique_lock<std::mutex> lck(mtx_);
+	for (;;) {
+		cond_.wait(lck, [this] { return terminating_ || !tasks_.empty(); });
+		if (terminating_) return;
+
+		auto task = std::move(tasks_.front());
+		tasks_.pop_front();
+		queued_--;
+		active_++;
+
+		uint64_t waitUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - task.posted).count();
+		waitTimeUs_ += waitUs;
+		maxWaitTimeUs_ = std::max(maxWaitTimeUs_, waitUs);
+
+		lck.unlock();
+		task.func();
+		task.func = nullptr;
+		lck.lock();
+
+		active_--;
+		executed_++;
+	}
+}
+
+}  // namespace net
+}  // namespace reindexer
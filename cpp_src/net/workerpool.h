@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace reindexer {
+namespace net {
+
+/// Pool of threads, which execute tasks posted by connections' event loops. Tasks are executed concurrently in order of posting.
+class WorkerPool {
+protected:
+	struct Task {
+		std::function<void()> func;
+		std::chrono::steady_clock::time_point posted;
+	};
+
+public:
+	struct Stats {
+		int workers;
+		// Tasks waiting for execution
+		size_t queued;
+		// Tasks executing now
+		int active;
+		uint64_t executed;
+		// Tasks rejected by queue limit
+		uint64_t rejected;
+		// Total and maximum time of tasks waiting in queue
+		uint64_t waitTimeUs;
+		uint64_t maxWaitTimeUs;
+	};
+
+	/// Construct pool and start workers.
+	/// @param workers - Number of threads. std::thread::hardware_concurrency() if 0
+	/// @param queueLimit - Maximum number of waiting tasks, 0 - unlimited
+	WorkerPool(int workers, size_t queueLimit);
+	~WorkerPool();
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	/// Post task
+	/// @param func - task
+	/// @param force - post task even if queue limit is reached
+	/// @return false - if task is rejected by queue limit or pool is stopped
+	bool Post(std::function<void()> func, bool force = false);
+	/// Stop workers. Executing tasks are completed, waiting tasks are dropped
+	void Stop();
+	Stats GetStats();
+
+protected:
+	void run();
+	bool admit(bool force);
+
+	std::mutex mtx_;
+	std::condition_variable cond_;
+	std::deque<Task> tasks_;
+	std::vector<std::thread> threads_;
+	size_t queueLimit_;
+	size_t queued_ = 0;
+	int active_ = 0;
+	bool terminating_ = false;
+
+	uint64_t executed_ = 0;
+	uint64_t rejected_ = 0;
+	uint64_t waitTimeUs_ = 0;
+	uint64_t maxWaitTimeUs_ = 0;
+};
+
+}  // namespace net
+}  // namespace reindexer
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <ctype.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "core/reindexer.h"
+#include "net/http/serverconnection.h"
+#include "tools/serializer.h"
+
+namespace reindexer_server {
+
+using std::string;
+using std::shared_ptr;
+using std::to_string;
+using std::vector;
+using reindexer::Error;
+using reindexer::Item;
+using reindexer::Reindexer;
+using reindexer::string_view;
+namespace http = reindexer::net::http;
+
+// Upserts items from streamed body by batches. Body is split to items by matching of braces, so only incomplete item is buffered
+class BulkItemsConsumer : public http::BodyConsumer {
+public:
+	BulkItemsConsumer(shared_ptr<Reindexer> db, const string &nsName, size_t batchSize)
+		: db_(std::move(db)), nsName_(nsName), batchSize_(batchSize) {}
+
+	void Write(const string_view &data) override final {
+		if (!parseErr_.empty()) return;
+		buf_.append(data.data(), data.size());
+
+		// Items are separated by spaces or commas, and can be enclosed into array
+		size_t consumed = 0;
+		for (; pos_ < buf_.size(); pos_++) {
+			char c = buf_[pos_];
+			if (!depth_) {
+				if (c == '{') {
+					itemStart_ = pos_;
+					depth_ = 1;
+				} else if (isspace(static_cast<unsigned char>(c)) || c == ',' || (c == '[' && !items_) || c == ']') {
+					consumed = pos_ + 1;
+				} else {
+					parseErr_ = "Unexpected character '" + string(1, c) + "' after item " + to_string(items_);
+					return;
+				}
+			} else if (inString_) {
+				if (escape_) {
+					escape_ = false;
+				} else if (c == '\\') {
+					escape_ = true;
+				} else if (c == '"') {
+					inString_ = false;
+				}
+			} else if (c == '"') {
+				inString_ = true;
+			} else if (c == '{' || c == '[') {
+				depth_++;
+			} else if ((c == '}' || c == ']') && !--depth_) {
+				upsert(string_view(&buf_[itemStart_], pos_ + 1 - itemStart_));
+				consumed = pos_ + 1;
+			}
+		}
+		buf_.erase(0, consumed);
+		pos_ -= consumed;
+		itemStart_ -= std::min(itemStart_, consumed);
+
+		if (buf_.size() > size_t(http::kHttpMaxBodySize)) {
+			throw http::HttpStatus(http::StatusRequestEntityTooLarge, "Item " + to_string(items_) + " is too large");
+		}
+	}
+
+	int Finish(http::Context &ctx) override final {
+		if (parseErr_.empty() && depth_) parseErr_ = "Unexpected end of body in item " + to_string(items_);
+		commit();
+
+		reindexer::WrSerializer wrSer(true);
+		wrSer.Printf("{\"success\":%s,", (parseErr_.empty() && updated_ == items_) ? "true" : "false");
+		if (!parseErr_.empty()) {
+			wrSer.PutChars("\"description\":");
+			wrSer.PrintJsonString(parseErr_);
+			wrSer.PutChar(',');
+		}
+		wrSer.Printf("\"total_items\":%zu,\"updated\":%zu,\"batches\":[", items_, updated_);
+		for (size_t i = 0; i < batches_.size(); i++) {
+			auto &batch = batches_[i];
+			if (i) wrSer.PutChar(',');
+			wrSer.Printf("{\"first_item\":%zu,\"items\":%zu,\"updated\":%zu,\"failed\":%zu,\"errors\":[", batch.firstItem, batch.items,
+						 batch.updated, batch.items - batch.updated);
+			for (size_t j = 0; j < batch.errors.size(); j++) {
+				if (j) wrSer.PutChar(',');
+				wrSer.Printf("{\"item\":%zu,\"description\":", batch.errors[j].first);
+				wrSer.PrintJsonString(batch.errors[j].second);
+				wrSer.PutChar('}');
+			}
+			wrSer.PutChars("]}");
+		}
+		wrSer.PutChars("]}");
+		return ctx.JSON(parseErr_.empty() ? http::StatusOK : http::StatusBadRequest, wrSer.DetachChunk());
+	}
+
+protected:
+	// Errors of batch, which are reported. The rest errors are counted only
+	static const size_t kMaxBatchErrors = 10;
+
+	struct Batch {
+		size_t firstItem, items, updated;
+		vector<std::pair<size_t, string>> errors;
+	};
+
+	void upsert(const string_view &json) {
+		if (batches_.empty() || batches_.back().items == batchSize_) {
+			commit();
+			batches_.push_back(Batch{items_, 0, 0, {}});
+		}
+		auto &batch = batches_.back();
+		// Item refers to json in buf_, and is destroyed before it is erased
+		Item item = db_->NewItem(nsName_);
+		Error err = item.Status();
+		if (err.ok()) err = item.Unsafe().FromJSON(json);
+		if (err.ok()) err = db_->Upsert(nsName_, item);
+		if (err.ok()) {
+			batch.updated++;
+			updated_++;
+		} else if (batch.errors.size() < kMaxBatchErrors) {
+			batch.errors.push_back({items_, err.what()});
+		}
+		batch.items++;
+		items_++;
+		uncommited_ = true;
+	}
+
+	void commit() {
+		if (!uncommited_) return;
+		uncommited_ = false;
+		Error err = db_->Commit(nsName_);
+		if (!err.ok() && batches_.back().errors.size() < kMaxBatchErrors) {
+			batches_.back().errors.push_back({items_, err.what()});
+		}
+	}
+
+	shared_ptr<Reindexer> db_;
+	string nsName_;
+	size_t batchSize_;
+
+	// Unparsed part of body and parser state
+	string buf_;
+	size_t pos_ = 0, itemStart_ = 0;
+	int depth_ = 0;
+	bool inString_ = false, escape_ = false;
+	string parseErr_;
+
+	vector<Batch> batches_;
+	size_t items_ = 0, updated_ = 0;
+	bool uncommited_ = false;
+};
+
+}  // namespace reindexer_server
@@ -12,6 +12,13 @@ void ServerConfig::Reset() {
 	StorageEngine = "leveldb";
 	HTTPAddr = "0.0.0.0:9088";
 	RPCAddr = "0.0.0.0:6534";
+	RPCUnixAddr.clear();
+	UnixSocketMode.clear();
+	UnixSocketOwner.clear();
+	RPCWorkers = 0;
+	RPCQueueLimit = 0;
+	ReusePort = false;
+	Rebalance = "connections";
 	LogLevel = "info";
 	ServerLog = "stdout";
 	CoreLog = "stdout";
@@ -73,8 +80,23 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 	args::ValueFlag<string> storageF(dbGroup, "PATH", "path to 'reindexer' storage", {'s', "db"}, StoragePath, args::Options::Single);
 
 	args::Group netGroup(parser, "Network options");
-	args::ValueFlag<string> httpAddrF(netGroup, "PORT", "http listen host:port", {'p', "httpaddr"}, HTTPAddr, args::Options::Single);
-	args::ValueFlag<string> rpcAddrF(netGroup, "RPORT", "RPC listen host:port", {'r', "rpcaddr"}, RPCAddr, args::Options::Single);
+	args::ValueFlag<string> httpAddrF(netGroup, "PORT", "http listen host:port or unix:///path", {'p', "httpaddr"}, HTTPAddr,
+									  args::Options::Single);
+	args::ValueFlag<string> rpcAddrF(netGroup, "RPORT", "RPC listen host:port or unix:///path", {'r', "rpcaddr"}, RPCAddr,
+									 args::Options::Single);
+	args::ValueFlag<string> rpcUnixAddrF(netGroup, "PATH", "RPC listen path of unix domain socket", {"urpcaddr"}, RPCUnixAddr,
+										 args::Options::Single);
+	args::ValueFlag<string> unixSockModeF(netGroup, "MODE", "Octal mode of unix domain sockets files", {"unixsockmode"}, UnixSocketMode,
+										  args::Options::Single);
+	args::ValueFlag<string> unixSockOwnerF(netGroup, "USER[:GROUP]", "Owner of unix domain sockets files (only run-as user and its groups)",
+										   {"unixsockowner"}, UnixSocketOwner, args::Options::Single);
+	args::ValueFlag<int> rpcWorkersF(netGroup, "N", "RPC worker threads (0 - number of CPU cores, -1 - execute calls in network threads)",
+									 {"rpcworkers"}, RPCWorkers, args::Options::Single);
+	args::ValueFlag<int> rpcQueueLimitF(netGroup, "N", "Max RPC calls waiting for execution (0 - unlimited)", {"rpcqueuelimit"},
+										RPCQueueLimit, args::Options::Single);
+	args::Flag reusePortF(netGroup, "", "Accept connections on SO_REUSEPORT socket per network thread", {"reuseport"});
+	args::ValueFlag<string> rebalanceF(netGroup, "MODE", "Move connections between network threads (none, connections, load)",
+									   {"rebalance"}, Rebalance, args::Options::Single);
 	args::ValueFlag<string> webRootF(netGroup, "PATH", "web root", {'w', "webroot"}, WebRoot, args::Options::Single);
 
 	args::Group logGroup(parser, "Logging options");
@@ -114,6 +136,13 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 	if (logLevelF) LogLevel = args::get(logLevelF);
 	if (httpAddrF) HTTPAddr = args::get(httpAddrF);
 	if (rpcAddrF) RPCAddr = args::get(rpcAddrF);
+	if (rpcUnixAddrF) RPCUnixAddr = args::get(rpcUnixAddrF);
+	if (unixSockModeF) UnixSocketMode = args::get(unixSockModeF);
+	if (unixSockOwnerF) UnixSocketOwner = args::get(unixSockOwnerF);
+	if (rpcWorkersF) RPCWorkers = args::get(rpcWorkersF);
+	if (rpcQueueLimitF) RPCQueueLimit = args::get(rpcQueueLimitF);
+	if (reusePortF) ReusePort = args::get(reusePortF);
+	if (rebalanceF) Rebalance = args::get(rebalanceF);
 	if (webRootF) WebRoot = args::get(webRootF);
 #ifndef _WIN32
 	if (userF) UserName = args::get(userF);
@@ -143,6 +172,13 @@ reindexer::Error ServerConfig::fromYaml(Yaml::Node &root) {
 		RpcLog = root["logger"]["rpclog"].As<std::string>(RpcLog);
 		HTTPAddr = root["net"]["httpaddr"].As<std::string>(HTTPAddr);
 		RPCAddr = root["net"]["rpcaddr"].As<std::string>(RPCAddr);
+		RPCUnixAddr = root["net"]["urpcaddr"].As<std::string>(RPCUnixAddr);
+		UnixSocketMode = root["net"]["unixsockmode"].As<std::string>(UnixSocketMode);
+		UnixSocketOwner = root["net"]["unixsockowner"].As<std::string>(UnixSocketOwner);
+		RPCWorkers = root["net"]["rpcworkers"].As<int>(RPCWorkers);
+		RPCQueueLimit = root["net"]["rpcqueuelimit"].As<int>(RPCQueueLimit);
+		ReusePort = root["net"]["reuseport"].As<bool>(ReusePort);
+		Rebalance = root["net"]["rebalance"].As<std::string>(Rebalance);
 		WebRoot = root["net"]["webroot"].As<std::string>(WebRoot);
 		EnableSecurity = root["net"]["security"].As<bool>(EnableSecurity);
 #ifndef _WIN32
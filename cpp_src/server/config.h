@@ -26,6 +26,19 @@ struct ServerConfig {
 	string StorageEngine;
 	string HTTPAddr;
 	string RPCAddr;
+	// Path of unix domain socket, which is served by RPC in addition to RPCAddr. Empty - disabled
+	string RPCUnixAddr;
+	// Octal mode and owner ('user' or 'user:group') of unix domain sockets files. Empty - not changed
+	string UnixSocketMode;
+	string UnixSocketOwner;
+	// Number of threads, which execute RPC calls: 0 - number of CPU cores, negative - calls are executed by network threads
+	int RPCWorkers;
+	// Maximum number of RPC calls waiting for execution, 0 - unlimited
+	int RPCQueueLimit;
+	// Each network thread accepts connections on its own SO_REUSEPORT socket
+	bool ReusePort;
+	// Policy of moving connections between network threads: none, connections, load
+	string Rebalance;
 	string LogLevel;
 	string ServerLog;
 	string CoreLog;
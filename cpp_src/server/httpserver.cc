@@ -2,13 +2,18 @@
 #include <sys/stat.h>
 #include <sstream>
 #include "base64/base64.h"
+#include "bulkitemsconsumer.h"
+#include "core/cbinding/resultserializer.h"
+#include "core/cjson/msgpackencoder.h"
 #include "core/type_consts.h"
 #include "gason/gason.h"
 #include "loggerwrapper.h"
 #include "net/http/serverconnection.h"
 #include "net/listener.h"
+#include "net/stat.h"
 #include "reindexer_version.h"
 #include "resources_wrapper.h"
+#include "rpcserver.h"
 #include "tools/fsops.h"
 #include "tools/serializer.h"
 #include "tools/stringstools.h"
@@ -529,6 +534,18 @@ int HTTPServer::DeleteIndex(http::Context &ctx) {
 	return jsonStatus(ctx);
 }
 
+static void loopStats(WrSerializer &ser, const vector<Listener::LoopStats> &stats) {
+	ser.PutChar('[');
+	for (auto &st : stats) {
+		if (&st != &stats.front()) ser.PutChar(',');
+		ser.Printf("{\"id\":%d,\"connections\":%d,\"accepted\":%ld,\"moved_in\":%ld,\"moved_out\":%ld,", st.id, st.connections,
+				   long(st.accepted), long(st.movedIn), long(st.movedOut));
+		ser.Printf("\"load\":%.3f,\"callbacks\":%ld,\"avg_latency_us\":%ld,\"max_latency_us\":%ld}", st.load.load, long(st.load.callbacks),
+				   long(st.load.avg_latency_us), long(st.load.max_latency_us));
+	}
+	ser.PutChar(']');
+}
+
 int HTTPServer::Check(http::Context &ctx) {
 	WrSerializer ser;
 	ser.Printf("{");
@@ -540,6 +557,21 @@ int HTTPServer::Check(http::Context &ctx) {
 	ser.Printf("\"start_time\": %ld,", startTs);
 	ser.Printf("\"uptime\": %ld", uptime);
 
+	if (rpcServer_) {
+		ser.Printf(",\"rpc_workers\":");
+		rpcServer_->GetStats(ser);
+		ser.Printf(",\"rpc_loops\":");
+		loopStats(ser, rpcServer_->GetLoopStats());
+	}
+	ser.Printf(",\"http_loops\":");
+	loopStats(ser, listener_->GetStats());
+
+	auto &cstat = CompressionStat::Global();
+	ser.Printf(",\"compression\":{\"compressed_frames\":%ld,\"skipped_frames\":%ld,\"raw_bytes\":%ld,\"compressed_bytes\":%ld,",
+			   long(cstat.compressedFrames), long(cstat.skippedFrames), long(cstat.rawBytes), long(cstat.compressedBytes));
+	ser.Printf("\"compress_time_us\":%ld,\"decompressed_frames\":%ld,\"decompressed_bytes\":%ld,\"decompress_time_us\":%ld}",
+			   long(cstat.compressTimeUs), long(cstat.decompressedFrames), long(cstat.decompressedRawBytes), long(cstat.decompressTimeUs));
+
 #ifdef REINDEX_WITH_GPERFTOOLS
 	size_t val = 0;
 	MallocExtension_GetNumericProperty("generic.current_allocated_bytes", &val);
@@ -619,7 +651,7 @@ int HTTPServer::NotFoundHandler(http::Context &ctx) {
 	return jsonStatus(ctx, httpStatus);
 }
 
-bool HTTPServer::Start(const string &addr, ev::dynamic_loop &loop) {
+bool HTTPServer::Start(const string &addr, ev::dynamic_loop &loop, const ListenerOpts &listenerOpts) {
 	router_.NotFound<HTTPServer, &HTTPServer::NotFoundHandler>(this);
 
 	router_.GET<HTTPServer, &HTTPServer::DocHandler>("/swagger", this);
@@ -648,6 +680,7 @@ bool HTTPServer::Start(const string &addr, ev::dynamic_loop &loop) {
 	router_.PUT<HTTPServer, &HTTPServer::PutItems>("/api/v1/db/:db/namespaces/:ns/items", this);
 	router_.POST<HTTPServer, &HTTPServer::PostItems>("/api/v1/db/:db/namespaces/:ns/items", this);
 	router_.DELETE<HTTPServer, &HTTPServer::DeleteItems>("/api/v1/db/:db/namespaces/:ns/items", this);
+	router_.POST<HTTPServer, &HTTPServer::PostItemsBulk>("/api/v1/db/:db/namespaces/:ns/items/bulk", this, true);
 
 	router_.GET<HTTPServer, &HTTPServer::GetIndexes>("/api/v1/db/:db/namespaces/:ns/indexes", this);
 	router_.POST<HTTPServer, &HTTPServer::PostIndex>("/api/v1/db/:db/namespaces/:ns/indexes", this);
@@ -663,7 +696,7 @@ bool HTTPServer::Start(const string &addr, ev::dynamic_loop &loop) {
 	if (enablePprof_) {
 		pprof_.Attach(router_);
 	}
-	listener_.reset(new Listener(loop, http::ServerConnection::NewFactory(router_)));
+	listener_.reset(new Listener(loop, http::ServerConnection::NewFactory(router_), listenerOpts));
 
 	return listener_->Bind(addr);
 }
@@ -727,39 +760,126 @@ int HTTPServer::modifyItem(http::Context &ctx, int mode) {
 	return jsonStatus(ctx);
 }
 
+int HTTPServer::PostItemsBulk(http::Context &ctx) {
+	shared_ptr<Reindexer> db = getDB(ctx, kRoleDataWrite);
+	string nsName = urldecode2(ctx.request->urlParams[1]);
+
+	if (nsName.empty()) {
+		http::HttpStatus httpStatus(http::StatusBadRequest, "Namespace is not specified");
+
+		return jsonStatus(ctx, httpStatus);
+	}
+
+	Item item = db->NewItem(nsName);
+	if (!item.Status().ok()) {
+		http::HttpStatus httpStatus(item.Status());
+
+		return jsonStatus(ctx, httpStatus);
+	}
+
+	int batchSize = atoi(ctx.request->params.Get("batch_size").ToString().c_str());
+	ctx.bodyConsumer.reset(new BulkItemsConsumer(db, nsName, batchSize > 0 ? batchSize : kDefaultBulkBatchSize));
+	return 0;
+}
+
+enum ResultsFormat { FormatJSON, FormatMsgPack, FormatCJSON };
+
+// Check if Accept header lists media type
+static bool acceptsType(string_view accept, const string_view &type) {
+	while (accept.size()) {
+		size_t pos = accept.find(',');
+		string_view item = accept.substr(0, pos);
+		accept = (pos == string_view::npos) ? string_view() : accept.substr(pos + 1);
+
+		item = item.substr(0, item.find(';'));
+		while (item.size() && item[0] == ' ') item = item.substr(1);
+		while (item.size() && item[item.size() - 1] == ' ') item = item.substr(0, item.size() - 1);
+		if (iequals(item, type)) return true;
+	}
+	return false;
+}
+
+// Format of results is selected by `format` parameter, or by Accept header
+static ResultsFormat resultsFormat(http::Context &ctx) {
+	string_view format = ctx.request->params.Get("format"_sv);
+	if (format == "msgpack"_sv) return FormatMsgPack;
+	if (format == "cjson"_sv) return FormatCJSON;
+	if (format.size()) return FormatJSON;
+
+	string_view accept = ctx.request->headers.Get("Accept"_sv);
+	if (acceptsType(accept, "application/x-msgpack"_sv) || acceptsType(accept, "application/msgpack"_sv)) return FormatMsgPack;
+	if (acceptsType(accept, "application/x-reindexer-cjson"_sv)) return FormatCJSON;
+	return FormatJSON;
+}
+
 int HTTPServer::queryResults(http::Context &ctx, reindexer::QueryResults &res, bool isQueryResults, unsigned limit, unsigned offset) {
-	ctx.writer->SetHeader(http::Header{"Content-Type"_sv, "application/json; charset=utf-8"_sv});
-	ctx.writer->SetRespCode(http::StatusOK);
+	unsigned totalItems = isQueryResults ? res.Count() : static_cast<unsigned>(res.totalCount);
+	switch (resultsFormat(ctx)) {
+		case FormatMsgPack:
+			return queryResultsMsgPack(ctx, res, totalItems, limit, offset);
+		case FormatCJSON:
+			return queryResultsCJSON(ctx, res, limit, offset);
+		default:
+			break;
+	}
+
+	// Responce is built in one buffer, so it can be compressed as a whole
 	reindexer::WrSerializer wrSer(true);
-	ctx.writer->Write('{');
+	wrSer.PutChar('{');
 
 	if (!res.aggregationResults.empty()) {
-		ctx.writer->Write("\"aggregations\": ["_sv);
+		wrSer.PutChars("\"aggregations\": [");
 		for (unsigned i = 0; i < res.aggregationResults.size(); i++) {
-			if (i) ctx.writer->Write(',');
-			string agg = to_string(res.aggregationResults[i]);
-			ctx.writer->Write(agg.c_str(), agg.length());
+			if (i) wrSer.PutChar(',');
+			res.aggregationResults[i].GetJSON(wrSer);
 		}
-		ctx.writer->Write("],"_sv);
+		wrSer.PutChars("],");
 	}
 
-	ctx.writer->Write("\"items\": ["_sv);
+	wrSer.PutChars("\"items\": [");
 	for (size_t i = offset; i < res.Count() && i < offset + limit; i++) {
-		wrSer.Reset();
-		if (i != offset) ctx.writer->Write(',');
+		if (i != offset) wrSer.PutChar(',');
 		res[i].GetJSON(wrSer, false);
-		ctx.writer->Write(wrSer.Buf(), wrSer.Len());
 	}
-	ctx.writer->Write("],"_sv);
+	wrSer.PutChars("],");
 
-	unsigned totalItems = isQueryResults ? res.Count() : static_cast<unsigned>(res.totalCount);
-	ctx.writer->Write("\"total_items\":"_sv);
-	string total = to_string(totalItems);
-	ctx.writer->Write(total.c_str(), total.length());
+	wrSer.Printf("\"total_items\":%u}", totalItems);
 
-	ctx.writer->Write('}');
+	// Buffer of serializer is moved to connection's output without copying
+	return ctx.JSON(http::StatusOK, wrSer.DetachChunk());
+}
 
-	return 0;
+// Map with the same fields, as JSON responce. Items are encoded directly from payloads
+int HTTPServer::queryResultsMsgPack(http::Context &ctx, reindexer::QueryResults &res, unsigned totalItems, unsigned limit,
+									unsigned offset) {
+	reindexer::WrSerializer wrSer(true);
+	namespace msgpack = reindexer::msgpack;
+
+	msgpack::putMap(wrSer, res.aggregationResults.empty() ? 2 : 3);
+	if (!res.aggregationResults.empty()) {
+		msgpack::putString(wrSer, "aggregations"_sv);
+		msgpack::putArray(wrSer, res.aggregationResults.size());
+		for (auto &agg : res.aggregationResults) agg.GetMsgPack(wrSer);
+	}
+
+	size_t count = offset < res.Count() ? std::min(size_t(limit), res.Count() - offset) : 0;
+	msgpack::putString(wrSer, "items"_sv);
+	msgpack::putArray(wrSer, count);
+	for (size_t i = offset; i < offset + count; i++) res[i].GetMsgPack(wrSer);
+
+	msgpack::putString(wrSer, "total_items"_sv);
+	msgpack::putInt(wrSer, totalItems);
+
+	return ctx.Data(http::StatusOK, "application/x-msgpack", wrSer.DetachChunk());
+}
+
+// Results in the same format, as responce of cproto Select: items in CJSON with dictionaries of tags and payload types
+int HTTPServer::queryResultsCJSON(http::Context &ctx, reindexer::QueryResults &res, unsigned limit, unsigned offset) {
+	reindexer::ResultFetchOpts opts{kResultsWithCJson | kResultsWithPayloadTypes, nullptr, 0, offset, limit, -1};
+	reindexer::WrResultSerializer wrSer(true, opts);
+	wrSer.PutResults(&res);
+
+	return ctx.Data(http::StatusOK, "application/x-reindexer-cjson", wrSer.DetachChunk());
 }
 
 int HTTPServer::jsonStatus(http::Context &ctx, http::HttpStatus status) {
@@ -14,6 +14,8 @@ namespace reindexer_server {
 using std::string;
 using namespace reindexer::net;
 
+class RPCServer;
+
 struct HTTPClientData : public http::ClientData {
 	AuthContext auth;
 };
@@ -23,8 +25,10 @@ public:
 	HTTPServer(DBManager &dbMgr, const string &webRoot, LoggerWrapper logger, bool allocDebug = false, bool enablePprof = false);
 	~HTTPServer();
 
-	bool Start(const string &addr, ev::dynamic_loop &loop);
+	bool Start(const string &addr, ev::dynamic_loop &loop, const ListenerOpts &listenerOpts = ListenerOpts());
 	void Stop() { listener_->Stop(); }
+	/// Set RPC server, which statistics are reported by check handler
+	void SetRPCServer(RPCServer *rpcServer) { rpcServer_ = rpcServer; }
 
 	int NotFoundHandler(http::Context &ctx);
 	int DocHandler(http::Context &ctx);
@@ -43,6 +47,7 @@ public:
 	int PostItems(http::Context &ctx);
 	int PutItems(http::Context &ctx);
 	int DeleteItems(http::Context &ctx);
+	int PostItemsBulk(http::Context &ctx);
 	int GetIndexes(http::Context &ctx);
 	int PostIndex(http::Context &ctx);
 	int PutIndex(http::Context &ctx);
@@ -54,6 +59,8 @@ protected:
 	int modifyItem(http::Context &ctx, int mode);
 	int queryResults(http::Context &ctx, reindexer::QueryResults &res, bool isQueryResults = false, unsigned limit = kDefaultLimit,
 					 unsigned offset = kDefaultOffset);
+	int queryResultsMsgPack(http::Context &ctx, reindexer::QueryResults &res, unsigned totalItems, unsigned limit, unsigned offset);
+	int queryResultsCJSON(http::Context &ctx, reindexer::QueryResults &res, unsigned limit, unsigned offset);
 	int jsonStatus(http::Context &ctx, http::HttpStatus status = http::HttpStatus());
 	unsigned prepareLimit(const string_view &limitParam, int limitDefault = kDefaultLimit);
 	unsigned prepareOffset(const string_view &offsetParam, int offsetDefault = kDefaultOffset);
@@ -73,10 +80,12 @@ protected:
 	bool allocDebug_;
 	bool enablePprof_;
 	std::chrono::system_clock::time_point startTs_;
+	RPCServer *rpcServer_ = nullptr;
 
 	static const int kDefaultLimit = INT_MAX;
 	static const int kDefaultOffset = 0;
 	static const int kDefaultItemsLimit = 10;
+	static const int kDefaultBulkBatchSize = 1000;
 };
 
 }  // namespace reindexer_server
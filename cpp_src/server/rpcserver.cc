@@ -1,6 +1,8 @@
 #include "rpcserver.h"
+#include <assert.h>
 #include <sys/stat.h>
 #include <sstream>
+#include "core/cjson/tagsmatcher.h"
 #include "net/cproto/cproto.h"
 #include "net/cproto/serverconnection.h"
 #include "net/listener.h"
@@ -39,7 +41,13 @@ Error RPCServer::Login(cproto::Context &ctx, p_string login, p_string password,
 	ctx.SetClientData(clientData);
 	int64_t startTs = std::chrono::duration_cast<std::chrono::seconds>(startTs_.time_since_epoch()).count();
 
-	ctx.Return({cproto::Arg(p_string(REINDEX_VERSION)), cproto::Arg(startTs)});
+	// Optional 4th arg is set of compression algorithms, supported by client. Server answers by accepted ones
+	int compression = 0;
+	if (ctx.call->args.size() > 3 && ctx.call->args[3].Type() == KeyValueInt) {
+		compression = int(ctx.call->args[3]) & cproto::kCprotoCompressionLZ4;
+	}
+	ctx.Return({cproto::Arg(p_string(REINDEX_VERSION)), cproto::Arg(startTs), cproto::Arg(compression)});
+	if (compression) ctx.EnableCompression();
 
 	return db.length() ? OpenDatabase(ctx, db) : 0;
 }
@@ -247,7 +255,8 @@ Error RPCServer::ModifyItem(cproto::Context &ctx, p_string itemPack, int mode) {
 		opts = ResultFetchOpts{0, nullptr, 0, 0, INT_MAX, 0};
 	}
 
-	return sendResults(ctx, qres, -1, opts);
+	int id = -1;
+	return sendResults(ctx, qres, id, opts);
 }
 
 Error RPCServer::DeleteQuery(cproto::Context &ctx, p_string queryBin) {
@@ -261,7 +270,8 @@ Error RPCServer::DeleteQuery(cproto::Context &ctx, p_string queryBin) {
 		return err;
 	}
 	ResultFetchOpts opts{0, nullptr, 0, 0, INT_MAX, 0};
-	return sendResults(ctx, qres, -1, opts);
+	int id = -1;
+	return sendResults(ctx, qres, id, opts);
 }
 
 shared_ptr<Reindexer> RPCServer::getDB(cproto::Context &ctx, UserRole role) {
@@ -277,49 +287,62 @@ shared_ptr<Reindexer> RPCServer::getDB(cproto::Context &ctx, UserRole role) {
 	throw Error(errParams, "Database is not openeded, you should open it first");
 }
 
-Error RPCServer::sendResults(cproto::Context &ctx, QueryResults &qres, int reqId, const ResultFetchOpts &opts) {
+Error RPCServer::sendResults(cproto::Context &ctx, QueryResults &qres, int &reqId, const ResultFetchOpts &opts) {
 	WrResultSerializer rser(true, opts);
 
 	bool doClose = rser.PutResults(&qres);
 
-	if (doClose && reqId >= 0) {
-		freeQueryResults(ctx, reqId);
-		reqId = -1;
-	}
+	if (doClose && reqId >= 0) freeQueryResults(ctx, reqId);
 
 	string_view resSlice = rser.Slice();
 	ctx.Return({cproto::Arg(p_string(&resSlice)), cproto::Arg(int(reqId))});
 	return 0;
 }
 
-QueryResults &RPCServer::getQueryResults(cproto::Context &ctx, int &id) {
+RPCQueryResults &RPCServer::getQueryResults(cproto::Context &ctx, int &id) {
 	auto data = dynamic_cast<RPCClientData *>(ctx.GetClientData().get());
+	std::lock_guard<std::mutex> lck(data->resultsMtx);
 
 	if (id < 0) {
 		for (id = 0; id < int(data->results.size()); id++) {
-			if (!data->results[id].second) {
-				data->results[id] = {QueryResults(), true};
-				return data->results[id].first;
+			if (!data->results[id].used) {
+				data->results[id] = RPCQueryResults();
+				data->results[id].used = true;
+				data->results[id].busy = true;
+				return data->results[id];
 			}
 		}
 
 		if (data->results.size() > cproto::kMaxConcurentQueries) throw Error(errLogic, "Too many paralell queries");
 		id = data->results.size();
-		data->results.push_back({QueryResults(), true});
+		data->results.emplace_back();
+		data->results.back().used = true;
+		data->results.back().busy = true;
+		return data->results.back();
 	}
 
-	if (id >= int(data->results.size())) {
+	if (id >= int(data->results.size()) || !data->results[id].used) {
 		throw Error(errLogic, "Invalid query id");
 	}
-	return data->results[id].first;
+	RPCQueryResults &res = data->results[id];
+	if (res.busy) throw Error(errLogic, "Query results %d are used by other call", id);
+	res.busy = true;
+	return res;
 }
 
-void RPCServer::freeQueryResults(cproto::Context &ctx, int id) {
+void RPCServer::freeQueryResults(cproto::Context &ctx, int &id) {
 	auto data = dynamic_cast<RPCClientData *>(ctx.GetClientData().get());
-	if (id >= int(data->results.size()) || id < 0) {
-		throw Error(errLogic, "Invalid query id");
-	}
-	data->results[id] = {QueryResults(), false};
+	std::lock_guard<std::mutex> lck(data->resultsMtx);
+	assert(id >= 0 && id < int(data->results.size()) && data->results[id].busy);
+	data->results[id] = RPCQueryResults();
+	id = -1;
+}
+
+void RPCServer::releaseQueryResults(cproto::Context &ctx, int id) {
+	if (id < 0) return;
+	auto data = dynamic_cast<RPCClientData *>(ctx.GetClientData().get());
+	std::lock_guard<std::mutex> lck(data->resultsMtx);
+	data->results[id].busy = false;
 }
 
 static h_vector<int32_t, 4> pack2vec(p_string pack) {
@@ -336,51 +359,105 @@ Error RPCServer::Select(cproto::Context &ctx, p_string queryBin, int flags, int
 	Serializer ser(queryBin.data(), queryBin.size());
 	query.Deserialize(ser);
 
-	int id = -1;
-	QueryResults &qres = getQueryResults(ctx, id);
+	return selectQuery(ctx, query, flags, limit, fetchDataMask, ptVersionsPck);
+}
 
-	auto ret = getDB(ctx, kRoleDataRead)->Select(query, qres);
-	if (!ret.ok()) {
-		freeQueryResults(ctx, id);
-		return ret;
+Error RPCServer::SelectSQL(cproto::Context &ctx, p_string querySql, int flags, int limit, int64_t fetchDataMask, p_string ptVersionsPck) {
+	Query query;
+	try {
+		query.Parse(querySql.toString());
+	} catch (const Error &err) {
+		return err;
 	}
-	auto ptVersions = pack2vec(ptVersionsPck);
-	ResultFetchOpts opts{flags, ptVersions.data(), int(ptVersions.size()), 0, unsigned(limit), fetchDataMask};
 
-	return fetchResults(ctx, id, opts);
+	return selectQuery(ctx, query, flags, limit, fetchDataMask, ptVersionsPck);
 }
 
-Error RPCServer::SelectSQL(cproto::Context &ctx, p_string querySql, int flags, int limit, int64_t fetchDataMask, p_string ptVersionsPck) {
+Error RPCServer::selectQuery(cproto::Context &ctx, const Query &query, int flags, int limit, int64_t fetchDataMask,
+							 p_string ptVersionsPck) {
+	auto db = getDB(ctx, kRoleDataRead);
 	int id = -1;
-	QueryResults &qres = getQueryResults(ctx, id);
-	auto ret = getDB(ctx, kRoleDataRead)->Select(querySql.toString(), qres);
+	RPCQueryResults &res = getQueryResults(ctx, id);
+	QueryResultsGuard guard(*this, ctx, id);
+	auto ptVersions = pack2vec(ptVersionsPck);
+
+	Error ret;
+	if (flags & kResultsStream) {
+		// Server keeps only batch of results, which is fetched by client now
+		res.query = query;
+		ret = db->SelectBatch(res.query, res.qr, res.cursor, unsigned(limit));
+		res.streamed = res.cursor.Streamed();
+		res.ptVersions = ptVersions;
+	} else {
+		ret = db->Select(query, res.qr);
+	}
 	if (!ret.ok()) {
 		freeQueryResults(ctx, id);
 		return ret;
 	}
-	auto ptVersions = pack2vec(ptVersionsPck);
 	ResultFetchOpts opts{flags, ptVersions.data(), int(ptVersions.size()), 0, unsigned(limit), fetchDataMask};
 
-	return fetchResults(ctx, id, opts);
+	return fetchResults(ctx, id, res, opts);
 }
 
 Error RPCServer::FetchResults(cproto::Context &ctx, int reqId, int flags, int offset, int limit, int64_t fetchDataMask) {
 	flags &= ~kResultsWithPayloadTypes;
 
 	ResultFetchOpts opts = {flags, nullptr, 0, unsigned(offset), unsigned(limit), fetchDataMask};
-	return fetchResults(ctx, reqId, opts);
+	if (reqId < 0) return Error(errLogic, "Invalid query id");
+	RPCQueryResults &res = getQueryResults(ctx, reqId);
+	QueryResultsGuard guard(*this, ctx, reqId);
+	return fetchResults(ctx, reqId, res, opts);
 }
 
 Error RPCServer::CloseResults(cproto::Context &ctx, int reqId) {
+	if (reqId < 0) return Error(errLogic, "Invalid query id");
+	getQueryResults(ctx, reqId);
 	freeQueryResults(ctx, reqId);
 	return errOK;
 }
 
-Error RPCServer::fetchResults(cproto::Context &ctx, int reqId, const ResultFetchOpts &opts) {
-	cproto::Args ret;
-	QueryResults &qres = getQueryResults(ctx, reqId);
+Error RPCServer::fetchResults(cproto::Context &ctx, int &reqId, RPCQueryResults &res, const ResultFetchOpts &opts) {
+	if (res.streamed) return fetchBatch(ctx, reqId, res, opts);
+
+	return sendResults(ctx, res.qr, reqId, opts);
+}
+
+Error RPCServer::fetchBatch(cproto::Context &ctx, int &reqId, RPCQueryResults &res, ResultFetchOpts opts) {
+	// Next batch is selected, when client has fetched current one completely
+	unsigned batchEnd = res.batchOffset + res.qr.Count();
+	if (opts.fetchOffset == batchEnd && !res.cursor.Done()) {
+		res.batchOffset = batchEnd;
+		res.qr = QueryResults();
+		auto err = getDB(ctx, kRoleDataRead)->SelectBatch(res.query, res.qr, res.cursor, opts.fetchLimit);
+		if (!err.ok()) {
+			freeQueryResults(ctx, reqId);
+			return err;
+		}
+	} else if (opts.fetchOffset < res.batchOffset || opts.fetchOffset > batchEnd) {
+		return Error(errParams, "Streamed results can be fetched only sequentially");
+	}
+
+	// Payload types are sent, if they were changed after previous batch
+	if (int(res.ptVersions.size()) == res.qr.getMergedNSCount()) {
+		opts.flags |= kResultsWithPayloadTypes;
+		opts.ptVersions = res.ptVersions.data();
+		opts.ptVersionsCount = res.ptVersions.size();
+	}
+	opts.fetchOffset -= res.batchOffset;
+
+	WrResultSerializer rser(true, opts);
+	bool doClose = rser.PutResults(&res.qr) && res.cursor.Done();
+	for (int i = 0; i < std::min(int(res.ptVersions.size()), res.qr.getMergedNSCount()); i++) {
+		const TagsMatcher &tm = res.qr.getTagsMatcher(i);
+		res.ptVersions[i] = tm.version() ^ tm.cacheToken();
+	}
+
+	if (doClose) freeQueryResults(ctx, reqId);
 
-	return sendResults(ctx, qres, reqId, opts);
+	string_view resSlice = rser.Slice();
+	ctx.Return({cproto::Arg(p_string(&resSlice)), cproto::Arg(int(reqId))});
+	return 0;
 }
 
 Error RPCServer::Commit(cproto::Context &ctx, p_string ns) {
@@ -411,7 +488,7 @@ Error RPCServer::EnumMeta(cproto::Context &ctx, p_string ns) {
 	return getDB(ctx, kRoleDataWrite)->EnumMeta(ns.toString(), keys);
 }
 
-bool RPCServer::Start(const string &addr, ev::dynamic_loop &loop) {
+bool RPCServer::Start(const string &addr, ev::dynamic_loop &loop, int workers, size_t queueLimit, const ListenerOpts &listenerOpts) {
 	dispatcher.Register(cproto::kCmdPing, this, &RPCServer::Ping);
 	dispatcher.Register(cproto::kCmdLogin, this, &RPCServer::Login);
 	dispatcher.Register(cproto::kCmdOpenDatabase, this, &RPCServer::OpenDatabase);
@@ -445,8 +522,30 @@ bool RPCServer::Start(const string &addr, ev::dynamic_loop &loop) {
 		dispatcher.Logger(this, &RPCServer::Logger);
 	}
 
-	listener_.reset(new Listener(loop, cproto::ServerConnection::NewFactory(dispatcher)));
+	if (workers >= 0) pool_.reset(new WorkerPool(workers, queueLimit));
+	listener_.reset(new Listener(loop, cproto::ServerConnection::NewFactory(dispatcher, pool_.get()), listenerOpts));
 	return listener_->Bind(addr);
 }
 
+void RPCServer::Stop() {
+	// Executing calls are completed before listeners destroy their connections
+	if (pool_) pool_->Stop();
+	listener_->Stop();
+}
+
+void RPCServer::GetStats(WrSerializer &ser) {
+	if (!pool_) {
+		ser.Printf("{\"workers\":0}");
+		return;
+	}
+	auto stats = pool_->GetStats();
+	ser.Printf("{\"workers\":%d,", stats.workers);
+	ser.Printf("\"queued\":%d,", int(stats.queued));
+	ser.Printf("\"active\":%d,", stats.active);
+	ser.Printf("\"executed\":%ld,", long(stats.executed));
+	ser.Printf("\"rejected\":%ld,", long(stats.rejected));
+	ser.Printf("\"avg_wait_us\":%ld,", long(stats.executed ? stats.waitTimeUs / stats.executed : 0));
+	ser.Printf("\"max_wait_us\":%ld}", long(stats.maxWaitTimeUs));
+}
+
 }  // namespace reindexer_server
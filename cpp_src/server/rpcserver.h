@@ -1,6 +1,8 @@
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <mutex>
 #include "core/cbinding/resultserializer.h"
 #include "core/keyvalue/keyref.h"
 #include "core/reindexer.h"
@@ -8,6 +10,7 @@
 #include "loggerwrapper.h"
 #include "net/cproto/dispatcher.h"
 #include "net/listener.h"
+#include "net/workerpool.h"
 
 namespace reindexer_server {
 
@@ -16,8 +19,26 @@ using std::pair;
 using namespace reindexer::net;
 using namespace reindexer;
 
+struct RPCQueryResults {
+	QueryResults qr;
+	bool used = false;
+	// Results are used by call. Other calls of them are rejected, because calls of connection are executed concurrently
+	bool busy = false;
+	// Results are selected by batches, and qr holds current batch only
+	bool streamed = false;
+	Query query;
+	SelectCursor cursor;
+	// Offset of current batch in results of query
+	unsigned batchOffset = 0;
+	// Versions of payload types, which were sent to client
+	h_vector<int32_t, 4> ptVersions;
+};
+
 struct RPCClientData : public cproto::ClientData {
-	h_vector<pair<QueryResults, bool>, 1> results;
+	// Calls of connection are executed concurrently. Results are kept in deque, so references to them are valid, while other calls add
+	// new results
+	std::deque<RPCQueryResults> results;
+	std::mutex resultsMtx;
 	AuthContext auth;
 	int connID;
 };
@@ -27,8 +48,16 @@ public:
 	RPCServer(DBManager &dbMgr, LoggerWrapper logger, bool allocDebug = false);
 	~RPCServer();
 
-	bool Start(const string &addr, ev::dynamic_loop &loop);
-	void Stop() { listener_->Stop(); }
+	/// Start listening
+	/// @param workers - Number of threads, which execute calls. 0 - number of CPU cores, negative - calls are executed by listener threads
+	/// @param queueLimit - Maximum number of calls waiting for execution, 0 - unlimited
+	bool Start(const string &addr, ev::dynamic_loop &loop, int workers = 0, size_t queueLimit = 0,
+			   const ListenerOpts &listenerOpts = ListenerOpts());
+	void Stop();
+	/// Write statistics of calls execution in JSON object
+	void GetStats(WrSerializer &ser);
+	/// Statistics of network threads
+	vector<Listener::LoopStats> GetLoopStats() { return listener_->GetStats(); }
 
 	Error Ping(cproto::Context &ctx);
 	Error Login(cproto::Context &ctx, p_string login, p_string password, p_string db);
@@ -64,16 +93,35 @@ public:
 	void OnClose(cproto::Context &ctx, const Error &err);
 
 protected:
-	Error sendResults(cproto::Context &ctx, QueryResults &qr, int reqId, const ResultFetchOpts &opts);
-	Error fetchResults(cproto::Context &ctx, int reqId, const ResultFetchOpts &opts);
-	void freeQueryResults(cproto::Context &ctx, int id);
-	QueryResults &getQueryResults(cproto::Context &ctx, int &id);
+	// Releases results, which are got by call, unless call has freed them
+	class QueryResultsGuard {
+	public:
+		QueryResultsGuard(RPCServer &server, cproto::Context &ctx, int &id) : server_(server), ctx_(ctx), id_(id) {}
+		~QueryResultsGuard() { server_.releaseQueryResults(ctx_, id_); }
+
+	protected:
+		RPCServer &server_;
+		cproto::Context &ctx_;
+		int &id_;
+	};
+
+	Error sendResults(cproto::Context &ctx, QueryResults &qr, int &reqId, const ResultFetchOpts &opts);
+	Error fetchResults(cproto::Context &ctx, int &reqId, RPCQueryResults &res, const ResultFetchOpts &opts);
+	Error fetchBatch(cproto::Context &ctx, int &reqId, RPCQueryResults &res, ResultFetchOpts opts);
+	Error selectQuery(cproto::Context &ctx, const Query &query, int flags, int limit, int64_t fetchDataMask, p_string ptVersions);
+	// Get results and mark them busy. New results are allocated, if id < 0
+	RPCQueryResults &getQueryResults(cproto::Context &ctx, int &id);
+	// Free busy results, id is reset to -1
+	void freeQueryResults(cproto::Context &ctx, int &id);
+	void releaseQueryResults(cproto::Context &ctx, int id);
 
 	shared_ptr<Reindexer> getDB(cproto::Context &ctx, UserRole role);
 
 	DBManager &dbMgr_;
 	cproto::Dispatcher dispatcher;
 	std::unique_ptr<Listener> listener_;
+	// Is declared after listener, so workers are stopped before connections are destroyed
+	std::unique_ptr<WorkerPool> pool_;
 
 	LoggerWrapper logger_;
 	bool allocDebug_;
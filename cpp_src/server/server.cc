@@ -112,6 +112,11 @@ Error Server::init() {
 
 #ifndef _WIN32
 	if (!config_.UserName.empty()) {
+		// Owner of unix sockets is set after privileges are dropped, so it is checked before
+		if (!config_.UnixSocketOwner.empty()) {
+			err = fs::CheckFileOwner(config_.UnixSocketOwner, config_.UserName.c_str());
+			if (!err.ok()) return Error(errParams, "Invalid owner of unix sockets. %s", err.what().c_str());
+		}
 		err = ChangeUser(config_.UserName.c_str());
 		if (!err.ok()) return err;
 	}
@@ -227,19 +232,49 @@ int Server::run() {
 			config_.WebRoot.clear();
 		}
 #endif
+		ListenerOpts listenerOpts;
+		listenerOpts.reusePort = config_.ReusePort;
+		if (config_.Rebalance == "none") {
+			listenerOpts.rebalance = RebalanceMode::None;
+		} else if (config_.Rebalance == "load") {
+			listenerOpts.rebalance = RebalanceMode::Load;
+		} else if (config_.Rebalance != "connections") {
+			logger_.error("Unknown rebalance mode '{0}'", config_.Rebalance);
+			return EXIT_FAILURE;
+		}
+
 		LoggerWrapper httpLogger("http");
 		HTTPServer httpServer(*dbMgr_, config_.WebRoot, httpLogger, config_.DebugAllocs, config_.DebugPprof);
-		if (!httpServer.Start(config_.HTTPAddr, loop)) {
+		if (!httpServer.Start(config_.HTTPAddr, loop, listenerOpts)) {
 			logger_.error("Can't listen HTTP on '{0}'", config_.HTTPAddr);
 			return EXIT_FAILURE;
 		}
 
 		LoggerWrapper rpcLogger("rpc");
 		RPCServer rpcServer(*dbMgr_, rpcLogger, config_.DebugAllocs);
-		if (!rpcServer.Start(config_.RPCAddr, loop)) {
+		if (!rpcServer.Start(config_.RPCAddr, loop, config_.RPCWorkers, config_.RPCQueueLimit, listenerOpts)) {
 			logger_.error("Can't listen RPC on '{0}'", config_.RPCAddr);
 			return EXIT_FAILURE;
 		}
+		httpServer.SetRPCServer(&rpcServer);
+
+		std::unique_ptr<RPCServer> rpcServerUnix;
+		if (!config_.RPCUnixAddr.empty()) {
+			rpcServerUnix.reset(new RPCServer(*dbMgr_, rpcLogger, config_.DebugAllocs));
+			if (!rpcServerUnix->Start("unix://" + config_.RPCUnixAddr, loop, config_.RPCWorkers, config_.RPCQueueLimit, listenerOpts)) {
+				logger_.error("Can't listen RPC on unix socket '{0}'", config_.RPCUnixAddr);
+				return EXIT_FAILURE;
+			}
+		}
+
+		for (auto &addr : {config_.HTTPAddr, config_.RPCAddr, "unix://" + config_.RPCUnixAddr}) {
+			if (!net::socket::is_unix_addr(addr.c_str()) || !*net::socket::unix_path(addr.c_str())) continue;
+			auto err = fs::ChangeFileAccess(net::socket::unix_path(addr.c_str()), config_.UnixSocketOwner, config_.UnixSocketMode);
+			if (!err.ok()) {
+				logger_.error("Can't set access of unix socket '{0}': {1}", addr, err.what());
+				return EXIT_FAILURE;
+			}
+		}
 
 		running_ = true;
 		auto sigCallback = [&](ev::sig &sig) {
@@ -277,6 +312,7 @@ int Server::run() {
 		logger_.info("Reindexer server terminating...");
 
 		rpcServer.Stop();
+		if (rpcServerUnix) rpcServerUnix->Stop();
 		httpServer.Stop();
 	} catch (const Error &err) {
 		logger_.error("Unhandled exception occuried: {0}", err.what());
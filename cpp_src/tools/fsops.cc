@@ -4,11 +4,16 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
 #include <memory>
 
 #include "errors.h"
 #include "tools/oscompat.h"
 
+#ifndef _WIN32
+#include <grp.h>
+#endif
+
 namespace reindexer {
 namespace fs {
 
@@ -207,6 +212,86 @@ Error ChownDir(const string &path, const string &user) {
 	return 0;
 }
 
+#ifndef _WIN32
+// Resolves owner 'user[:group]'. Ids of omitted parts are -1
+static Error parseOwner(const string &owner, uid_t &uid, gid_t &gid) {
+	size_t pos = owner.find(':');
+	string user = owner.substr(0, pos), group = pos == string::npos ? string() : owner.substr(pos + 1);
+	uid = uid_t(-1);
+	gid = gid_t(-1);
+	char buf[0x4000];
+	if (!user.empty()) {
+		struct passwd pwd, *usr;
+		getpwnam_r(user.c_str(), &pwd, buf, sizeof(buf), &usr);
+		if (usr == nullptr) return Error(errParams, "User `%s` not found", user.c_str());
+		uid = usr->pw_uid;
+	}
+	if (!group.empty()) {
+		struct group grp, *gr;
+		getgrnam_r(group.c_str(), &grp, buf, sizeof(buf), &gr);
+		if (gr == nullptr) return Error(errParams, "Group `%s` not found", group.c_str());
+		gid = gr->gr_gid;
+	}
+	return 0;
+}
+#endif
+
+Error ChangeFileAccess(const string &path, const string &owner, const string &mode) {
+#ifndef _WIN32
+	if (!mode.empty()) {
+		char *end = nullptr;
+		long m = strtol(mode.c_str(), &end, 8);
+		if (*end || m < 0 || m > 07777) return Error(errParams, "Invalid file mode '%s'", mode.c_str());
+		if (chmod(path.c_str(), mode_t(m)) < 0) {
+			return Error(errLogic, "Could not change mode of '%s'. Reason: %s", path.c_str(), strerror(errno));
+		}
+	}
+	if (!owner.empty()) {
+		uid_t uid;
+		gid_t gid;
+		Error err = parseOwner(owner, uid, gid);
+		if (!err.ok()) return err;
+		if (chown(path.c_str(), uid, gid) < 0) {
+			return Error(errLogic, "Could not change ownership of '%s'. Reason: %s", path.c_str(), strerror(errno));
+		}
+	}
+#else
+	(void)path;
+	(void)owner;
+	(void)mode;
+#endif
+	return 0;
+}
+
+Error CheckFileOwner(const string &owner, const char *userName) {
+#ifndef _WIN32
+	uid_t uid;
+	gid_t gid;
+	Error err = parseOwner(owner, uid, gid);
+	if (!err.ok()) return err;
+
+	struct passwd pwd, *result;
+	char buf[0x4000];
+	getpwnam_r(userName, &pwd, buf, sizeof(buf), &result);
+	if (result == nullptr) return Error(errParams, "User `%s` not found", userName);
+	if (uid != uid_t(-1) && uid != pwd.pw_uid) {
+		return Error(errParams, "Owner `%s` is not allowed: it may be only user `%s`", owner.c_str(), userName);
+	}
+	if (gid != gid_t(-1) && gid != pwd.pw_gid) {
+		gid_t groups[0x100];
+		int cnt = sizeof(groups) / sizeof(groups[0]);
+		bool member = getgrouplist(userName, pwd.pw_gid, groups, &cnt) >= 0 && std::find(groups, groups + cnt, gid) != groups + cnt;
+		if (!member) {
+			return Error(errParams, "Owner `%s` is not allowed: it may be only group of user `%s`", owner.c_str(), userName);
+		}
+	}
+#else
+	(void)owner;
+	(void)userName;
+#endif
+	return 0;
+}
+
 Error ChangeUser(const char *userName) {
 #ifndef _WIN32
 	struct passwd pwd, *result;
@@ -222,6 +307,10 @@ Error ChangeUser(const char *userName) {
 		}
 	}
 
+	// Supplementary groups of root are replaced by ones of user
+	if (geteuid() == 0 && initgroups(userName, pwd.pw_gid) != 0) {
+		return Error(errLogic, "Could not change user to `%s`. Reason: %s", userName, strerror(errno));
+	}
 	if (setgid(pwd.pw_gid) != 0) return Error(errLogic, "Could not change user to `%s`. Reason: %s", userName, strerror(errno));
 	if (setuid(pwd.pw_uid) != 0) return Error(errLogic, "Could not change user to `%s`. Reason: %s", userName, strerror(errno));
 #else
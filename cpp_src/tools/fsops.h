@@ -35,6 +35,10 @@ string GetHomeDir();
 Error TryCreateDirectory(const string &dir);
 Error ChangeUser(const char *userName);
 Error ChownDir(const string &path, const string& user);
+// Set owner ('user' or 'user:group') and octal mode ('0660') of file. Empty owner or mode is not changed
+Error ChangeFileAccess(const string &path, const string &owner, const string &mode);
+// Check, that owner ('user' or 'user:group') of files may be set by process, which runs as userName: by that user and its groups
+Error CheckFileOwner(const string &owner, const char *userName);
 
 
 inline static string JoinPath(string base, string name) { return base + ((!base.empty() && base.back() != '/') ? "/" : "") + name; }
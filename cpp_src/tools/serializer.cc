@@ -140,6 +140,12 @@ void WrSerializer::PutSlice(const string_view &slice) {
 	len_ += slice.size();
 }
 
+void WrSerializer::Write(const string_view &slice) {
+	grow(slice.size());
+	memcpy(&buf_[len_], slice.data(), slice.size());
+	len_ += slice.size();
+}
+
 void WrSerializer::PutUInt32(uint32_t v) {
 	grow(sizeof v);
 	memcpy(&buf_[len_], &v, sizeof v);
@@ -317,6 +323,19 @@ uint8_t *WrSerializer::DetachBuffer() {
 	return b;
 }
 
+chunk WrSerializer::DetachChunk() {
+	if (!buf_ || buf_ == inBuf_) {
+		chunk ch(len_);
+		ch.append(reinterpret_cast<const char *>(buf_), len_);
+		len_ = 0;
+		return ch;
+	}
+	chunk ch(buf_, len_, cap_);
+	buf_ = nullptr;
+	len_ = cap_ = 0;
+	return ch;
+}
+
 uint8_t *WrSerializer::Buf() const { return buf_; }
 
 }  // namespace reindexer
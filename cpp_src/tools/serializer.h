@@ -2,6 +2,7 @@
 
 #include "core/keyvalue/keyref.h"
 #include "core/keyvalue/keyvalue.h"
+#include "estl/chain_buf.h"
 
 namespace reindexer {
 
@@ -77,6 +78,8 @@ public:
 
 	// Put slice with 4 bytes len header
 	void PutSlice(const string_view &slice);
+	// Put slice without header
+	void Write(const string_view &slice);
 
 	// Put raw data
 	void PutUInt32(uint32_t);
@@ -109,6 +112,8 @@ public:
 
 	// Buffer manipulation functions
 	uint8_t *DetachBuffer();
+	// Move data to chunk without copying, if it is in heap buffer. Serializer is empty after it
+	chunk DetachChunk();
 	uint8_t *Buf() const;
 	void Reset() { len_ = 0; }
 	size_t Len() const { return len_; }
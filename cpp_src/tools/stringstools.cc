@@ -123,68 +123,42 @@ void split(const string_view &str, string &buf, vector<const char *> &words, con
 	}
 }
 
-std::pair<int, int> word2Pos(const string_view &str, int wordPos, int endPos, const string &extraWordSymbols) {
-	auto wordStartIt = str.begin();
-	auto wordEndIt = str.begin();
-	auto it = str.begin();
-	assert(endPos > wordPos);
-	int numWords = endPos - (wordPos + 1);
-	for (; it != str.end();) {
-		auto ch = utf8::unchecked::next(it);
-
-		while (it != str.end() && !IsAlpha(ch) && !IsDigit(ch)) {
-			wordStartIt = it;
-			ch = utf8::unchecked::next(it);
-		}
-
-		while (IsAlpha(ch) || IsDigit(ch) || extraWordSymbols.find(ch) != string::npos) {
-			wordEndIt = it;
-			if (it == str.end()) break;
-			ch = utf8::unchecked::next(it);
-		}
-
-		if (wordStartIt != it) {
-			if (!wordPos)
-				break;
-			else {
-				wordPos--;
-				wordStartIt = it;
-			}
-		}
-	}
+void Word2PosHelper::Reset(string_view data, const string &extraWordSymbols) {
+	data_ = data;
+	extraWordSymbols_ = &extraWordSymbols;
+	scanPos_ = 0;
+	words_.resize(0);
+}
 
-	for (; numWords != 0 && it != str.end(); numWords--) {
+bool Word2PosHelper::scanWord() {
+	const char *begin = data_.data(), *end = data_.data() + data_.size();
+	const char *it = begin + scanPos_;
+	while (it != end) {
+		const char *wordStart = it;
 		auto ch = utf8::unchecked::next(it);
+		if (!IsAlpha(ch) && !IsDigit(ch)) continue;
 
-		while (it != str.end() && !IsAlpha(ch) && !IsDigit(ch)) {
-			ch = utf8::unchecked::next(it);
-		}
-
-		while (IsAlpha(ch) || IsDigit(ch) || extraWordSymbols.find(ch) != string::npos) {
-			wordEndIt = it;
-			if (it == str.end()) break;
+		const char *wordEnd = it;
+		while (it != end) {
 			ch = utf8::unchecked::next(it);
+			if (!IsAlpha(ch) && !IsDigit(ch) && extraWordSymbols_->find(ch) == string::npos) break;
+			wordEnd = it;
 		}
+		scanPos_ = it - begin;
+		words_.push_back({int(wordStart - begin), int(wordEnd - begin)});
+		return true;
 	}
-
-	return {int(std::distance(str.begin(), wordStartIt)), int(std::distance(str.begin(), wordEndIt))};
+	scanPos_ = data_.size();
+	return false;
 }
 
-Word2PosHelper::Word2PosHelper(string_view data, const string &extraWordSymbols)
-	: data_(data), lastWordPos_(0), lastOffset_(0), extraWordSymbols_(extraWordSymbols) {}
-
 std::pair<int, int> Word2PosHelper::convert(int wordPos, int endPos) {
-	if (wordPos < lastWordPos_) {
-		lastWordPos_ = 0;
-		lastOffset_ = 0;
+	assert(endPos > wordPos);
+	while (int(words_.size()) < endPos) {
+		if (!scanWord()) break;
 	}
-
-	auto ret = word2Pos(data_.substr(lastOffset_), wordPos - lastWordPos_, endPos - lastWordPos_, extraWordSymbols_);
-	ret.first += lastOffset_;
-	ret.second += lastOffset_;
-	lastOffset_ = ret.first;
-	lastWordPos_ += wordPos;
-	return ret;
+	int size = data_.size();
+	return {wordPos < int(words_.size()) ? words_[wordPos].first : size, endPos <= int(words_.size()) ? words_[endPos - 1].second : size};
 }
 
 void split(const string_view &utf8Str, wstring &utf16str, vector<std::wstring> &words, const string &extraWordSymbols) {
@@ -23,15 +23,24 @@ void split(const string_view& str, string& buf, vector<const char*>& words, cons
 size_t calcUTf8Size(const char* s, size_t size, size_t limit);
 size_t calcUTf8SizeEnd(const char* end, int pos, size_t limit);
 
+// Converts positions of words in text to byte offsets. Text is scanned only once up to the last requested word,
+// so conversion of sorted positions is linear. Buffer of words offsets is reused, when helper is reset to new text
 class Word2PosHelper {
 public:
-	Word2PosHelper(string_view data, const string& extraWordSymbols);
+	Word2PosHelper() = default;
+	Word2PosHelper(string_view data, const string& extraWordSymbols) { Reset(data, extraWordSymbols); }
+	void Reset(string_view data, const string& extraWordSymbols);
+	// Returns byte offsets of begin of word wordPos and end of word endPos - 1
 	std::pair<int, int> convert(int wordPos, int endPos);
 
 protected:
+	bool scanWord();
+
 	string_view data_;
-	int lastWordPos_, lastOffset_;
-	const string& extraWordSymbols_;
+	const string* extraWordSymbols_ = nullptr;
+	size_t scanPos_ = 0;
+	// Offsets of begin and end of scanned words
+	vector<std::pair<int, int>> words_;
 };
 
 string lower(string s);
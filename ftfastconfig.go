@@ -29,6 +29,15 @@ type FtFastConfig struct {
 	MaxTyposInWord int `json:"max_typos_in_word"`
 	// Maximum word length for building and matching variants with typos. Default value is 15
 	MaxTypoLen int `json:"max_typo_len"`
+	// Minimum count of terms in query to lookup them in parallel threads
+	// 0: parallel lookup is disabled
+	ParallelTermsThreshold int `json:"parallel_terms_threshold"`
+	// Minimum count of found words entries in documents to merge query results in parallel threads
+	// 0: parallel merge is disabled
+	ParallelMergeThreshold int `json:"parallel_merge_threshold"`
+	// Maximum memory size of cache of query terms variants (stemmed, translit and kblayout forms) in bytes
+	// 0: cache is disabled
+	VariantsCacheSize int `json:"variants_cache_size"`
 	// Maximum documents which will be processed in merge query results
 	// Default value is 20000. Increasing this value may refine ranking
 	// of queries with high frequency words
@@ -51,20 +60,23 @@ type FtFastConfig struct {
 
 func DefaultFtFastConfig() FtFastConfig {
 	return FtFastConfig{
-		Bm25Boost:        1.0,
-		Bm25Weight:       0.5,
-		DistanceBoost:    1.0,
-		DistanceWeight:   0.5,
-		TermLenBoost:     1.0,
-		TermLenWeight:    0.3,
-		MinRelevancy:     0.05,
-		MaxTyposInWord:   1,
-		MaxTypoLen:       15,
-		MergeLimit:       20000,
-		Stemmers:         []string{"en", "ru"},
-		EnableTranslit:   true,
-		EnableKbLayout:   true,
-		LogLevel:         0,
-		ExtraWordSymbols: "/-+",
+		Bm25Boost:              1.0,
+		Bm25Weight:             0.5,
+		DistanceBoost:          1.0,
+		DistanceWeight:         0.5,
+		TermLenBoost:           1.0,
+		TermLenWeight:          0.3,
+		MinRelevancy:           0.05,
+		MaxTyposInWord:         1,
+		MaxTypoLen:             15,
+		ParallelTermsThreshold: 4,
+		ParallelMergeThreshold: 100000,
+		VariantsCacheSize:      1048576,
+		MergeLimit:             20000,
+		Stemmers:               []string{"en", "ru"},
+		EnableTranslit:         true,
+		EnableKbLayout:         true,
+		LogLevel:               0,
+		ExtraWordSymbols:       "/-+",
 	}
 }
@@ -313,17 +313,39 @@ func (it *Iterator) HasRank() bool {
 	return it.rawQueryParams.haveProcent
 }
 
+// FacetResult is count of items for a distinct value (or combination of values) of facet fields
+type FacetResult struct {
+	Values []string `json:"values"`
+	Count  int      `json:"count"`
+}
+
+// AggregationResult is result of one aggregation function of query
+type AggregationResult struct {
+	Type   string        `json:"type"`
+	Fields []string      `json:"fields"`
+	Value  float64       `json:"value"`
+	Facets []FacetResult `json:"facets"`
+}
+
 // AggResults returns aggregation results (if present)
-func (it *Iterator) AggResults() []float64 {
+func (it *Iterator) AggResults() []AggregationResult {
 	return it.rawQueryParams.aggResults
 }
 
-// GetAggreatedValue - Return aggregation sum of field
+// GetAggreatedValue - Return aggregation value of field (for sum, avg, min, max, count and count_distinct aggregations)
 func (it *Iterator) GetAggreatedValue(idx int) float64 {
 	if idx < 0 || idx >= len(it.rawQueryParams.aggResults) {
 		return 0
 	}
-	return it.rawQueryParams.aggResults[idx]
+	return it.rawQueryParams.aggResults[idx].Value
+}
+
+// GetAggreatedFacets - Return facets of aggregation (for facet aggregation)
+func (it *Iterator) GetAggreatedFacets(idx int) []FacetResult {
+	if idx < 0 || idx >= len(it.rawQueryParams.aggResults) {
+		return nil
+	}
+	return it.rawQueryParams.aggResults[idx].Facets
 }
 
 // Error returns query error if it's present.
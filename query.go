@@ -285,7 +285,17 @@ func (q *Query) WhereDouble(index string, condition int, keys ...float64) *Query
 // Aggregate - Return aggregation of field
 func (q *Query) Aggregate(index string, aggType int) *Query {
 
-	q.ser.PutVarCUInt(queryAggregation).PutVString(index).PutVarCUInt(aggType)
+	q.ser.PutVarCUInt(queryAggregation).PutVarCUInt(aggType).PutVarCUInt(1).PutVString(index)
+	return q
+}
+
+// AggregateFacet - Return count of items for each distinct value (or combination of values) of fields
+func (q *Query) AggregateFacet(fields ...string) *Query {
+
+	q.ser.PutVarCUInt(queryAggregation).PutVarCUInt(AggFacet).PutVarCUInt(len(fields))
+	for _, field := range fields {
+		q.ser.PutVString(field)
+	}
 	return q
 }
 
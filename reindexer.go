@@ -55,8 +55,14 @@ const (
 )
 
 const (
-	AggAvg = bindings.AggAvg
-	AggSum = bindings.AggSum
+	AggAvg                 = bindings.AggAvg
+	AggSum                 = bindings.AggSum
+	AggFacet               = bindings.AggFacet
+	AggMin                 = bindings.AggMin
+	AggMax                 = bindings.AggMax
+	AggCount               = bindings.AggCount
+	AggCountDistinct       = bindings.AggCountDistinct
+	AggCountDistinctApprox = bindings.AggCountDistinctApprox
 )
 
 var logger Logger = &nullLogger{}
@@ -1,6 +1,7 @@
 package reindexer
 
 import (
+	"encoding/json"
 	"fmt"
 
 	"github.com/restream/reindexer/bindings"
@@ -23,7 +24,7 @@ type rawResultQueryParams struct {
 	haveProcent      bool
 	nonCacheableData bool
 	nsCount          int
-	aggResults       []float64
+	aggResults       []AggregationResult
 }
 
 type resultSerializer struct {
@@ -83,16 +84,18 @@ func (s *resultSerializer) readRawQueryParams(updatePayloadType ...updatePayload
 	return v
 }
 
-func (s *resultSerializer) readAggregationResults() (aggResults []float64) {
+func (s *resultSerializer) readAggregationResults() (aggResults []AggregationResult) {
 	aggResCount := int(s.GetVarUInt())
 	if aggResCount == 0 {
 		return nil
 	}
 
-	aggResults = make([]float64, aggResCount)
+	aggResults = make([]AggregationResult, aggResCount)
 
 	for i := 0; i < aggResCount; i++ {
-		aggResults[i] = s.GetDouble()
+		if err := json.Unmarshal(s.GetBytes(), &aggResults[i]); err != nil {
+			panic(err)
+		}
 	}
 	return
 }